@@ -0,0 +1,58 @@
+#include "arena.h"
+#include <algorithm>
+#include <new>
+
+namespace sugar {
+
+    void ScratchArena::add_chunk(std::size_t min_bytes) {
+        const std::size_t last = chunks_.empty() ? initial_ / 2 : chunks_.back().size;
+        const std::size_t size = std::max(min_bytes, last * 2);
+        chunks_.push_back({ std::make_unique_for_overwrite<std::byte[]>(size), size });
+        ++stats_.upstream_allocs;
+        stats_.upstream_bytes += size;
+        stats_.capacity += size;
+    }
+
+    std::size_t ScratchArena::in_use() const {
+        std::size_t bytes = used_;
+        for (std::size_t c = 0; c < cur_ && c < chunks_.size(); ++c) bytes += chunks_[c].size;
+        return bytes;
+    }
+
+    void* ScratchArena::do_allocate(std::size_t bytes, std::size_t align) {
+        ++stats_.served;
+        for (;;) {
+            if (cur_ < chunks_.size()) {
+                const Chunk& c = chunks_[cur_];
+                const auto base = reinterpret_cast<std::uintptr_t>(c.mem.get());
+                const std::uintptr_t p = (base + used_ + align - 1) & ~std::uintptr_t(align - 1);
+                if (p + bytes <= base + c.size) {
+                    used_ = static_cast<std::size_t>(p - base) + bytes;
+                    stats_.high_water = std::max(stats_.high_water, in_use());
+                    return reinterpret_cast<void*>(p);
+                }
+                if (cur_ + 1 < chunks_.size()) { ++cur_; used_ = 0; continue; }   // later chunk left from before a rewind
+            }
+            add_chunk(bytes + align);
+            cur_ = chunks_.size() - 1; used_ = 0;
+        }
+    }
+
+    void ScratchArena::rewind(Mark m) {
+        cur_ = m.chunk; used_ = m.used;
+        if (m.chunk != 0 || m.used != 0 || chunks_.size() < 2) return;
+        const std::size_t total = stats_.capacity;                      // outermost scope closed: one chunk of everything
+        chunks_.clear();
+        stats_.capacity = 0;
+        chunks_.push_back({ std::make_unique_for_overwrite<std::byte[]>(total), total });
+        ++stats_.upstream_allocs;
+        stats_.upstream_bytes += total;
+        stats_.capacity = total;
+    }
+
+    ScratchArena& thread_scratch() {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+} // namespace sugar
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace sugar {
+
+    struct ScratchStats {
+        std::uint64_t served{};                                         // allocations handed out
+        std::uint64_t upstream_allocs{};                                // chunks taken from operator new
+        std::uint64_t upstream_bytes{};
+        std::size_t capacity{};                                         // bytes currently held
+        std::size_t high_water{};                                       // most bytes in use at once
+    };
+
+    // Bump allocator for the temporaries of one backtest run.
+    //
+    // Allocation is a pointer bump inside the current chunk; deallocate is a
+    // no-op and memory comes back only by rewinding to a mark, which frees
+    // everything allocated after it. Rewinding to the very start also merges
+    // the chunks into one of their total size, so once a thread has seen its
+    // largest run, later runs are served from a single chunk with no call to
+    // the global allocator at all. Not thread safe: one arena per thread.
+    class ScratchArena final : public std::pmr::memory_resource {
+    public:
+        struct Mark { std::size_t chunk, used; };
+
+        explicit ScratchArena(std::size_t initial_bytes = 64 * 1024) : initial_(initial_bytes) {}
+
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+
+        Mark mark() const { return { cur_, used_ }; }
+        void rewind(Mark m);
+        const ScratchStats& stats() const { return stats_; }
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t align) override;
+        void do_deallocate(void*, std::size_t, std::size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        struct Chunk { std::unique_ptr<std::byte[]> mem; std::size_t size; };
+        void add_chunk(std::size_t min_bytes);
+        std::size_t in_use() const;
+
+        std::size_t initial_;
+        std::vector<Chunk> chunks_;
+        std::size_t cur_ = 0, used_ = 0;                                // bump position: chunk index, bytes used in it
+        ScratchStats stats_;
+    };
+
+    ScratchArena& thread_scratch();                                     // this thread's arena, created on first use
+
+    // Rewinds the thread's arena on scope exit. Declare it before the
+    // containers that use resource(), so they are destroyed first.
+    class ScratchScope {
+    public:
+        ScratchScope() : ScratchScope(thread_scratch()) {}
+        explicit ScratchScope(ScratchArena& arena) : arena_(arena), mark_(arena_.mark()) {}
+        ~ScratchScope() { arena_.rewind(mark_); }
+
+        ScratchScope(const ScratchScope&) = delete;
+        ScratchScope& operator=(const ScratchScope&) = delete;
+
+        std::pmr::memory_resource* resource() { return &arena_; }
+
+    private:
+        ScratchArena& arena_;
+        ScratchArena::Mark mark_;
+    };
+
+} // namespace sugar
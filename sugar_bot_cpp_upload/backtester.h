@@ -7,9 +7,12 @@ namespace sugar {
 
 	class Backtester {																//
 	public:																			//
-		BacktestResult run(const CandleSeries& data, IStrategy& strategy) {			//
+		BacktestResult run(const CandleSeries& data, const IStrategy& strategy) {	//
 			return strategy.run(data);												//
 		}
+		BacktestResult run(const CandleSeries& data, const IStrategy& strategy, RunContext& ctx) {	//
+			return strategy.run(data, ctx);											//
+		}
 	};
 
 
@@ -0,0 +1,390 @@
+// sugar_bench: microbenchmarks for the hot paths at several data sizes.
+//
+//   sugar_bench [--sizes 1k,100k,1m] [--filter SUBSTR] [--min-time SECONDS] [--json PATH]
+//   sugar_bench --compare BASE.json NEW.json [--threshold 0.10]
+//
+// Sizes take k/m suffixes (1k .. 50m). Each case is repeated until --min-time has
+// passed (at least 3 times unless one run already takes longer) and reports the
+// median. --compare matches cases by name and size and exits with status 2 when
+// any case got slower than BASE by more than the threshold. A SUGAR_PROFILE build
+// also reports heap allocations per run (calling thread only).
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "candle_file.h"
+#include "csv.h"
+#include "profile.h"
+#include "indicator_bank.h"
+#include "indicators_composite.h"
+#include "series.h"
+#include "strategy_diff_cross.h"
+#include "strategy_roc_sma.h"
+#include "strategy_rule.h"
+#include "swing_breakout_strategy.h"
+#include "sweep.h"
+#include "sweep_diff_cross.h"
+#include "synth.h"
+#include "utils.h"
+
+
+struct BenchRow {
+	std::string name;
+	std::size_t bars{};
+	std::size_t reps{};
+	double median_ns{}, min_ns{};
+	double work{};																					// units per run (bars, bar*combos, bytes) for the rate
+	std::string unit;
+	double allocs_per_op = -1.0;																	// operator new calls per run on this thread; -1 unless built with SUGAR_PROFILE
+};
+
+
+// "1k" -> 1000, "2.5m" -> 2500000
+static std::size_t parse_size(const std::string& s) {
+	std::size_t used = 0;
+	const double v = std::stod(s, &used);
+	const std::string suffix = s.substr(used);
+	double mult = 1.0;
+	if (suffix == "k" || suffix == "K") mult = 1e3;
+	else if (suffix == "m" || suffix == "M") mult = 1e6;
+	else if (!suffix.empty()) throw std::runtime_error("Bad size: " + s);
+	return static_cast<std::size_t>(v * mult + 0.5);
+}
+
+
+static void write_csv(const std::string& path, const std::vector<sugar::Candle>& rows) {
+	std::string text = sugar::kCandleCsvHeader;
+	for (const auto& c : rows) sugar::append_candle_csv(text, c);
+	std::ofstream out(path, std::ios::binary);
+	if (!out || !out.write(text.data(), static_cast<std::streamsize>(text.size()))) throw std::runtime_error("Failed to write " + path);
+}
+
+
+static volatile double g_sink;																		// keeps results observable
+
+
+// Median wall time of fn() over enough repetitions to fill min_time.
+static BenchRow measure(const std::string& name, std::size_t bars, double work, const std::string& unit,
+	double min_time, const std::function<double()>& fn) {
+	using clock = std::chrono::steady_clock;
+	std::vector<double> ns;
+	double total = 0.0;
+	const auto t_first = clock::now();
+	g_sink = fn();																					// warm-up (page faults, caches, first-touch allocation)
+	const double first = std::chrono::duration<double>(clock::now() - t_first).count();
+	if (first > min_time) ns.push_back(first * 1e9);												// a single run is long enough: do not pay for it three times
+	while (ns.empty() || (ns.size() < 3 && first <= min_time) || total < min_time) {
+		const auto t0 = clock::now();
+		g_sink = fn();
+		const double dt = std::chrono::duration<double>(clock::now() - t0).count();
+		ns.push_back(dt * 1e9);
+		total += dt;
+		if (first > min_time) break;
+	}
+	std::sort(ns.begin(), ns.end());
+	BenchRow r;
+	r.name = name; r.bars = bars; r.reps = ns.size();
+	r.median_ns = ns[ns.size() / 2]; r.min_ns = ns.front();
+	r.work = work; r.unit = unit;
+	if constexpr (sugar::prof::kCompiledIn) {														// one more untimed run under the allocation counters
+		const auto a0 = sugar::prof::thread_allocs();
+		g_sink = fn();
+		r.allocs_per_op = double(sugar::prof::thread_allocs() - a0);
+	}
+	return r;
+}
+
+
+static std::string json_string(std::string_view s) {
+	std::string out = "\"";
+	for (char c : s) {
+		if (c == '"' || c == '\\') { out += '\\'; out += c; }
+		else if (static_cast<unsigned char>(c) < 0x20) { char b[8]; std::snprintf(b, sizeof(b), "\\u%04x", c); out += b; }
+		else out += c;
+	}
+	return out + "\"";
+}
+
+
+static void write_json(std::ostream& out, const std::vector<BenchRow>& rows) {
+	const std::time_t now = std::time(nullptr);
+	char stamp[32];
+	std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+	out << "{\n  \"suite\": \"sugar_bench\",\n  \"version\": 1,\n  \"timestamp\": \"" << stamp << "\",\n"
+#ifdef __VERSION__
+		<< "  \"compiler\": " << json_string(__VERSION__) << ",\n"
+#endif
+		<< "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [\n";
+	out << std::setprecision(6);
+	for (std::size_t i = 0; i < rows.size(); ++i) {
+		const auto& r = rows[i];
+		out << "    {\"name\": " << json_string(r.name) << ", \"bars\": " << r.bars << ", \"reps\": " << r.reps
+			<< ", \"median_ns\": " << r.median_ns << ", \"min_ns\": " << r.min_ns
+			<< ", \"ns_per_bar\": " << (r.bars ? r.median_ns / double(r.bars) : 0.0)
+			<< ", \"unit\": " << json_string(r.unit) << ", \"per_sec\": " << r.work / (r.median_ns * 1e-9);
+		if (r.allocs_per_op >= 0.0) out << ", \"allocs_per_op\": " << r.allocs_per_op;
+		out << "}"
+			<< (i + 1 < rows.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+}
+
+
+// Reads the result objects of a sugar_bench JSON file: every innermost {...}
+// is a flat object of string / number fields.
+static std::vector<BenchRow> read_json(const std::string& path) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) throw std::runtime_error("Failed to open " + path);
+	std::stringstream ss;
+	ss << in.rdbuf();
+	const std::string text = ss.str();
+
+	std::vector<BenchRow> rows;
+	std::size_t pos = 0;
+	while ((pos = text.find('{', pos)) != std::string::npos) {
+		const std::size_t end = text.find('}', pos);
+		if (end == std::string::npos) break;
+		const std::size_t inner = text.find('{', pos + 1);
+		if (inner != std::string::npos && inner < end) { pos = inner; continue; }					// not innermost
+
+		std::map<std::string, std::string> kv;
+		std::size_t i = pos + 1;
+		auto skip_ws = [&]() { while (i < end && std::isspace(static_cast<unsigned char>(text[i]))) ++i; };
+		auto read_string = [&]() {
+			std::string s;
+			for (++i; i < end && text[i] != '"'; ++i) {
+				if (text[i] == '\\' && i + 1 < end) ++i;
+				s += text[i];
+			}
+			++i;
+			return s;
+		};
+		for (;;) {
+			skip_ws();
+			if (i >= end || text[i] != '"') break;
+			const std::string key = read_string();
+			skip_ws();
+			if (i < end && text[i] == ':') ++i;
+			skip_ws();
+			std::string value;
+			if (i < end && text[i] == '"') value = read_string();
+			else { while (i < end && text[i] != ',' && !std::isspace(static_cast<unsigned char>(text[i]))) value += text[i++]; }
+			kv[key] = value;
+			skip_ws();
+			if (i < end && text[i] == ',') ++i;
+		}
+		if (kv.count("name") && kv.count("bars") && kv.count("median_ns")) {
+			BenchRow r;
+			r.name = kv["name"];
+			r.bars = std::stoull(kv["bars"]);
+			r.median_ns = std::stod(kv["median_ns"]);
+			r.reps = kv.count("reps") ? std::stoull(kv["reps"]) : 0;
+			rows.push_back(r);
+		}
+		pos = end + 1;
+	}
+	if (rows.empty()) throw std::runtime_error("No benchmark results in " + path);
+	return rows;
+}
+
+
+static int compare(const std::string& base_path, const std::string& new_path, double threshold) {
+	const auto base = read_json(base_path), now = read_json(new_path);
+	std::map<std::pair<std::string, std::size_t>, double> before;
+	for (const auto& r : base) before[{ r.name, r.bars }] = r.median_ns;
+
+	std::size_t regressions = 0, improvements = 0, matched = 0;
+	std::cout << std::left << std::setw(28) << "case" << std::right << std::setw(11) << "bars"
+		<< std::setw(14) << "base" << std::setw(14) << "new" << std::setw(10) << "change" << "\n";
+	for (const auto& r : now) {
+		const auto it = before.find({ r.name, r.bars });
+		if (it == before.end()) continue;
+		++matched;
+		const double change = r.median_ns / it->second - 1.0;
+		const char* flag = "";
+		if (change > threshold) { flag = "  REGRESSION"; ++regressions; }
+		else if (change < -threshold) { flag = "  faster"; ++improvements; }
+		std::cout << std::left << std::setw(28) << r.name << std::right << std::setw(11) << r.bars
+			<< std::setw(12) << std::fixed << std::setprecision(3) << it->second / 1e6 << "ms"
+			<< std::setw(12) << r.median_ns / 1e6 << "ms" << std::setw(9) << std::setprecision(1)
+			<< std::showpos << change * 100.0 << std::noshowpos << "%" << flag << "\n";
+	}
+	std::cout << matched << " cases compared, " << regressions << " slower and " << improvements
+		<< " faster by more than " << threshold * 100.0 << "%\n";
+	return regressions ? 2 : 0;
+}
+
+
+int main(int argc, char** argv) {
+	try {
+		std::vector<std::size_t> sizes{ 1000, 100000, 1000000 };
+		std::string filter, json_path, base_path, new_path;
+		double min_time = 0.3, threshold = 0.10;
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			auto value = [&]() -> std::string {
+				if (i + 1 >= argc) throw std::runtime_error("Missing value for " + std::string(arg));
+				return argv[++i];
+			};
+			if (arg == "--sizes") {
+				sizes.clear();
+				std::stringstream ss(value());
+				std::string s;
+				while (std::getline(ss, s, ',')) sizes.push_back(parse_size(s));
+			}
+			else if (arg == "--filter") filter = value();
+			else if (arg == "--min-time") min_time = std::stod(value());
+			else if (arg == "--json") json_path = value();
+			else if (arg == "--compare") { base_path = value(); new_path = value(); }
+			else if (arg == "--threshold") threshold = std::stod(value());
+			else throw std::runtime_error("Unknown option: " + std::string(arg));
+		}
+		if (!base_path.empty()) return compare(base_path, new_path, threshold);
+
+		const auto tmp_csv = (std::filesystem::temp_directory_path() / "sugar_bench.csv").string();
+		const auto tmp_bin = (std::filesystem::temp_directory_path() / "sugar_bench.scb").string();
+		std::vector<BenchRow> rows;
+		std::ostream& log = json_path == "-" ? std::cerr : std::cout;
+		log << std::left << std::setw(28) << "case" << std::right << std::setw(11) << "bars" << std::setw(7) << "reps"
+			<< std::setw(14) << "median" << std::setw(12) << "ns/bar" << "   rate\n";
+
+		for (const std::size_t n : sizes) {
+			const auto candles = sugar::generate_candles(sugar::SynthOptions{}, n);				// seeded GBM, same bars every run
+			const sugar::CandleSeries series{ candles };
+			auto wanted = [&](const std::string& name) { return filter.empty() || name.find(filter) != std::string::npos; };
+			auto run = [&](const std::string& name, double work, const std::string& unit, const std::function<double()>& fn) {
+				if (!wanted(name)) return;
+				const auto r = measure(name, n, work, unit, min_time, fn);
+				log << std::left << std::setw(28) << r.name << std::right << std::setw(11) << r.bars << std::setw(7) << r.reps
+					<< std::setw(12) << std::fixed << std::setprecision(3) << r.median_ns / 1e6 << "ms"
+					<< std::setw(12) << std::setprecision(2) << r.median_ns / double(n)
+					<< "   " << std::setprecision(1) << r.work / (r.median_ns * 1e-9) / 1e6 << " M" << r.unit << "/s";
+				if (r.allocs_per_op >= 0.0) log << "   " << std::setprecision(0) << r.allocs_per_op << " allocs/op";
+				log << "\n";
+				rows.push_back(r);
+			};
+
+			// ---- loading ----
+			if (wanted("csv/load") || wanted("csv/load_mapped")) {
+				write_csv(tmp_csv, candles);
+				const double bytes = static_cast<double>(std::filesystem::file_size(tmp_csv));
+				run("csv/load", bytes, "B", [&] { return double(sugar::load_candles_csv(tmp_csv).size()); });
+				run("csv/load_mapped", bytes, "B", [&] { return double(sugar::load_candles_csv_mapped(tmp_csv).size()); });
+				std::filesystem::remove(tmp_csv);
+			}
+			if (wanted("bin/write") || wanted("bin/load")) {
+				const double bytes = double(sugar::kCandleBinHeader + n * sugar::kCandleBinRecord);
+				run("bin/write", bytes, "B", [&] { sugar::write_candles_bin(tmp_bin, candles); return bytes; });
+				run("bin/load", bytes, "B", [&] { return double(sugar::load_candles_bin(tmp_bin).size()); });
+				std::filesystem::remove(tmp_bin);
+			}
+			if (wanted("utils/parse_yyyymmdd")) {
+				std::string dates;																	// "YYYY-MM-DD" back to back
+				dates.reserve(n * 10);
+				char buf[9];
+				for (const auto& c : candles) {
+					sugar::format_yyyymmdd(c.date, buf);
+					dates.append(buf, 4).append("-").append(buf + 4, 2).append("-").append(buf + 6, 2);
+				}
+				run("utils/parse_yyyymmdd", double(n), "bar", [&] {
+					long long sum = 0;
+					for (std::size_t i = 0; i < n; ++i) sum += sugar::parse_yyyymmdd(std::string_view(dates).substr(i * 10, 10));
+					return double(sum);
+				});
+			}
+
+			// ---- indicators ----
+			run("series/closes", double(n), "bar", [&] { return series.closes().back(); });
+			run("indicator/sma50", double(n), "bar", [&] { return sugar::SMAIndicator(50).compute(series).back(); });
+			run("indicator/ema50", double(n), "bar", [&] { return sugar::EMAIndicator(50).compute(series).back(); });
+			run("indicator/roc10", double(n), "bar", [&] { return sugar::ROCIndicator(10).compute(series).back(); });
+			run("indicator/roc10_of_sma50", double(n), "bar", [&] {
+				return sugar::ROCOfIndicator(std::make_shared<sugar::SMAIndicator>(50), 10).compute(series).back();
+			});
+
+			// ---- strategies ----
+			run("strategy/roc_sma", double(n), "bar", [&] {
+				sugar::RocSmaCrossoverStrategy s{ 20, 50, 10, 0.15 };
+				return s.run(series).pnl;
+			});
+			{																						// the same rule as strategy/roc_sma, compiled once up front
+				const std::string d = "roc(sma(close,20),10) - roc(sma(close,50),10)";
+				const std::string text = "enter: " + d + " >= 0.15\nexit: " + d + " <= -0.15";
+				run("rule/compile", 1.0, "rule", [&] { return double(sugar::RuleProgram::compile(text).code().size()); });
+				const sugar::RuleProgram program = sugar::RuleProgram::compile(text);
+				run("strategy/rule_roc_sma", double(n), "bar", [&] {
+					sugar::RuleStrategy s{ program };
+					return s.run(series).pnl;
+				});
+			}
+			run("strategy/diff_cross", double(n), "bar", [&] {
+				sugar::DiffCrossStrategy s{ std::make_shared<sugar::SMAIndicator>(20), std::make_shared<sugar::EMAIndicator>(50), 0.15 };
+				return s.run(series).pnl;
+			});
+			run("strategy/swing_breakout", double(n), "bar", [&] {
+				sugar::SwingBreakoutStrategy s{ 2, 2, true, 2, 4.0, 3, 8.0 };
+				return s.run(series).pnl;
+			});
+
+			// ---- sweeps: 4 x 4 x 3 x 3 = 144 combos ----
+			const std::vector<std::size_t> fasts{ 10, 20, 30, 40 }, slows{ 50, 60, 70, 80 }, rocs{ 5, 10, 20 };
+			const std::vector<double> threshes{ 0.1, 0.2, 0.3 };
+			const double combos = double(fasts.size() * slows.size() * rocs.size() * threshes.size());
+			for (const bool prune : { false, true }) {
+				run(prune ? "sweep/roc_sma_pruned" : "sweep/roc_sma", double(n) * combos, "bar*combo", [&] {
+					sugar::SweepOptions so;
+					so.quiet = true; so.prune = prune;
+					return sugar::sweep_roc_sma(series, fasts, slows, rocs, threshes, so).best.pnl;
+				});
+			}
+
+			// ---- diff_cross sweep: (4 families x 3 periods)^2 x 3 thresholds = 432 combos ----
+			std::vector<sugar::IndicatorKey> keys;
+			for (const std::string f : { "sma", "ema", "roc_sma", "roc_ema" })
+				for (const char* p : { "10", "30", "50" }) keys.push_back(sugar::parse_indicator_key(f + ":" + p + (f.size() > 3 ? "/10" : "")));
+			const double dc_combos = double(keys.size() * keys.size() * threshes.size());
+			run("sweep/diff_cross_per_pair", double(n) * dc_combos, "bar*combo", [&] {				// what a hand-written loop does: A and B per combo
+				double best = -1e300;
+				for (const auto& a : keys) for (const auto& b : keys) for (const double t : threshes) {
+					sugar::DiffCrossStrategy s{ sugar::make_indicator(a), sugar::make_indicator(b), t };
+					best = std::max(best, sugar::sweep_score(s.run(series)));
+				}
+				return best;
+			});
+			run("sweep/diff_cross_bank", double(n) * dc_combos, "bar*combo", [&] {
+				return sugar::sweep_diff_cross(series, keys, keys, threshes).top[0].score;
+			});
+		}
+
+		if (!json_path.empty()) {
+			if (json_path == "-") write_json(std::cout, rows);
+			else {
+				std::ofstream out(json_path);
+				if (!out) throw std::runtime_error("Failed to write " + json_path);
+				write_json(out, rows);
+				std::cout << "Wrote " << rows.size() << " results to " << json_path << "\n";
+			}
+		}
+		return 0;
+	}
+	catch (const std::exception& ex) {
+		std::cerr << "Error: " << ex.what() << "\n"; return 1;
+	}
+}
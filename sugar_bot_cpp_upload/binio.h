@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "candle.h"
+#include "metrics.h"
+#include "utils.h"
+
+namespace sugar {
+
+    // Tiny helpers for the repo's compact binary files (checkpoints, shard
+    // results, result stores). Values are written field by field in host byte
+    // order: files are meant to be read back on the machine family that wrote
+    // them, and every format starts with a magic + version for that reason.
+
+    template <class T>
+    inline void put(std::string& buf, const T& v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        buf.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    class BinReader {
+    public:
+        BinReader(const char* p, std::size_t n) : p_(p), end_(p + n) {}
+        explicit BinReader(const std::string& s) : BinReader(s.data(), s.size()) {}
+
+        template <class T>
+        T get() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (static_cast<std::size_t>(end_ - p_) < sizeof(T)) throw std::runtime_error("Truncated binary file");
+            T v;
+            std::memcpy(&v, p_, sizeof(T));
+            p_ += sizeof(T);
+            return v;
+        }
+
+        std::size_t remaining() const { return static_cast<std::size_t>(end_ - p_); }
+
+    private:
+        const char* p_;
+        const char* end_;
+    };
+
+    // BacktestResult, field by field (never memcpy the struct: padding is not stable).
+    inline void put_result(std::string& buf, const BacktestResult& r) {
+        put(buf, r.pnl);
+        put(buf, static_cast<std::uint64_t>(r.trades));
+        put(buf, r.max_drawdown);
+        put(buf, static_cast<std::int32_t>(r.best_start_date));
+        put(buf, static_cast<std::uint8_t>(r.pruned));
+        const RiskMetrics& m = r.risk;
+        put(buf, static_cast<std::uint64_t>(m.bars));
+        put(buf, m.win_rate); put(buf, m.profit_factor); put(buf, m.avg_trade); put(buf, m.avg_hold);
+        put(buf, m.exposure); put(buf, m.sharpe); put(buf, m.sortino); put(buf, m.ulcer);
+    }
+
+    inline BacktestResult get_result(BinReader& in) {
+        BacktestResult r{};
+        r.pnl = in.get<double>();
+        r.trades = static_cast<std::size_t>(in.get<std::uint64_t>());
+        r.max_drawdown = in.get<double>();
+        r.best_start_date = in.get<std::int32_t>();
+        r.pruned = in.get<std::uint8_t>() != 0;
+        RiskMetrics& m = r.risk;
+        m.bars = static_cast<std::size_t>(in.get<std::uint64_t>());
+        m.win_rate = in.get<double>(); m.profit_factor = in.get<double>(); m.avg_trade = in.get<double>(); m.avg_hold = in.get<double>();
+        m.exposure = in.get<double>(); m.sharpe = in.get<double>(); m.sortino = in.get<double>(); m.ulcer = in.get<double>();
+        return r;
+    }
+
+    // Content hash of candles, field by field for the same reason.
+    inline std::uint64_t hash_candles(std::span<const Candle> rows, std::uint64_t h = kFnvOffset) {
+        for (const Candle& c : rows) {
+            h = fnv1a64(&c.date, sizeof(c.date), h);
+            h = fnv1a64(&c.ts, sizeof(c.ts), h);
+            h = fnv1a64(&c.open, sizeof(double), h);
+            h = fnv1a64(&c.high, sizeof(double), h);
+            h = fnv1a64(&c.low, sizeof(double), h);
+            h = fnv1a64(&c.close, sizeof(double), h);
+            h = fnv1a64(&c.volume, sizeof(double), h);
+        }
+        return h;
+    }
+
+} // namespace sugar
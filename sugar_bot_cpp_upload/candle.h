@@ -5,8 +5,11 @@ namespace sugar {
 
                                                                     // Candle is the atomic data row indicators/strategies consume.
                                                                     // Keeping date as an int (YYYYMMDD) avoids time libs.
+                                                                    // ts carries the full bar time for intraday data; daily
+                                                                    // rows have midnight UTC of `date`.
     struct Candle {
-        std::int32_t date;                                          // e.g. 20250101
+        std::int32_t date;                                          // e.g. 20250101 (calendar date as written in the source)
+        std::int64_t ts{};                                          // bar time, UTC seconds since 1970-01-01
         double open{};
         double high{};
         double low{};
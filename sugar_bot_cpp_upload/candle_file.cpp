@@ -0,0 +1,169 @@
+#include "candle_file.h"
+#include "binio.h"
+#include "csv.h"
+#include "profile.h"
+#include "utils.h"
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace sugar {
+
+    namespace {
+
+        // Candle already is the on-disk record: bulk copies are safe.
+        constexpr bool kNativeLayout = sizeof(Candle) == kCandleBinRecord && offsetof(Candle, ts) == 8
+            && offsetof(Candle, open) == 16 && offsetof(Candle, volume) == 48;
+        constexpr std::size_t kRecordV1 = 48;                          // version 1: no ts, prices at offset 8
+
+        void encode(char* p, const Candle& c) {
+            const std::int32_t pad = 0;
+            std::memcpy(p, &c.date, 4); std::memcpy(p + 4, &pad, 4); std::memcpy(p + 8, &c.ts, 8);
+            std::memcpy(p + 16, &c.open, 8); std::memcpy(p + 24, &c.high, 8); std::memcpy(p + 32, &c.low, 8);
+            std::memcpy(p + 40, &c.close, 8); std::memcpy(p + 48, &c.volume, 8);
+        }
+
+        void decode(const char* p, Candle& c, std::size_t record) {
+            std::memcpy(&c.date, p, 4);
+            const std::size_t at = record == kRecordV1 ? 8 : 16;
+            if (record == kRecordV1) c.ts = ts_from_yyyymmdd(c.date);
+            else std::memcpy(&c.ts, p + 8, 8);
+            std::memcpy(&c.open, p + at, 8); std::memcpy(&c.high, p + at + 8, 8); std::memcpy(&c.low, p + at + 16, 8);
+            std::memcpy(&c.close, p + at + 24, 8); std::memcpy(&c.volume, p + at + 32, 8);
+        }
+
+        std::string header(std::uint64_t count) {
+            std::string h;
+            put(h, kCandleBinMagic); put(h, kCandleBinVersion);
+            put(h, static_cast<std::uint32_t>(kCandleBinRecord)); put(h, std::uint32_t(0));
+            put(h, count);
+            return h;
+        }
+
+        bool has_suffix(const std::string& s, const char* suffix) {
+            const std::size_t n = std::strlen(suffix);
+            return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+        }
+
+    } // namespace
+
+    CandleBinWriter::CandleBinWriter(const std::string& path) : path_(path) {
+        f_ = std::fopen(path.c_str(), "wb");
+        if (!f_) throw std::runtime_error("Failed to create " + path);
+        const auto h = header(0);
+        if (std::fwrite(h.data(), 1, h.size(), f_) != h.size()) { std::fclose(f_); f_ = nullptr; throw std::runtime_error("Failed to write " + path); }
+    }
+
+    CandleBinWriter::~CandleBinWriter() {
+        try { close(); }
+        catch (...) {}
+    }
+
+    void CandleBinWriter::append(std::span<const Candle> rows) {
+        if (!f_) throw std::runtime_error("CandleBinWriter: append after close");
+        std::size_t written;
+        if constexpr (kNativeLayout) {
+            written = std::fwrite(rows.data(), kCandleBinRecord, rows.size(), f_);
+        }
+        else {
+            buf_.resize(rows.size() * kCandleBinRecord);
+            for (std::size_t i = 0; i < rows.size(); ++i) encode(buf_.data() + i * kCandleBinRecord, rows[i]);
+            written = std::fwrite(buf_.data(), kCandleBinRecord, rows.size(), f_);
+        }
+        if (written != rows.size()) throw std::runtime_error("Failed to write " + path_);
+        count_ += rows.size();
+    }
+
+    void CandleBinWriter::close() {
+        if (!f_) return;
+        std::FILE* f = f_;
+        f_ = nullptr;
+        const auto h = header(count_);
+        const bool ok = std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(h.data(), 1, h.size(), f) == h.size();
+        if (std::fclose(f) != 0 || !ok) throw std::runtime_error("Failed to finish " + path_);
+    }
+
+    void write_candles_bin(const std::string& path, std::span<const Candle> rows) {
+        CandleBinWriter w(path);
+        w.append(rows);
+        w.close();
+    }
+
+    bool is_candle_bin(const std::string& path) {
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        std::uint32_t magic = 0;
+        const bool ok = std::fread(&magic, sizeof(magic), 1, f) == 1 && magic == kCandleBinMagic;
+        std::fclose(f);
+        return ok;
+    }
+
+    std::vector<Candle> load_candles_bin(const std::string& path) {
+        SUGAR_PROF_SCOPE("load/bin");
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) throw std::runtime_error("Failed to open " + path);
+        try {
+            char hb[kCandleBinHeader];
+            if (std::fread(hb, 1, sizeof(hb), f) != sizeof(hb)) throw std::runtime_error("Truncated candle file: " + path);
+            BinReader in(hb, sizeof(hb));
+            if (in.get<std::uint32_t>() != kCandleBinMagic) throw std::runtime_error("Not a candle file: " + path);
+            const auto version = in.get<std::uint32_t>();
+            if (version != 1 && version != kCandleBinVersion) throw std::runtime_error("Unsupported candle file version: " + path);
+            const std::size_t record = in.get<std::uint32_t>();
+            if (record != (version == 1 ? kRecordV1 : kCandleBinRecord)) throw std::runtime_error("Unexpected candle record size: " + path);
+            in.get<std::uint32_t>();
+            const auto count = static_cast<std::size_t>(in.get<std::uint64_t>());
+
+            std::vector<Candle> rows(count);
+            std::size_t got;
+            if (kNativeLayout && record == kCandleBinRecord) got = std::fread(rows.data(), kCandleBinRecord, count, f);
+            else {
+                std::vector<char> buf(std::size_t(1) << 20);
+                const std::size_t per = buf.size() / record;
+                got = 0;
+                while (got < count) {
+                    const std::size_t want = std::min(per, count - got);
+                    const std::size_t n = std::fread(buf.data(), record, want, f);
+                    for (std::size_t i = 0; i < n; ++i) decode(buf.data() + i * record, rows[got + i], record);
+                    got += n;
+                    if (n < want) break;
+                }
+            }
+            if (got != count) throw std::runtime_error("Truncated candle file: " + path);
+            std::fclose(f);
+            return rows;
+        }
+        catch (...) { std::fclose(f); throw; }
+    }
+
+    void append_candle_csv(std::string& out, const Candle& c, int decimals) {
+        char buf[2048];                                                 // 5 values up to DBL_MAX in fixed notation still fit
+        decimals = std::clamp(decimals, 0, 17);
+        char* p = buf;
+        char* const end = buf + sizeof(buf);
+        const int d = c.date;
+        if (c.ts != ts_from_yyyymmdd(d)) { format_iso8601(c.ts, p); p += 20; }     // intraday: keep the time
+        else {
+            const int y = d / 10000, m = d / 100 % 100, day = d % 100;
+            p = std::to_chars(p, end, y).ptr;
+            *p++ = '-'; *p++ = char('0' + m / 10); *p++ = char('0' + m % 10);
+            *p++ = '-'; *p++ = char('0' + day / 10); *p++ = char('0' + day % 10);
+        }
+        for (double v : { c.open, c.high, c.low, c.close }) {
+            *p++ = ',';
+            p = std::to_chars(p, end, v, std::chars_format::fixed, decimals).ptr;
+        }
+        *p++ = ',';
+        p = std::to_chars(p, end, c.volume, std::chars_format::fixed, 0).ptr;
+        *p++ = '\n';
+        out.append(buf, p);
+    }
+
+    std::vector<Candle> load_candles(const std::string& path, bool mapped) {
+        if (has_suffix(path, ".scb") || is_candle_bin(path)) return load_candles_bin(path);
+        return mapped ? load_candles_csv_mapped(path) : load_candles_csv(path);
+    }
+
+} // namespace sugar
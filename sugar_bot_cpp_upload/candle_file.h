@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+#include "candle.h"
+
+namespace sugar {
+
+    // ---- binary candle files (*.scb) ---------------------------------------
+    //
+    // Header: "SCB1" magic, u32 version, u32 record bytes (56), u32 reserved,
+    // u64 candle count. Then fixed 56-byte records: i32 date, 4 unused bytes,
+    // i64 ts, open, high, low, close, volume as doubles, host byte order (like
+    // the other binary files, read back on the machine family that wrote them).
+    // Where Candle already has that layout, reading is one bulk read.
+    // Version 1 files (48-byte records without ts) still load, as daily bars.
+
+    inline constexpr std::uint32_t kCandleBinMagic = 0x31424353;        // "SCB1"
+    inline constexpr std::uint32_t kCandleBinVersion = 2;
+    inline constexpr std::size_t kCandleBinRecord = 56;
+    inline constexpr std::size_t kCandleBinHeader = 24;
+
+    // Streams candles to a .scb file in chunks; the count is patched on close().
+    class CandleBinWriter {
+    public:
+        explicit CandleBinWriter(const std::string& path);
+        ~CandleBinWriter();
+
+        CandleBinWriter(const CandleBinWriter&) = delete;
+        CandleBinWriter& operator=(const CandleBinWriter&) = delete;
+
+        void append(std::span<const Candle> rows);
+        void close();                                                   // throws on I/O failure; the destructor only tries
+        std::uint64_t count() const { return count_; }
+
+    private:
+        std::string path_;
+        std::FILE* f_ = nullptr;
+        std::uint64_t count_ = 0;
+        std::vector<char> buf_;
+    };
+
+    void write_candles_bin(const std::string& path, std::span<const Candle> rows);
+    std::vector<Candle> load_candles_bin(const std::string& path);
+    bool is_candle_bin(const std::string& path);                        // starts with the .scb magic
+
+    // ---- CSV output ----------------------------------------------------------
+
+    // Appends "YYYY-MM-DD,open,high,low,close,volume\n" with `decimals` digits,
+    // via std::to_chars (no locale, no iostream), in the layout load_candles_csv reads.
+    // Bars whose ts is not midnight UTC of their date are written as
+    // "YYYY-MM-DDTHH:MM:SSZ" so intraday rows keep their time.
+    void append_candle_csv(std::string& out, const Candle& c, int decimals = 4);
+    inline constexpr const char* kCandleCsvHeader = "Date,Open,High,Low,Close,Volume\n";
+
+    // ---- any format ----------------------------------------------------------
+
+    // load_candles_bin for .scb files, otherwise the CSV loader (mapped if asked).
+    std::vector<Candle> load_candles(const std::string& path, bool mapped = false);
+
+} // namespace sugar
@@ -0,0 +1,107 @@
+#include "checkpoint.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace sugar {
+
+    static constexpr std::uint32_t kMagic = 0x4B434753;                 // "SGCK"
+    static constexpr std::uint32_t kVersion = 3;
+
+    template <class T>
+    static std::uint64_t hash_vec(const std::vector<T>& v, std::uint64_t h) {
+        const std::uint64_t n = v.size();
+        h = fnv1a64(&n, sizeof(n), h);
+        return v.empty() ? h : fnv1a64(v.data(), v.size() * sizeof(T), h);
+    }
+
+    std::uint64_t sweep_config_hash(const CandleSeries& data,
+        const std::vector<std::size_t>& fasts,
+        const std::vector<std::size_t>& slows,
+        const std::vector<std::size_t>& rocs,
+        const std::vector<double>& threshes,
+        const SweepOptions& opts) {
+        std::uint64_t h = hash_candles(data.rows());
+        h = hash_vec(fasts, h);
+        h = hash_vec(slows, h);
+        h = hash_vec(rocs, h);
+        h = hash_vec(threshes, h);
+        const std::uint64_t flags[5] = { opts.prune ? 1u : 0u, opts.top_k, opts.pair_begin, opts.pair_end,
+            static_cast<std::uint64_t>(opts.rank) };
+        return fnv1a64(flags, sizeof(flags), h);
+    }
+
+    void put_row(std::string& buf, const SweepRow& row) {
+        const auto& [f, s, rlen, th] = row.p;
+        put(buf, row.score);
+        put_result(buf, row.r);
+        put(buf, static_cast<std::uint64_t>(f));
+        put(buf, static_cast<std::uint64_t>(s));
+        put(buf, static_cast<std::uint64_t>(rlen));
+        put(buf, th);
+    }
+
+    SweepRow get_row(BinReader& in) {
+        SweepRow row{};
+        row.score = in.get<double>();
+        row.r = get_result(in);
+        const auto f = in.get<std::uint64_t>();
+        const auto s = in.get<std::uint64_t>();
+        const auto rlen = in.get<std::uint64_t>();
+        row.p = { f, s, rlen, in.get<double>() };
+        return row;
+    }
+
+    void save_checkpoint(const std::string& path, const SweepCheckpoint& ck) {
+        std::string buf;
+        put(buf, kMagic);
+        put(buf, kVersion);
+        put(buf, ck.config_hash);
+        put(buf, ck.next_pair);
+        put(buf, ck.best_score);
+        put_row(buf, { ck.best_score, ck.best, ck.best_params });
+        put(buf, static_cast<std::uint64_t>(ck.top_k));
+        put(buf, static_cast<std::uint64_t>(ck.heap.size()));
+        for (const auto& row : ck.heap) put_row(buf, row);
+        put(buf, ck.evaluated);
+        put(buf, ck.pruned);
+        put(buf, ck.bars_skipped);
+        put(buf, ck.results_bytes);
+
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+            if (!ofs) throw std::runtime_error("Failed to write checkpoint: " + tmp);
+            ofs.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+            if (!ofs) throw std::runtime_error("Failed to write checkpoint: " + tmp);
+        }
+        std::filesystem::rename(tmp, path);
+    }
+
+    bool load_checkpoint(const std::string& path, SweepCheckpoint& ck) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs.is_open()) return false;
+        const std::string buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+        BinReader in(buf);
+        if (in.get<std::uint32_t>() != kMagic || in.get<std::uint32_t>() != kVersion)
+            throw std::runtime_error("Not a sweep checkpoint (or unsupported version): " + path);
+        ck.config_hash = in.get<std::uint64_t>();
+        ck.next_pair = in.get<std::uint64_t>();
+        ck.best_score = in.get<double>();
+        const SweepRow best = get_row(in);
+        ck.best = best.r;
+        ck.best_params = best.p;
+        ck.top_k = static_cast<std::size_t>(in.get<std::uint64_t>());
+        const auto n = in.get<std::uint64_t>();
+        ck.heap.clear();
+        for (std::uint64_t i = 0; i < n; ++i) ck.heap.push_back(get_row(in));
+        ck.evaluated = in.get<std::uint64_t>();
+        ck.pruned = in.get<std::uint64_t>();
+        ck.bars_skipped = in.get<std::uint64_t>();
+        ck.results_bytes = in.get<std::uint64_t>();
+        return true;
+    }
+
+} // namespace sugar
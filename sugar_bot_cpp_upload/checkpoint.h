@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "binio.h"
+#include "sweep.h"
+
+namespace sugar {
+
+    // Everything sweep_roc_sma needs to continue exactly where it stopped.
+    // Work is tracked in (fast, slow) pair order: every pair with
+    // fi * slows.size() + si < next_pair has been fully evaluated.
+    struct SweepCheckpoint {
+        std::uint64_t config_hash{};                                    // data + grid + options; resume refuses a mismatch
+        std::uint64_t next_pair{};
+        double best_score{};
+        BacktestResult best{};
+        RocSmaParams best_params{ 0, 0, 0, 0.0 };
+        std::size_t top_k{};
+        std::vector<SweepRow> heap;                                     // TopK::heap() order, so ties resolve identically
+        std::uint64_t evaluated{};
+        std::uint64_t pruned{};
+        std::uint64_t bars_skipped{};
+        std::uint64_t results_bytes{};                                  // result-store size at this point; resume truncates back to it
+    };
+
+    // Hash of everything that influences the sweep outcome.
+    std::uint64_t sweep_config_hash(const CandleSeries& data,
+        const std::vector<std::size_t>& fasts,
+        const std::vector<std::size_t>& slows,
+        const std::vector<std::size_t>& rocs,
+        const std::vector<double>& threshes,
+        const SweepOptions& opts);
+
+    // Written to `path + ".tmp"` then renamed over `path`, so a crash mid-write
+    // leaves the previous checkpoint intact.
+    void save_checkpoint(const std::string& path, const SweepCheckpoint& ck);
+
+    // False if the file does not exist; throws on a corrupt or foreign file.
+    bool load_checkpoint(const std::string& path, SweepCheckpoint& ck);
+
+    // SweepRow encoding shared by the checkpoint and other sweep files.
+    void put_row(std::string& buf, const SweepRow& row);
+    SweepRow get_row(BinReader& in);
+
+} // namespace sugar
@@ -1,5 +1,6 @@
 ﻿#include "csv.h"
 #include "utils.h"
+#include "profile.h"
 #include <fstream>
 #include <stdexcept>
 #include <algorithm>
@@ -7,6 +8,14 @@
 #include <string_view>
 #include <cctype>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SUGAR_HAS_MMAP 1
+#endif
+
 namespace sugar {
 
     // Minimal CSV splitter:
@@ -36,9 +45,35 @@ namespace sugar {
         return first.find("date") != std::string::npos || first.find("time") != std::string::npos;              // once every character in the header string is lowercase, search for 'date' or 'time' return a position/index to that location, or npos
     }
 
+    bool parse_candle_line(std::string& line, bool& first_line, Candle& c) {
+        if (line.empty()) return false;                                                                         // if line is empty, skip this loop and restart it
+        if (!line.empty() && line.back() == '\r') line.pop_back();                                              // strip a trailing \r if present (CRLF files)
+
+        auto cols = split_csv_line(line);                                                                       // a vector of strings, populated with each element of a line from the csv file
+        if (first_line) {                                                                                       // test if it is the first line of the csv file
+            first_line = false;                                                                                 // set to false after first case of true
+            if (maybe_header(cols)) return false;                                                               // test if first line is a header, if true, skip the rest of the loop
+        }
+        if (cols.size() < 5) return false;                                                                      // not enough fields → skip
+
+        c = Candle{};                                                                                           // candle object 
+        int date = -1;                                                                                          // date as written, accaptable formats: 1) "YYYYMMDD" 2) "YYYY-MM-DD" 3) "YYYY/MM/DD" 4) "MM/DD/YYYY"
+        c.ts = parse_timestamp(cols[0], &date);                                                                 // 5) ISO-8601 date-time (T or space, optional zone) 6) epoch s / ms -> UTC seconds
+        if (c.ts == kNoTimestamp) return false;                                                                 // skip rows whose time column does not parse
+        c.date = date;
+        c.open = std::stod(cols[1]);                                                                            // store open
+        c.high = std::stod(cols[2]);                                                                            // store high
+        c.low = std::stod(cols[3]);                                                                             // store low
+        c.close = std::stod(cols[4]);                                                                           // store close
+        c.volume = (cols.size() >= 6) ? std::stod(cols[5]) : 0.0;                                               // if the column count is ≥ 6, parse cols[5], else set 0.0
+
+        return true;
+    }
+
     // Read CSV file into a vector<Candle>.
     // Required columns by index: 0=Date, 1=Open, 2=High, 3=Low, 4=Close, 5=Volume (optional)
     std::vector<Candle> load_candles_csv(const std::string& path) {                                             // the actual candle loader function, accepts a compatable string object argument, passed by const reference
+        SUGAR_PROF_SCOPE("load/csv");
                                                                                                                 // Two-step open avoids MSVC "vexing parse" and name-collision weirdness.
         std::ifstream ifs;                                                                                      // in file stream object, to be used later for reading the csv
         ifs.open(path, std::ios::in);                                                                           // opens file stream for reading path
@@ -51,28 +86,49 @@ namespace sugar {
         bool first_line = true;                                                                                 // bool variable to used with the 'maybe_header' function later
 
         while (std::getline(ifs, line)) {                                                                       // create a while loop dependant on the implicit pass/fail state of the getline() function, pass each line from ifs into line.
-            if (line.empty()) continue;                                                                         // if line is empty, skip this loop and restart it
-            if (!line.empty() && line.back() == '\r') line.pop_back();                                          // strip a trailing \r if present (CRLF files)
-
-            auto cols = split_csv_line(line);                                                                   // a vector of strings, populated with each element of a line from the csv file
-            if (first_line) {                                                                                   // test if it is the first line of the csv file
-                first_line = false;                                                                             // set to false after first case of true
-                if (maybe_header(cols)) continue;                                                               // test if first line is a header, if true, skip the rest of the loop
-            }
-            if (cols.size() < 5) continue;                                                                      // not enough fields → skip
+            Candle c;
+            if (parse_candle_line(line, first_line, c)) rows.push_back(c);                                  // store each candle object in rows
+        }
+        return rows;                                                                                            // return vector of candles in rows
+    }
 
-            Candle c{};                                                                                         // candle object 
-            c.date = parse_yyyymmdd(cols[0]);                                                                   // store date from string in cols[0] as an int, accaptable formats: 1) "YYYYMMDD" 2) "YYYY-MM-DD" 3) "YYYY/MM/DD" 4) "MM/DD/YYYY"
-            if (c.date < 0) continue;                                                                           // skip row with date less than zero
-            c.open = std::stod(cols[1]);                                                                        // store open
-            c.high = std::stod(cols[2]);                                                                        // store high
-            c.low = std::stod(cols[3]);                                                                         // store low
-            c.close = std::stod(cols[4]);                                                                       // store close
-            c.volume = (cols.size() >= 6) ? std::stod(cols[5]) : 0.0;                                           // if the column count is ≥ 6, parse cols[5], else set 0.0
+    std::vector<Candle> parse_candles_csv(std::string_view text) {
+        SUGAR_PROF_SCOPE("load/csv_parse");
+        std::vector<Candle> rows;
+        rows.reserve(text.size() / 48);                                                                         // rough bytes per row: one allocation for typical files
+        std::string line;
+        bool first_line = true;
+        while (!text.empty()) {
+            const auto nl = text.find('\n');
+            line.assign(text.substr(0, nl));
+            text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+            Candle c;
+            if (parse_candle_line(line, first_line, c)) rows.push_back(c);
+        }
+        return rows;
+    }
 
-            rows.push_back(c);                                                                                  // store each candle object in rows
+    std::vector<Candle> load_candles_csv_mapped(const std::string& path) {
+        SUGAR_PROF_SCOPE("load/csv_mapped");
+#ifdef SUGAR_HAS_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Failed to open CSV: " + path);
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) { ::close(fd); throw std::runtime_error("Failed to stat CSV: " + path); }
+        if (st.st_size == 0) { ::close(fd); return {}; }
+        void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);                                                                                            // the mapping keeps the file referenced
+        if (p == MAP_FAILED) return load_candles_csv(path);
+        ::madvise(p, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);                                     // aggressive read-ahead
+        try {
+            auto rows = parse_candles_csv({ static_cast<const char*>(p), static_cast<std::size_t>(st.st_size) });
+            ::munmap(p, static_cast<std::size_t>(st.st_size));
+            return rows;
         }
-        return rows;                                                                                            // return vector of candles in rows
+        catch (...) { ::munmap(p, static_cast<std::size_t>(st.st_size)); throw; }
+#else
+        return load_candles_csv(path);
+#endif
     }
 
 } // namespace sugar
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include "candle.h"
 
@@ -10,6 +11,18 @@ namespace sugar {
                                                                             // avoid vexing parse/macros in MSVC for now.
     std::vector<Candle> load_candles_csv(const std::string& path);
 
+                                                                            // Same rows as load_candles_csv, parsed from text already in memory.
+    std::vector<Candle> parse_candles_csv(std::string_view text);
+
+                                                                            // Same rows as load_candles_csv; maps the file (POSIX) instead of
+                                                                            // streaming it through an ifstream. Falls back to load_candles_csv.
+    std::vector<Candle> load_candles_csv_mapped(const std::string& path);
+
+                                                                            // One CSV line -> candle, for line-at-a-time sources (live feeds).
+                                                                            // Pass first_line = true for a source's first line (header detection);
+                                                                            // returns false for header, blank or malformed-date lines.
+    bool parse_candle_line(std::string& line, bool& first_line, Candle& out);
+
                                                                             // Small helper exposed for convenience/testing:
                                                                             // split a CSV line into fields (double-quote aware, minimalistic).
     std::vector<std::string> split_csv_line(std::string_view line);
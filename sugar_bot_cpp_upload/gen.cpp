@@ -0,0 +1,137 @@
+// sugar_gen: reproducible synthetic OHLCV histories for benchmarks and scale tests.
+//
+//   sugar_gen --bars N [--symbols K] [--model gbm|regime|jump] [--seed S] [--out PATH]
+//             [--format csv|bin] [--threads N] [--start YYYYMMDD] [--bars-per-day N]
+//             [--price P] [--drift D] [--vol V] [--days-per-year N] [--revert-years Y]
+//
+// One symbol: PATH is the file (default synthetic.csv). Several: PATH is a directory
+// that receives SYM00000.csv, SYM00001.csv, ... ready for `sugar_Bot --universe`.
+// --format defaults to bin for *.scb paths, csv otherwise. N takes k/m/g suffixes.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "candle_file.h"
+#include "parallel.h"
+#include "synth.h"
+
+
+static std::size_t parse_count(const std::string& s) {
+	std::size_t used = 0;
+	const double v = std::stod(s, &used);
+	const std::string suffix = s.substr(used);
+	double mult = 1.0;
+	if (suffix == "k" || suffix == "K") mult = 1e3;
+	else if (suffix == "m" || suffix == "M") mult = 1e6;
+	else if (suffix == "g" || suffix == "G") mult = 1e9;
+	else if (!suffix.empty()) throw std::runtime_error("Bad count: " + s);
+	return static_cast<std::size_t>(v * mult + 0.5);
+}
+
+
+// Generates one symbol into `path` chunk by chunk; returns bytes written.
+static std::uint64_t write_symbol(const sugar::SynthOptions& opts, std::size_t bars, std::size_t symbol,
+	const std::string& path, bool binary) {
+	constexpr std::size_t kChunk = std::size_t(1) << 16;
+	sugar::SynthGenerator gen(opts, bars, symbol);
+	std::vector<sugar::Candle> chunk(std::min(kChunk, bars));
+	if (binary) {
+		sugar::CandleBinWriter out(path);
+		for (std::size_t done = 0; done < bars; done += chunk.size()) {
+			chunk.resize(std::min(kChunk, bars - done));
+			gen.fill(chunk);
+			out.append(chunk);
+		}
+		out.close();
+		return sugar::kCandleBinHeader + std::uint64_t(bars) * sugar::kCandleBinRecord;
+	}
+	std::FILE* f = std::fopen(path.c_str(), "wb");
+	if (!f) throw std::runtime_error("Failed to create " + path);
+	std::string text = sugar::kCandleCsvHeader;
+	std::uint64_t bytes = 0;
+	bool ok = true;
+	for (std::size_t done = 0; done < bars && ok; done += chunk.size()) {
+		chunk.resize(std::min(kChunk, bars - done));
+		gen.fill(chunk);
+		for (const auto& c : chunk) sugar::append_candle_csv(text, c);
+		ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+		bytes += text.size();
+		text.clear();
+	}
+	if (bars == 0) ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+	if (std::fclose(f) != 0 || !ok) throw std::runtime_error("Failed to write " + path);
+	return bytes;
+}
+
+
+int main(int argc, char** argv) {
+	try {
+		sugar::SynthOptions opts;
+		std::size_t bars = 0, symbols = 1, threads = 0;
+		std::string out_path, format;
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			auto value = [&]() -> std::string {
+				if (i + 1 >= argc) throw std::runtime_error("Missing value for " + std::string(arg));
+				return argv[++i];
+			};
+			if (arg == "--bars") bars = parse_count(value());
+			else if (arg == "--symbols") symbols = parse_count(value());
+			else if (arg == "--model") opts.model = sugar::parse_synth_model(value());
+			else if (arg == "--seed") opts.seed = std::stoull(value());
+			else if (arg == "--out") out_path = value();
+			else if (arg == "--format") format = value();
+			else if (arg == "--threads") threads = std::stoull(value());
+			else if (arg == "--start") opts.start_date = std::stoi(value());
+			else if (arg == "--bars-per-day") opts.bars_per_day = std::stoull(value());
+			else if (arg == "--price") opts.start_price = std::stod(value());
+			else if (arg == "--drift") opts.drift = std::stod(value());
+			else if (arg == "--vol") opts.vol = std::stod(value());
+			else if (arg == "--days-per-year") opts.days_per_year = std::stod(value());
+			else if (arg == "--revert-years") opts.revert_years = std::stod(value());
+			else throw std::runtime_error("Unknown option: " + std::string(arg));
+		}
+		if (bars == 0) throw std::runtime_error("Usage: sugar_gen --bars N [--symbols K] [--model gbm|regime|jump] [--out PATH] ...");
+		if (symbols == 0) throw std::runtime_error("--symbols must be at least 1");
+		if (out_path.empty()) out_path = symbols == 1 ? "synthetic.csv" : "synthetic";
+		if (format.empty()) format = out_path.size() > 4 && out_path.compare(out_path.size() - 4, 4, ".scb") == 0 ? "bin" : "csv";
+		if (format != "csv" && format != "bin") throw std::runtime_error("--format wants csv or bin: " + format);
+		const bool binary = format == "bin";
+
+		std::vector<std::string> paths;
+		if (symbols == 1) paths.push_back(out_path);
+		else {
+			std::filesystem::create_directories(out_path);
+			for (std::size_t s = 0; s < symbols; ++s) {
+				char name[32];
+				std::snprintf(name, sizeof(name), "SYM%05zu.%s", s, binary ? "scb" : "csv");
+				paths.push_back((std::filesystem::path(out_path) / name).string());
+			}
+		}
+
+		const auto t0 = std::chrono::steady_clock::now();
+		std::atomic<std::uint64_t> bytes{ 0 };
+		sugar::parallel_for(symbols, threads, [&](std::size_t s) {
+			bytes += write_symbol(opts, bars, s, paths[s], binary);
+		});
+		const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+		const sugar::SynthGenerator probe(opts, bars);
+		std::cerr << "[gen] " << symbols << " x " << bars << " bars (" << sugar::synth_model_name(opts.model) << ", seed "
+			<< opts.seed << ", " << probe.bars_per_day() << " bar(s)/day) -> " << out_path << " as " << format << ": "
+			<< double(bytes.load()) / 1e9 << " GB in " << secs << "s, " << double(bytes.load()) / 1e9 / std::max(secs, 1e-9)
+			<< " GB/s, " << double(bars) * double(symbols) / 1e6 / std::max(secs, 1e-9) << " M bars/s\n";
+		return 0;
+	}
+	catch (const std::exception& ex) {
+		std::cerr << "Error: " << ex.what() << "\n"; return 1;
+	}
+}
@@ -0,0 +1,132 @@
+#include "indicator_bank.h"
+#include "indicators_composite.h"
+#include "parallel.h"
+#include "profile.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace sugar {
+
+    namespace {
+
+        struct FamilyName { IndicatorFamily family; const char* name; };
+        constexpr FamilyName kFamilies[] = {
+            { IndicatorFamily::Sma, "sma" }, { IndicatorFamily::Ema, "ema" }, { IndicatorFamily::Roc, "roc" },
+            { IndicatorFamily::RocSma, "roc_sma" }, { IndicatorFamily::RocEma, "roc_ema" },
+        };
+
+        bool is_roc_of(IndicatorFamily f) { return f == IndicatorFamily::RocSma || f == IndicatorFamily::RocEma; }
+
+        // The period a roc_sma / roc_ema key reads, as a key of its own.
+        IndicatorKey base_of(const IndicatorKey& key) {
+            return { key.family == IndicatorFamily::RocSma ? IndicatorFamily::Sma : IndicatorFamily::Ema, key.n, 0 };
+        }
+
+        std::uint32_t parse_length(const std::string& s, const std::string& text) {
+            std::size_t used = 0;
+            unsigned long long v = 0;
+            try { v = std::stoull(s, &used); }
+            catch (const std::exception&) { used = 0; }
+            if (s.empty() || s[0] == '-' || used != s.size() || v == 0 || v > UINT32_MAX)
+                throw std::invalid_argument("indicator length must be a positive integer: " + text);
+            return static_cast<std::uint32_t>(v);
+        }
+
+        // sma / ema / roc over closes into `out`, as SMAIndicator / EMAIndicator / ROCIndicator compute them.
+        void compute_plain(const IndicatorKey& key, const CandleSeries& data, std::span<const double> closes, std::span<double> out) {
+            switch (key.family) {
+            case IndicatorFamily::Sma: sma_into(closes, key.n, out); return;
+            case IndicatorFamily::Roc: roc_into(closes, key.n, out); return;
+            default: break;
+            }
+            if (closes.size() >= key.n) { ema_into(closes, key.n, out); return; }
+            const auto v = EMAIndicator{ key.n }.compute(data);          // short series: EMAIndicator's first-value seed
+            std::copy(v.begin(), v.end(), out.begin());
+        }
+
+    } // namespace
+
+    IndicatorKey parse_indicator_key(const std::string& text) {
+        const auto colon = text.find(':');
+        if (colon == std::string::npos) throw std::invalid_argument("indicator wants KIND:N, got " + text);
+        const std::string kind = text.substr(0, colon);
+        const auto it = std::find_if(std::begin(kFamilies), std::end(kFamilies), [&](const FamilyName& f) { return kind == f.name; });
+        if (it == std::end(kFamilies))
+            throw std::invalid_argument("indicator kind must be sma, ema, roc, roc_sma or roc_ema: " + text);
+        IndicatorKey key{ it->family, 0, 0 };
+        const auto slash = text.find('/', colon);
+        if (is_roc_of(key.family) != (slash != std::string::npos))
+            throw std::invalid_argument(is_roc_of(key.family) ? "roc_sma / roc_ema want KIND:N/R, got " + text
+                : "only roc_sma / roc_ema take a /R length: " + text);
+        key.n = parse_length(text.substr(colon + 1, slash == std::string::npos ? std::string::npos : slash - colon - 1), text);
+        if (slash != std::string::npos) key.roc = parse_length(text.substr(slash + 1), text);
+        return key;
+    }
+
+    std::string indicator_key_name(const IndicatorKey& key) {
+        std::string out = kFamilies[static_cast<std::size_t>(key.family)].name;
+        out += ":" + std::to_string(key.n);
+        if (is_roc_of(key.family)) out += "/" + std::to_string(key.roc);
+        return out;
+    }
+
+    IndicatorPtr make_indicator(const IndicatorKey& key) {
+        switch (key.family) {
+        case IndicatorFamily::Sma: return std::make_shared<SMAIndicator>(key.n);
+        case IndicatorFamily::Ema: return std::make_shared<EMAIndicator>(key.n);
+        case IndicatorFamily::Roc: return std::make_shared<ROCIndicator>(key.n);
+        case IndicatorFamily::RocSma: return std::make_shared<ROCOfIndicator>(std::make_shared<SMAIndicator>(key.n), key.roc);
+        case IndicatorFamily::RocEma: break;
+        }
+        return std::make_shared<ROCOfIndicator>(std::make_shared<EMAIndicator>(key.n), key.roc);
+    }
+
+    IndicatorBank::IndicatorBank(const CandleSeries& data, std::vector<IndicatorKey> keys, std::size_t threads)
+        : keys_(std::move(keys)), bars_(data.size()) {
+        SUGAR_PROF_SCOPE("indicator/bank");
+        std::sort(keys_.begin(), keys_.end());
+        keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+        for (const auto& key : keys_)
+            if (key.n == 0 || (is_roc_of(key.family) && key.roc == 0))
+                throw std::invalid_argument("indicator length must be positive: " + indicator_key_name(key));
+
+        values_.resize((keys_.size() + 1) * bars_);
+        const auto closes = data.closes();
+        std::copy(closes.begin(), closes.end(), values_.begin() + static_cast<std::ptrdiff_t>(keys_.size() * bars_));
+        auto row = [&](std::vector<double>& block, std::size_t i) { return std::span<double>(block.data() + i * bars_, bars_); };
+
+        // Pass 1: the plain rows, plus every period a roc_* key reads that the bank does not hold.
+        std::vector<IndicatorKey> extra;
+        for (const auto& key : keys_)
+            if (is_roc_of(key.family) && !std::binary_search(keys_.begin(), keys_.end(), base_of(key))) extra.push_back(base_of(key));
+        extra.erase(std::unique(extra.begin(), extra.end()), extra.end());  // keys_ is sorted by (family, n), so extra is too
+        std::vector<double> extra_values(extra.size() * bars_);
+        std::vector<std::size_t> plain;
+        for (std::size_t i = 0; i < keys_.size(); ++i) if (!is_roc_of(keys_[i].family)) plain.push_back(i);
+        parallel_for(plain.size() + extra.size(), threads, [&](std::size_t j) {
+            if (j < plain.size()) compute_plain(keys_[plain[j]], data, closes, row(values_, plain[j]));
+            else compute_plain(extra[j - plain.size()], data, closes, row(extra_values, j - plain.size()));
+        });
+
+        // Pass 2: ROC over those rows.
+        std::vector<std::size_t> derived;
+        for (std::size_t i = 0; i < keys_.size(); ++i) if (is_roc_of(keys_[i].family)) derived.push_back(i);
+        parallel_for(derived.size(), threads, [&](std::size_t j) {
+            const auto& key = keys_[derived[j]];
+            const auto base = base_of(key);
+            const auto held = std::lower_bound(keys_.begin(), keys_.end(), base);
+            const std::span<const double> in = held != keys_.end() && *held == base
+                ? series(static_cast<std::size_t>(held - keys_.begin()))
+                : row(extra_values, static_cast<std::size_t>(std::lower_bound(extra.begin(), extra.end(), base) - extra.begin()));
+            roc_into(in, key.roc, row(values_, derived[j]));
+        });
+        computed_ = keys_.size() + extra.size();
+    }
+
+    std::size_t IndicatorBank::index_of(const IndicatorKey& key) const {
+        const auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+        if (it == keys_.end() || *it != key) throw std::out_of_range("IndicatorBank: " + indicator_key_name(key) + " not computed");
+        return static_cast<std::size_t>(it - keys_.begin());
+    }
+
+} // namespace sugar
@@ -0,0 +1,69 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "indicator.h"
+#include "series.h"
+
+namespace sugar {
+
+    // Indicator series over closes that sweeps read side by side.
+    //
+    //   sma:N        SMAIndicator(N)
+    //   ema:N        EMAIndicator(N)
+    //   roc:N        ROCIndicator(N)
+    //   roc_sma:N/R  ROCOfIndicator(SMAIndicator(N), R)
+    //   roc_ema:N/R  ROCOfIndicator(EMAIndicator(N), R)
+    //
+    // Each is computed with the same kernels as the indicator it names, so
+    // a bank row equals that indicator's compute() bit for bit.
+
+    enum class IndicatorFamily : std::uint8_t { Sma, Ema, Roc, RocSma, RocEma };
+
+    struct IndicatorKey {
+        IndicatorFamily family{};
+        std::uint32_t n{};                                              // period (the ROC length for roc)
+        std::uint32_t roc{};                                            // ROC length for roc_sma / roc_ema, else 0
+
+        auto operator<=>(const IndicatorKey&) const = default;
+    };
+
+    // "sma:20", "roc_ema:50/10"; throws std::invalid_argument.
+    IndicatorKey parse_indicator_key(const std::string& text);
+    std::string indicator_key_name(const IndicatorKey& key);            // the inverse
+    IndicatorPtr make_indicator(const IndicatorKey& key);               // the Indicator a bank row equals
+
+    // Every distinct series of a key list, computed once and stored row by
+    // row in one contiguous block (row i at i * bars()), closes in the last
+    // row. roc_sma / roc_ema read the sma / ema row of their period when
+    // the bank holds it; a period only they need is built once, outside the
+    // bank, and dropped after. Rows are built in parallel; the bank is
+    // read-only afterwards, so any number of threads may read it at once.
+    // Costs (size() + 1) * bars() doubles.
+    class IndicatorBank {
+    public:
+        IndicatorBank(const CandleSeries& data, std::vector<IndicatorKey> keys, std::size_t threads = 0);
+
+        std::size_t size() const { return keys_.size(); }               // distinct series
+        std::size_t bars() const { return bars_; }
+        const IndicatorKey& key(std::size_t i) const { return keys_[i]; }
+        std::size_t index_of(const IndicatorKey& key) const;            // throws std::out_of_range if not held
+
+        std::span<const double> series(std::size_t i) const { return { values_.data() + i * bars_, bars_ }; }
+        std::span<const double> series(const IndicatorKey& key) const { return series(index_of(key)); }
+        std::span<const double> closes() const { return series(keys_.size()); }
+
+        std::size_t bytes() const { return values_.size() * sizeof(double); }
+        std::size_t computed() const { return computed_; }              // series built, scratch intermediates included
+
+    private:
+        std::vector<IndicatorKey> keys_;                                // sorted, unique
+        std::size_t bars_ = 0;
+        std::size_t computed_ = 0;
+        std::vector<double> values_;
+    };
+
+} // namespace sugar
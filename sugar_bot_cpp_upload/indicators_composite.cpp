@@ -1,8 +1,10 @@
 #include "indicators_composite.h"
+#include "profile.h"
 
 namespace sugar {
 
     std::vector<double> MapIndicator::compute(const CandleSeries& series) const {
+        SUGAR_PROF_SCOPE("indicator/map");
         const auto base_vals = base_->compute(series);
         return fn_(base_vals);
     }
@@ -1,4 +1,6 @@
 ﻿#include "indicators_ema.h"
+#include "profile.h"
+#include <algorithm>
 #include <numeric> 
 #include <limits>
 #include <cmath>
@@ -13,6 +15,7 @@ namespace sugar {
 	std::vector<double> EMAIndicator::compute(const CandleSeries& series) const {								// Override of Indicator::compute; trailing const must match header declaration,
 																													// returns vector of doubles, accepts CandleSeries by const ref,
 																													// Note: override keyword appears only in the class (header), not here
+		SUGAR_PROF_SCOPE("indicator/ema");
 
 		const auto v = series.closes();																			// extract closing data from series, store in v
 		std::vector<double> out(v.size(), qnan());																// call vector constructor, reserve v.size() elements, fill with quiet_NaN
@@ -45,8 +48,16 @@ namespace sugar {
 	}
 
 	std::vector<double> ema_over_series(const std::vector<double>& v, std::size_t n) {							// 
-		std::vector<double> out(v.size(), qnan());																// 
-		if (n == 0 || v.size() < n) return out;																	// 
+		std::vector<double> out(v.size());																		// 
+		ema_into(v, n, out);																					// 
+		return out;																								// 
+	}
+
+
+	void ema_into(std::span<const double> v, std::size_t n, std::span<double> out) {							// 
+		SUGAR_PROF_SCOPE("indicator/ema");
+		std::fill(out.begin(), out.end(), qnan());																// 
+		if (n == 0 || v.size() < n) return;																		// 
 
 		const double alpha = 2.0 / (static_cast<double>(n) + 1.0);												// 
 
@@ -58,7 +69,6 @@ namespace sugar {
 		for (std::size_t i = n; i < v.size(); ++i) {															// 
 			out[i] = alpha * v[i] + (1.0 - alpha) * out[i - 1];													// 
 		}
-		return out;																								// 
 	}
 
 } // namespace sugar
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "indicator.h"
+#include <span>
 
 
 namespace sugar {																			// adding more to namespace sugar
@@ -21,5 +22,6 @@ namespace sugar {																			// adding more to namespace sugar
 
 	std::vector<double> ema_over_series(const std::vector<double>& v, std::size_t n);		// Compute an Exponential Moving Average over an arbitrary vector (aligned to v.size()).
 																								// Warm-up: first (n-1) entries are NaN; index (n-1) is SMA seed; EMA continues from there,
+	void ema_into(std::span<const double> v, std::size_t n, std::span<double> out);		// same kernel into caller storage (out.size() == v.size())
 
 } // namespace sugar
\ No newline at end of file
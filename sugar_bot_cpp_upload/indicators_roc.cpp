@@ -1,4 +1,6 @@
 ﻿#include "indicators_roc.h"
+#include "profile.h"
+#include <algorithm>
 #include <limits>
 #include <cmath>
 
@@ -12,8 +14,16 @@ namespace sugar {
 																										
 
 	std::vector<double> roc_over_series(const std::vector<double>& v, std::size_t k) {				// Rate-of-change over k steps:
-		std::vector<double> out(v.size(), qnan());													// count–value ctor: prefill with NaN (warm-up)
-		if (k == 0 || v.size() <= k) return out;													// Guards: undefined lookback or no usable indices yet → return NaN-filled vector
+		std::vector<double> out(v.size());															// sized to the input; roc_into writes every slot
+		roc_into(v, k, out);																		//
+		return out;																					//
+	}
+
+
+	void roc_into(std::span<const double> v, std::size_t k, std::span<double> out) {				// same kernel over caller storage
+		SUGAR_PROF_SCOPE("indicator/roc");
+		std::fill(out.begin(), out.end(), qnan());													// prefill with NaN (warm-up)
+		if (k == 0 || v.size() <= k) return;														// Guards: undefined lookback or no usable indices yet → leave NaN-filled
 		for (std::size_t i = k; i < v.size(); ++i) {												// Loop over closes vector v (not CandleSeries directly)
 			const double prev = v[i - k];															// compare to value k steps back
 			if (prev == 0.0) {																		// Division-by-zero guard at i-k → NaN (undefined return).
@@ -26,7 +36,6 @@ namespace sugar {
 			}
 			out[i] = (v[i] / prev - 1.0) * 100.0;													// out[i] = ((v[i] / v[i - k]) - 1) * 100 for i >= k; NaN for i < k
 		}
-		return out;																					// return result vector 
 	}
 
 
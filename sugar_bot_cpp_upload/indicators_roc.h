@@ -1,5 +1,6 @@
 #pragma once
 #include "indicator.h"
+#include <span>
 
 
 namespace sugar {
@@ -18,6 +19,7 @@ namespace sugar {
 
 																									// Utility: ROC over an arbitrary vector<double> (exposed for composites)
 	std::vector<double> roc_over_series(const std::vector<double>& v, std::size_t k);				// function declaration for polymorphic behavior so ROC can be applied to EMA or SMA indicators
+	void roc_into(std::span<const double> v, std::size_t k, std::span<double> out);				// same kernel into caller storage (out.size() == v.size()), e.g. arena scratch
 
 
 } // namespace sugar
\ No newline at end of file
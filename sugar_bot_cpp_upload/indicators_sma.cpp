@@ -1,6 +1,9 @@
 #include "indicators_sma.h"
+#include "profile.h"
+#include <algorithm>
 #include <limits>
 #include <numeric>
+#include <stdexcept>
 
 
 namespace sugar {
@@ -17,6 +20,7 @@ namespace sugar {
 																										// takes an immutable const ref CandleSeries parameter, 
 																										// returns vector of doubles, Override of Indicator::compute; const must match the header declaration.
 																										// Note: override keyword appears only in the class (header), not here.
+		SUGAR_PROF_SCOPE("indicator/sma");
 
 		const auto v = series.closes();																// Copy closes by value (safe, cheap with RVO); keep local view read-only
 		std::vector<double> out(v.size(), qnan());													// vector countvalue constructor: (make a vector of v.size() elements, each initialized to the value qnan()),
@@ -36,8 +40,16 @@ namespace sugar {
 
 
 	std::vector<double> sma_over_series(const std::vector<double>& v, std::size_t n) {				// 
-		std::vector<double> out(v.size(), qnan());													// 
-		if (n == 0 || v.size() < n) return out;														// 
+		std::vector<double> out(v.size());															// 
+		sma_into(v, n, out);																		// 
+		return out;																					// 
+	}
+
+
+	void sma_into(std::span<const double> v, std::size_t n, std::span<double> out) {				// 
+		SUGAR_PROF_SCOPE("indicator/sma");
+		std::fill(out.begin(), out.end(), qnan());													// 
+		if (n == 0 || v.size() < n) return;															// 
 
 		double window_sum = std::accumulate(v.begin(), v.begin() + n, 0.0);							// 
 		out[n - 1] = window_sum / static_cast<double>(n);											// 
@@ -46,7 +58,20 @@ namespace sugar {
 			window_sum += v[i] - v[i - n];															// 
 			out[i] = window_sum / static_cast<double>(n);											// 
 		}
-		return out;																					// 
+	}
+
+
+	SmaBank::SmaBank(const CandleSeries& series, const std::vector<std::size_t>& periods)			//
+		: series_(series), closes_(series.closes()) {												//
+		for (auto n : periods)																		//
+			if (sma_.find(n) == sma_.end()) sma_.emplace(n, sma_over_series(closes_, n));			// same arithmetic as SMAIndicator::compute
+	}
+
+
+	const std::vector<double>& SmaBank::sma(std::size_t n) const {									//
+		auto it = sma_.find(n);																		//
+		if (it == sma_.end()) throw std::out_of_range("SmaBank: period not computed");				//
+		return it->second;																			//
 	}
 
 
@@ -1,5 +1,7 @@
 #pragma once
 #include "indicator.h"
+#include <map>
+#include <span>
 
 
 namespace sugar {
@@ -21,5 +23,24 @@ namespace sugar {
 
 	std::vector<double> sma_over_series(const std::vector<double>& v, std::size_t n);		// Compute a Simple Moving Average over an arbitrary vector (aligned to v.size()).
 																							// First (n-1) slots are NaN; seed appears at index n-1.
+	void sma_into(std::span<const double> v, std::size_t n, std::span<double> out);		// Same, written into caller storage (out.size() == v.size()), e.g. arena scratch.
+
+
+																							// Close SMAs of one series for a set of periods, computed once and shared
+																							// read-only by every run (and thread) that needs them. Values are identical
+																							// to SMAIndicator{n}.compute(series).
+	class SmaBank {																			//
+	public:																					//
+		SmaBank(const CandleSeries& series, const std::vector<std::size_t>& periods);		// duplicate periods are computed once
+
+		const CandleSeries& series() const { return series_; }								//
+		const std::vector<double>& closes() const { return closes_; }						//
+		const std::vector<double>& sma(std::size_t n) const;								// throws std::out_of_range for a period not in the bank
+
+	private:																				//
+		CandleSeries series_;																// shares the candle storage, copies nothing
+		std::vector<double> closes_;														//
+		std::map<std::size_t, std::vector<double>> sma_;									// period -> SMA series
+	};
 
 } // namespace sugar
\ No newline at end of file
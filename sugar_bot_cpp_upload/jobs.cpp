@@ -0,0 +1,461 @@
+#include "jobs.h"
+#include "candle_file.h"
+#include "indicator_bank.h"
+#include "indicators_sma.h"
+#include "parallel.h"
+#include "resample.h"
+#include "strategy_roc_sma.h"
+#include "swing_breakout_strategy.h"
+#include "sweep.h"
+#include "sweep_diff_cross.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace sugar {
+
+    JobStrategy parse_job_strategy(const std::string& name) {
+        if (name == "roc_sma") return JobStrategy::RocSma;
+        if (name == "diff_cross") return JobStrategy::DiffCross;
+        if (name == "swing_breakout") return JobStrategy::SwingBreakout;
+        throw std::invalid_argument("Unknown strategy '" + name + "' (roc_sma, diff_cross, swing_breakout)");
+    }
+
+    const char* job_strategy_name(JobStrategy s) {
+        switch (s) {
+        case JobStrategy::RocSma: return "roc_sma";
+        case JobStrategy::DiffCross: return "diff_cross";
+        case JobStrategy::SwingBreakout: return "swing_breakout";
+        }
+        return "?";
+    }
+
+    std::size_t JobSpec::combos() const {
+        switch (strategy) {
+        case JobStrategy::RocSma: {
+            std::size_t pairs = 0;
+            for (auto s : slows) for (auto f : fasts) if (f < s) ++pairs;
+            return pairs * rocs.size() * threshes.size();
+        }
+        case JobStrategy::DiffCross: return a.size() * b.size() * threshes.size();
+        case JobStrategy::SwingBreakout: return lefts.size() * rights.size() * gains.size() * losses.size();
+        }
+        return 0;
+    }
+
+    namespace {
+
+        std::string trim(const std::string& s) {
+            const auto b = s.find_first_not_of(" \t\r");
+            if (b == std::string::npos) return {};
+            return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+        }
+
+        std::vector<std::string> split(const std::string& s, char sep) {
+            std::vector<std::string> out;
+            std::stringstream ss(s);
+            std::string item;
+            while (std::getline(ss, item, sep)) out.push_back(trim(item));
+            return out;
+        }
+
+        // "N", "A..B", "A..B:STEP" or a comma list of those; inclusive, like make_range / make_drange.
+        template <class T>
+        std::vector<T> parse_range(const std::string& text, T default_step) {
+            auto num = [&](const std::string& s) -> T {
+                std::size_t used = 0;
+                T v{};
+                if constexpr (std::is_floating_point_v<T>) v = std::stod(s, &used);
+                else {
+                    if (!s.empty() && s[0] == '-') throw std::invalid_argument("negative value: " + s);
+                    v = static_cast<T>(std::stoull(s, &used));
+                }
+                if (used != s.size()) throw std::invalid_argument("not a number: " + s);
+                return v;
+            };
+            std::vector<T> out;
+            for (const auto& item : split(text, ',')) {
+                const auto dots = item.find("..");
+                if (dots == std::string::npos) { out.push_back(num(item)); continue; }
+                const auto colon = item.find(':', dots);
+                const T lo = num(trim(item.substr(0, dots)));
+                const T hi = num(trim(item.substr(dots + 2, colon == std::string::npos ? std::string::npos : colon - dots - 2)));
+                const T step = colon == std::string::npos ? default_step : num(trim(item.substr(colon + 1)));
+                if (!(step > T{}) || lo > hi) throw std::invalid_argument("bad range: " + item);
+                if constexpr (std::is_floating_point_v<T>) {
+                    for (std::size_t k = 0; lo + T(k) * step <= hi + 1e-12; ++k) out.push_back(lo + T(k) * step);
+                }
+                else for (T x = lo; x <= hi; x += step) out.push_back(x);
+            }
+            if (out.empty()) throw std::invalid_argument("empty list");
+            return out;
+        }
+
+        struct IndicatorSpec { IndicatorKey key; std::int64_t timeframe; };  // timeframe 0 = the job's bars
+
+        IndicatorSpec parse_indicator(const std::string& spec) {
+            const auto at = spec.find('@');
+            return { parse_indicator_key(spec.substr(0, at)), at == std::string::npos ? 0 : parse_timeframe(spec.substr(at + 1)) };
+        }
+
+        // "sma:10..30:10 roc_ema:50/5,10@1d" -> { "sma:10", "sma:20", "sma:30", "roc_ema:50/5@1d", "roc_ema:50/10@1d" }
+        std::vector<std::string> parse_indicators(const std::string& text) {
+            std::vector<std::string> out;
+            std::istringstream in(text);
+            std::string item;
+            while (in >> item) {
+                const auto colon = item.find(':'), at = item.find('@');
+                if (colon == std::string::npos) throw std::invalid_argument("indicator wants KIND:RANGE, got " + item);
+                const auto slash = item.substr(0, at).find('/', colon);
+                const std::string kind = item.substr(0, colon);
+                const std::string tf = at == std::string::npos ? "" : item.substr(at);
+                const auto periods = parse_range<std::size_t>(item.substr(colon + 1, std::min(slash, at) - colon - 1), 1);
+                const auto rocs = slash == std::string::npos ? std::vector<std::size_t>{ 0 }
+                    : parse_range<std::size_t>(item.substr(slash + 1, at == std::string::npos ? std::string::npos : at - slash - 1), 1);
+                for (auto n : periods)
+                    for (auto r : rocs) {
+                        out.push_back(kind + ":" + std::to_string(n) + (slash == std::string::npos ? "" : "/" + std::to_string(r)) + tf);
+                        parse_indicator(out.back());                    // validates kind and lengths
+                    }
+            }
+            if (out.empty()) throw std::invalid_argument("empty indicator list");
+            return out;
+        }
+
+        bool parse_bool(const std::string& v) {
+            if (v == "true" || v == "1" || v == "yes") return true;
+            if (v == "false" || v == "0" || v == "no") return false;
+            throw std::invalid_argument("not a boolean: " + v);
+        }
+
+        void apply_key(JobSpec& job, const std::string& key, const std::string& value, const std::filesystem::path& base) {
+            auto path = [&](const std::string& v) {                     // relative to the job file
+                const std::filesystem::path p(v);
+                return (p.is_absolute() ? p : base / p).lexically_normal().string();
+            };
+            if (key == "data") job.data = path(value);
+            else if (key == "timeframe") job.timeframe = parse_timeframe(value);
+            else if (key == "strategy") job.strategy = parse_job_strategy(value);
+            else if (key == "top_k") job.top_k = std::max<std::size_t>(1, std::stoull(value));
+            else if (key == "report") job.report = path(value);
+            else if (key == "fast") job.fasts = parse_range<std::size_t>(value, 1);
+            else if (key == "slow") job.slows = parse_range<std::size_t>(value, 1);
+            else if (key == "roc") job.rocs = parse_range<std::size_t>(value, 1);
+            else if (key == "thresh") job.threshes = parse_range<double>(value, 0.01);
+            else if (key == "a") job.a = parse_indicators(value);
+            else if (key == "b") job.b = parse_indicators(value);
+            else if (key == "left") job.lefts = parse_range<std::size_t>(value, 1);
+            else if (key == "right") job.rights = parse_range<std::size_t>(value, 1);
+            else if (key == "gain") job.gains = parse_range<double>(value, 0.1);
+            else if (key == "loss") job.losses = parse_range<double>(value, 0.1);
+            else if (key == "ema_stop") job.ema_stop = parse_bool(value);
+            else if (key == "days_above") job.days_above = std::stoi(value);
+            else if (key == "days_for_gain") job.days_for_gain = std::stoi(value);
+            else throw std::invalid_argument("unknown key '" + key + "'");
+        }
+
+        void validate(const JobSpec& job) {
+            auto need = [&](bool ok, const char* key) {
+                if (!ok) throw std::invalid_argument(std::string(job_strategy_name(job.strategy)) + " job needs '" + key + "'");
+            };
+            need(!job.data.empty(), "data");
+            if (job.strategy == JobStrategy::RocSma) {
+                need(!job.fasts.empty(), "fast"); need(!job.slows.empty(), "slow");
+                need(!job.rocs.empty(), "roc"); need(!job.threshes.empty(), "thresh");
+                if (job.combos() == 0) throw std::invalid_argument("no fast < slow pair in the grid");
+            }
+            else if (job.strategy == JobStrategy::DiffCross) {
+                need(!job.a.empty(), "a"); need(!job.b.empty(), "b"); need(!job.threshes.empty(), "thresh");
+                for (const auto* list : { &job.a, &job.b })
+                    for (const auto& spec : *list) {
+                        const auto tf = parse_indicator(spec).timeframe;
+                        if (tf != 0 && tf <= job.timeframe)
+                            throw std::invalid_argument("indicator " + spec + " must use a coarser timeframe than the job's bars");
+                    }
+            }
+        }
+
+        // Everything the jobs on one dataset and timeframe read, built once before the first of them runs.
+        struct SharedInputs {
+            CandleSeries series;
+            std::unique_ptr<SmaBank> bank;                              // closes + every SMA period a roc_sma job reads
+            std::unique_ptr<IndicatorBank> indicators;                  // every diff_cross series on the series' own bars
+            std::map<std::string, std::vector<double>> other;           // "KIND:N@TF" (aligned to series)
+
+            std::span<const double> values(const std::string& spec) const {
+                const auto ind = parse_indicator(spec);
+                if (ind.timeframe == 0) return indicators->series(ind.key);
+                return other.at(spec);
+            }
+        };
+
+        std::vector<double> compute_indicator(const IndicatorSpec& ind, const CandleSeries& series) {
+            const IndicatorBank one(series, { ind.key }, 1);
+            const auto v = one.series(0);
+            return { v.begin(), v.end() };
+        }
+
+        void plan_indicators(const JobSpec& job, std::set<std::size_t>& smas, std::set<IndicatorKey>& keys,
+            std::set<std::string>& other, JobStats& st) {
+            if (job.strategy == JobStrategy::RocSma) {
+                smas.insert(job.fasts.begin(), job.fasts.end());
+                smas.insert(job.slows.begin(), job.slows.end());
+                st.indicator_uses += 2 * job.combos();
+            }
+            else if (job.strategy == JobStrategy::DiffCross) {
+                for (const auto* list : { &job.a, &job.b })
+                    for (const auto& spec : *list) {
+                        const auto ind = parse_indicator(spec);
+                        if (ind.timeframe == 0) keys.insert(ind.key); else other.insert(spec);
+                    }
+                st.indicator_uses += 2 * job.combos();
+            }
+        }
+
+        struct Candidate { double score; std::size_t index; BacktestResult r; };
+
+        // Evaluates combos [0, count) in blocks on the thread pool and keeps the
+        // K best; eval returns false for grid points that are not combos (fast >= slow).
+        // diff_cross jobs go through sweep_diff_cross, which does the same.
+        std::vector<Candidate> best_of(std::size_t count, std::size_t k, std::size_t threads,
+            const std::function<bool(std::size_t, BacktestResult&)>& eval) {
+            constexpr std::size_t kBlock = 4096;
+            std::vector<Candidate> best;
+            std::vector<BacktestResult> res(std::min(kBlock, count));
+            std::vector<char> valid(res.size());
+            auto better = [](const Candidate& x, const Candidate& y) {
+                return x.score != y.score ? x.score > y.score : x.index < y.index;
+            };
+            for (std::size_t start = 0; start < count; start += kBlock) {
+                const std::size_t m = std::min(kBlock, count - start);
+                parallel_for(m, threads, [&](std::size_t j) { valid[j] = eval(start + j, res[j]) ? 1 : 0; });
+                for (std::size_t j = 0; j < m; ++j)
+                    if (valid[j]) best.push_back({ sweep_score(res[j]), start + j, res[j] });
+                const std::size_t keep = std::min(k, best.size());
+                std::partial_sort(best.begin(), best.begin() + static_cast<std::ptrdiff_t>(keep), best.end(), better);
+                best.resize(keep);
+            }
+            return best;
+        }
+
+        std::string fmt(double v) {
+            std::ostringstream os;
+            os << v;
+            return os.str();
+        }
+
+        JobResult run_job(const JobSpec& job, const SharedInputs& in, std::size_t threads) {
+            JobResult out;
+            out.name = job.name; out.data = job.data; out.timeframe = job.timeframe; out.strategy = job.strategy;
+            out.combos = job.combos();
+            const auto t0 = std::chrono::steady_clock::now();
+            const CandleSeries& data = in.series;
+            const std::size_t n = data.size();
+
+            auto keep = [&](const std::vector<Candidate>& best, const auto& describe) {
+                for (const auto& c : best) out.top.push_back({ c.score, c.r, describe(c.index) });
+            };
+            if (job.strategy == JobStrategy::RocSma) {
+                const std::size_t S = job.slows.size(), R = job.rocs.size(), T = job.threshes.size();
+                auto params = [&](std::size_t i) {                      // sweep order: fast, slow, roc, thresh
+                    return RocSmaParams{ job.fasts[i / (S * R * T)], job.slows[i / (R * T) % S], job.rocs[i / T % R], job.threshes[i % T] };
+                };
+                const auto best = best_of(job.fasts.size() * S * R * T, job.top_k, threads, [&](std::size_t i, BacktestResult& r) {
+                    const auto [f, s, rl, th] = params(i);
+                    if (f >= s) return false;
+                    r = RocSmaCrossoverStrategy{ f, s, rl, th }.run_window(*in.bank, 0, n);
+                    return true;
+                });
+                keep(best, [&](std::size_t i) {
+                    const auto [f, s, rl, th] = params(i);
+                    return "fast=" + std::to_string(f) + " slow=" + std::to_string(s) + " roc=" + std::to_string(rl) + " thresh=" + fmt(th);
+                });
+            }
+            else if (job.strategy == JobStrategy::DiffCross) {
+                std::vector<std::span<const double>> av, bv;            // resolved once, not per combo
+                for (const auto& spec : job.a) av.push_back(in.values(spec));
+                for (const auto& spec : job.b) bv.push_back(in.values(spec));
+                for (const auto& row : sweep_diff_cross(data, av, bv, in.indicators->closes(), job.threshes, job.top_k, threads))
+                    out.top.push_back({ row.score, row.r, "a=" + job.a[row.a] + " b=" + job.b[row.b] + " thresh=" + fmt(row.thresh) });
+            }
+            else {
+                const std::size_t Rt = job.rights.size(), G = job.gains.size(), L = job.losses.size();
+                auto params = [&](std::size_t i) {
+                    return std::make_tuple(job.lefts[i / (Rt * G * L)], job.rights[i / (G * L) % Rt], job.gains[i / L % G], job.losses[i % L]);
+                };
+                const auto best = best_of(out.combos, job.top_k, threads, [&](std::size_t i, BacktestResult& r) {
+                    const auto [left, right, gain, loss] = params(i);
+                    SwingBreakoutStrategy strat(left, right, job.ema_stop, job.days_above, gain, job.days_for_gain, loss);
+                    r = strat.run(data);
+                    return true;
+                });
+                keep(best, [&](std::size_t i) {
+                    const auto [left, right, gain, loss] = params(i);
+                    return "left=" + std::to_string(left) + " right=" + std::to_string(right) + " gain=" + fmt(gain) + " loss=" + fmt(loss);
+                });
+            }
+            out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            return out;
+        }
+
+    } // namespace
+
+    JobFile parse_job_file(const std::string& path) {
+        std::ifstream ifs(path);
+        if (!ifs) throw std::runtime_error("Failed to open job file: " + path);
+        const auto base = std::filesystem::absolute(path).parent_path();
+        JobFile file;
+        JobSpec defaults;
+        std::set<std::string> names;
+        std::string raw;
+        std::size_t line_no = 0;
+        try {
+            while (std::getline(ifs, raw)) {
+                ++line_no;
+                const std::string line = trim(raw.substr(0, raw.find('#')));
+                if (line.empty()) continue;
+                if (line.front() == '[') {
+                    if (line.back() != ']') throw std::invalid_argument("unterminated [job] header");
+                    JobSpec job = defaults;
+                    job.name = trim(line.substr(1, line.size() - 2));
+                    job.line = line_no;
+                    if (job.name.empty()) throw std::invalid_argument("empty job name");
+                    if (!names.insert(job.name).second) throw std::invalid_argument("duplicate job '" + job.name + "'");
+                    file.jobs.push_back(std::move(job));
+                    continue;
+                }
+                const auto eq = line.find('=');
+                if (eq == std::string::npos) throw std::invalid_argument("expected key = value");
+                const std::string key = trim(line.substr(0, eq)), value = trim(line.substr(eq + 1));
+                if (key == "threads") {
+                    if (!file.jobs.empty()) throw std::invalid_argument("'threads' belongs before the first job");
+                    file.threads = std::stoull(value);
+                }
+                else apply_key(file.jobs.empty() ? defaults : file.jobs.back(), key, value, base);
+            }
+            for (const auto& job : file.jobs) {
+                line_no = job.line;
+                validate(job);
+            }
+        }
+        catch (const std::exception& ex) {
+            throw std::runtime_error(path + ":" + std::to_string(line_no) + ": " + ex.what());
+        }
+        if (file.jobs.empty()) throw std::runtime_error(path + ": no [job] sections");
+        return file;
+    }
+
+    std::vector<JobResult> run_jobs(const JobFile& file, JobStats* stats, bool quiet) {
+        JobStats st;
+        std::vector<JobResult> results(file.jobs.size());
+
+        std::vector<std::string> datasets;                              // first-use order
+        std::map<std::string, std::vector<std::size_t>> by_data;
+        for (std::size_t i = 0; i < file.jobs.size(); ++i) {
+            auto& list = by_data[file.jobs[i].data];
+            if (list.empty()) datasets.push_back(file.jobs[i].data);
+            list.push_back(i);
+        }
+
+        std::size_t done = 0;
+        for (const auto& path : datasets) {
+            const auto& jobs = by_data[path];
+
+            auto t0 = std::chrono::steady_clock::now();
+            const CandleSeries loaded{ load_candles(path) };
+            ++st.datasets_loaded;
+            st.load_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            // Every timeframe any job on this dataset trades or reads an indicator on, resampled at once.
+            std::vector<std::int64_t> timeframes;                       // first-use order of the jobs' own timeframes
+            std::map<std::int64_t, std::vector<std::size_t>> by_tf;
+            std::set<std::int64_t> needed;
+            for (auto i : jobs) {
+                const auto& job = file.jobs[i];
+                auto& list = by_tf[job.timeframe];
+                if (list.empty()) timeframes.push_back(job.timeframe);
+                list.push_back(i);
+                if (job.timeframe) needed.insert(job.timeframe);
+                for (const auto* specs : { &job.a, &job.b })
+                    for (const auto& spec : *specs)
+                        if (const auto tf = parse_indicator(spec).timeframe) needed.insert(tf);
+            }
+            std::map<std::int64_t, Resampled> frames;
+            if (!needed.empty()) {
+                t0 = std::chrono::steady_clock::now();
+                const std::vector<std::int64_t> want(needed.begin(), needed.end());
+                auto built = resample(loaded, want);
+                for (std::size_t k = 0; k < want.size(); ++k) frames.emplace(want[k], std::move(built[k]));
+                st.timeframes_built += want.size();
+                st.resample_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            }
+            const std::int64_t loaded_bar = bar_seconds(loaded.rows());
+
+            for (const auto tf : timeframes) {
+                const auto& tf_jobs = by_tf[tf];
+                SharedInputs in;
+                in.series = tf ? frames.at(tf).series : loaded;
+                const std::int64_t bar = tf ? tf : loaded_bar;
+
+                t0 = std::chrono::steady_clock::now();
+                std::set<std::size_t> smas;
+                std::set<IndicatorKey> bank_keys;
+                std::set<std::string> other;
+                for (auto i : tf_jobs) plan_indicators(file.jobs[i], smas, bank_keys, other, st);
+                in.bank = std::make_unique<SmaBank>(in.series, std::vector<std::size_t>(smas.begin(), smas.end()));
+                in.indicators = std::make_unique<IndicatorBank>(in.series,
+                    std::vector<IndicatorKey>(bank_keys.begin(), bank_keys.end()), file.threads);
+                const std::vector<std::string> keys(other.begin(), other.end());
+                std::vector<std::vector<double>> values(keys.size());
+                parallel_for(keys.size(), file.threads, [&](std::size_t k) {
+                    const auto ind = parse_indicator(keys[k]);
+                    if (ind.timeframe == 0) { values[k] = compute_indicator(ind, in.series); return; }
+                    const auto& coarse = frames.at(ind.timeframe).series;   // no look-ahead: a value shows once its bar closed
+                    values[k] = align_values(compute_indicator(ind, coarse), closed_map(in.series.rows(), bar, coarse.rows(), ind.timeframe));
+                });
+                for (std::size_t k = 0; k < keys.size(); ++k) in.other.emplace(keys[k], std::move(values[k]));
+                const std::size_t built = smas.size() + in.indicators->computed() + keys.size();
+                st.indicators_computed += built;
+                st.indicator_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                if (!quiet)
+                    std::cerr << "[jobs] " << path << (tf ? " @" + timeframe_name(tf) : std::string()) << ": " << in.series.size()
+                        << " bars, " << built << " indicator series shared by " << tf_jobs.size() << " job(s)\n";
+
+                for (auto i : tf_jobs) {
+                    const auto& job = file.jobs[i];
+                    results[i] = run_job(job, in, file.threads);
+                    if (!job.report.empty()) write_job_report(job.report, results[i]);
+                    if (!quiet)
+                        std::cerr << "[jobs] " << ++done << " / " << file.jobs.size() << " " << job.name << ": "
+                            << results[i].combos << " combos in " << results[i].seconds << "s\n";
+                }
+            }
+        }                                                               // dataset, its timeframes and indicators released here
+
+        if (stats) *stats = st;
+        return results;
+    }
+
+    void write_job_report(const std::string& path, const JobResult& result) {
+        const auto dir = std::filesystem::path(path).parent_path();
+        if (!dir.empty()) std::filesystem::create_directories(dir);
+        std::ofstream ofs(path);
+        if (!ofs) throw std::runtime_error("Failed to write report: " + path);
+        ofs << "rank,score,params,pnl,trades,max_drawdown,start_date\n";
+        for (std::size_t i = 0; i < result.top.size(); ++i) {
+            const auto& row = result.top[i];
+            ofs << i + 1 << ',' << row.score << ',' << row.params << ',' << row.r.pnl << ',' << row.r.trades << ','
+                << row.r.max_drawdown << ',' << row.r.best_start_date << '\n';
+        }
+    }
+
+} // namespace sugar
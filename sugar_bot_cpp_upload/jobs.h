@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "metrics.h"
+
+namespace sugar {
+
+    // Declarative batch runs: many sweeps over many datasets in one process.
+    //
+    // A job file is line based. `#` starts a comment; `[name]` starts a job;
+    // `key = value` lines before the first job are defaults for every job.
+    //
+    //   data = data/BTCUSD.csv          # default dataset
+    //   threads = 8
+    //
+    //   [roc_core]
+    //   strategy = roc_sma              # roc_sma | diff_cross | swing_breakout
+    //   fast = 45..55                   # N, A..B, A..B:STEP or a,b,c
+    //   slow = 55..65
+    //   roc = 95..105
+    //   thresh = 0.10..0.20:0.01
+    //
+    //   [sma_vs_ema]
+    //   strategy = diff_cross
+    //   a = sma:10..30:10               # space-separated KIND:RANGE, KIND = sma | ema | roc
+    //   b = ema:50 ema:100
+    //
+    //   [roc_families]
+    //   strategy = diff_cross
+    //   a = roc_sma:10..30:10/5         # ROC of SMA / EMA: KIND:PERIODS/ROC_LENGTHS
+    //   b = roc_sma:50,100/5,10 roc_ema:50,100/5,10
+    //   thresh = 0..0.3:0.1
+    //   thresh = 0..2:0.5
+    //   report = out/sma_vs_ema.csv     # top-K as CSV
+    //
+    //   [swing]
+    //   strategy = swing_breakout
+    //   left = 1..4                     # also: right, gain, loss; ema_stop, days_above, days_for_gain
+    //
+    //   [hourly_vs_daily]
+    //   strategy = diff_cross
+    //   timeframe = 1h                  # resample the dataset first (30s, 15m, 4h, 1d, 1w ...)
+    //   a = sma:10..30:10
+    //   b = sma:20@1d                   # @TF: computed on TF bars, read only once a TF bar has closed
+    //   thresh = 0..1:0.5
+    //
+    // Jobs sharing a dataset run back to back on one loaded copy, and every
+    // indicator series they need (each SMA period, EMA, ROC, ROC of SMA/EMA)
+    // is computed once for all of them before the first job starts; the
+    // diff_cross series sit in one IndicatorBank. Every timeframe the jobs
+    // on a dataset use is resampled in one call. The dataset is dropped
+    // after its last job. Results come back in file order.
+
+    enum class JobStrategy { RocSma, DiffCross, SwingBreakout };
+
+    JobStrategy parse_job_strategy(const std::string& name);
+    const char* job_strategy_name(JobStrategy s);
+
+    struct JobSpec {
+        std::string name;
+        std::string data;                                               // CSV or .scb
+        std::int64_t timeframe = 0;                                     // bar length to resample to (s); 0 = bars as loaded
+        JobStrategy strategy = JobStrategy::RocSma;
+        std::size_t top_k = 5;
+        std::string report;                                             // optional CSV of the top-K rows
+        std::vector<std::size_t> fasts, slows, rocs;                    // roc_sma
+        std::vector<double> threshes;                                   // roc_sma, diff_cross
+        std::vector<std::string> a, b;                                  // diff_cross indicator specs, "sma:20", "roc_ema:50/10@1d"
+        std::vector<std::size_t> lefts{ 2 }, rights{ 2 };               // swing_breakout
+        std::vector<double> gains{ 4.0 }, losses{ 8.0 };
+        bool ema_stop = true;
+        int days_above = 2, days_for_gain = 3;
+        std::size_t line = 0;                                           // of the [name] header, for messages
+
+        std::size_t combos() const;
+    };
+
+    struct JobFile {
+        std::vector<JobSpec> jobs;
+        std::size_t threads = 0;                                        // 0 = all hardware threads
+    };
+
+    // Throws std::runtime_error naming the file and line on any error.
+    JobFile parse_job_file(const std::string& path);
+
+    struct JobRow {
+        double score{};                                                 // sweep_score
+        BacktestResult r;
+        std::string params;                                             // "fast=49 slow=57 roc=97 thresh=0.12"
+    };
+
+    struct JobResult {
+        std::string name;
+        std::string data;
+        std::int64_t timeframe{};
+        JobStrategy strategy{};
+        std::size_t combos{};
+        double seconds{};
+        std::vector<JobRow> top;                                        // best first; ties keep grid order
+    };
+
+    struct JobStats {
+        std::size_t datasets_loaded{};
+        std::size_t timeframes_built{};                                 // resampled series
+        double resample_seconds{};
+        std::size_t indicators_computed{};                              // distinct series built
+        std::size_t indicator_uses{};                                   // series the runs read: what per-run computing would have built
+        double load_seconds{}, indicator_seconds{};
+    };
+
+    std::vector<JobResult> run_jobs(const JobFile& file, JobStats* stats = nullptr, bool quiet = false);
+
+    void write_job_report(const std::string& path, const JobResult& result);
+
+} // namespace sugar
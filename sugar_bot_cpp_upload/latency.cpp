@@ -0,0 +1,64 @@
+#include "latency.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+
+namespace sugar {
+
+    std::size_t LatencyHistogram::bucket_of(std::uint64_t ns) {
+        if (ns < kSub) return static_cast<std::size_t>(ns);
+        const int e = std::bit_width(ns) - 1;                           // ns in [2^e, 2^(e+1)), e >= kSubBits
+        const std::uint64_t sub = (ns >> (e - kSubBits)) - kSub;        // top kSubBits bits below the leading one
+        return static_cast<std::size_t>((e - kSubBits + 1) * kSub + sub);
+    }
+
+    std::uint64_t LatencyHistogram::upper_of(std::size_t bucket) {
+        if (bucket < kSub) return bucket;
+        const int e = static_cast<int>(bucket / kSub) + kSubBits - 1;
+        const std::uint64_t sub = bucket % kSub;
+        return ((kSub + sub + 1) << (e - kSubBits)) - 1;
+    }
+
+    void LatencyHistogram::record(std::uint64_t ns) {
+        ++counts_[bucket_of(ns)];
+        ++count_;
+        min_ = std::min(min_, ns);
+        max_ = std::max(max_, ns);
+        sum_ += double(ns);
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+        count_ += other.count_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+        sum_ += other.sum_;
+    }
+
+    std::uint64_t LatencyHistogram::percentile(double p) const {
+        if (count_ == 0) return 0;
+        const double want = std::clamp(p, 0.0, 1.0) * double(count_);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen > 0 && double(seen) >= want) return std::min(upper_of(i), max_);
+        }
+        return max_;
+    }
+
+    std::string LatencyHistogram::summary() const {
+        return "n=" + std::to_string(count_) + " p50=" + format_ns(double(percentile(0.50)))
+            + " p99=" + format_ns(double(percentile(0.99))) + " p99.9=" + format_ns(double(percentile(0.999)))
+            + " max=" + format_ns(double(max_)) + " mean=" + format_ns(mean());
+    }
+
+    std::string format_ns(double ns) {
+        char buf[32];
+        if (ns < 1e3) std::snprintf(buf, sizeof(buf), "%.0fns", ns);
+        else if (ns < 1e6) std::snprintf(buf, sizeof(buf), "%.1fus", ns / 1e3);
+        else if (ns < 1e9) std::snprintf(buf, sizeof(buf), "%.2fms", ns / 1e6);
+        else std::snprintf(buf, sizeof(buf), "%.2fs", ns / 1e9);
+        return buf;
+    }
+
+} // namespace sugar
@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace sugar {
+
+    // Fixed-size log-linear histogram of nanosecond latencies: exact below
+    // 32 ns, then 32 linear sub-buckets per power of two (about 3% relative
+    // error). Recording is O(1) and never allocates, so it can sit on a hot path.
+    class LatencyHistogram {
+    public:
+        void record(std::uint64_t ns);
+        void merge(const LatencyHistogram& other);
+
+        std::uint64_t count() const { return count_; }
+        std::uint64_t min() const { return count_ ? min_ : 0; }
+        std::uint64_t max() const { return max_; }
+        double mean() const { return count_ ? sum_ / double(count_) : 0.0; }
+        std::uint64_t percentile(double p) const;                       // p in [0, 1]; bucket upper bound, capped at max()
+
+        std::string summary() const;                                    // "n=.. p50=.. p99=.. max=.." in readable units
+
+    private:
+        static constexpr int kSubBits = 5;
+        static constexpr int kSub = 1 << kSubBits;
+        static std::size_t bucket_of(std::uint64_t ns);
+        static std::uint64_t upper_of(std::size_t bucket);
+
+        std::array<std::uint64_t, (64 - kSubBits + 1) * kSub> counts_{};
+        std::uint64_t count_{}, min_{ ~std::uint64_t(0) }, max_{};
+        double sum_{};
+    };
+
+    // "850ns", "12.3us", "4.56ms", "1.20s"
+    std::string format_ns(double ns);
+
+} // namespace sugar
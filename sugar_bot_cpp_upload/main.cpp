@@ -4,13 +4,34 @@
 #include <tuple>
 #include <cmath>
 #include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <sstream>
+#include <optional>
 
 #include "csv.h"
+#include "candle_file.h"
 #include "utils.h"
 #include "series.h"
 #include "backtester.h"
 #include "strategy_roc_sma.h"
 #include "sweep.h"      
+#include "optimizer.h"
+#include "shard.h"
+#include "walkforward.h"
+#include "montecarlo.h"
+#include "universe.h"
+#include "stream.h"
+#include "profile.h"
+#include "telemetry.h"
+#include "jobs.h"
+#include "time_index.h"
+#include "resample.h"
+#include "strategy_rule.h"
+#include <fstream>
+#include <atomic>
+#include <csignal>
 #include "strategy_diff_cross.h"
 #include "swing_breakout_strategy.h"
 
@@ -34,6 +55,8 @@ static std::vector<double> make_drange(double start, double stop, double step) {
 	return v;
 }
 
+static std::atomic<bool> g_stop{ false };															// set by Ctrl+C in --stream mode
+
 void static run_swing_breakout(const sugar::CandleSeries& candles) {
 	using sugar::SwingBreakoutStrategy;
 	using sugar::Backtester;
@@ -67,9 +90,218 @@ void static run_swing_breakout(const sugar::CandleSeries& candles) {
 
 int main(int argc, char** argv) {
 	try {
-		const std::string path = (argc >= 2) ? argv[1] : "C:/Dev/sugar_Bot/data/BTCUSD_420.csv";
-		auto candles = sugar::load_candles_csv(path);
+		std::string path = "C:/Dev/sugar_Bot/data/BTCUSD_420.csv";
+		sugar::SweepOptions sweep_opts{};
+		std::string search_name;																			// empty = exhaustive sweep
+		std::size_t search_budget = 2000;
+		std::uint64_t search_seed = 42;
+		std::string shard_dir;																				// --coordinator: shared directory for workers
+		sugar::ShardOptions shard_opts{};
+		sugar::WalkForwardOptions wf_opts{};															// train_bars = 0: no walk-forward
+		std::string mc_mode;																				// empty = no Monte Carlo on the sweep winner
+		sugar::MonteCarloOptions mc_opts{};
+		std::size_t threads = 0;																			// 0 = all hardware threads
+		std::string universe_dir;																			// --universe: every *.csv in this directory
+		sugar::UniverseOptions uni_opts{};
+		uni_opts.sweep = true;																				// unless --params picks one combo
+		std::string report_path;
+		std::string stream_source;																	// --stream: live bars instead of a CSV file
+		std::string stream_strategy = "roc";
+		sugar::StreamOptions stream_opts{};
+		bool estimate_only = false;																	// --estimate: print the pre-flight estimate and exit
+		std::string jobs_path;																		// --jobs: run a job file instead of the built-in sweep
+		double max_runtime = 0.0;																	// --max-runtime: refuse sweeps estimated longer (s); 0 = no limit
+		std::int64_t from_ts = INT64_MIN, to_ts = INT64_MAX;										// --from / --to: bars with FROM <= time < TO
+		std::int64_t timeframe = 0;																	// --timeframe: resample before sweeping; 0 = as loaded
+		std::size_t trade_log = 0;																	// --trade-log: list the winner's first N trades
+		std::optional<sugar::RuleProgram> rule;														// --rule: backtest this rule instead of sweeping
+		for (int i = 1; i < argc; ++i) {																	// flags anywhere; first bare argument is the CSV path
+			const std::string_view arg = argv[i];
+			auto value = [&]() -> std::string {
+				if (i + 1 >= argc) throw std::runtime_error("Missing value for " + std::string(arg));
+				return argv[++i];
+			};
+			if (arg == "--prune") sweep_opts.prune = true;
+			else if (arg == "--rank") sweep_opts.rank = sugar::parse_sweep_rank(value());
+			else if (arg == "--trade-log") trade_log = std::stoull(value());
+			else if (arg == "--rule") rule = sugar::RuleProgram::compile(sugar::read_rule_arg(value()));	// syntax errors before any loading
+			else if (arg == "--checkpoint") sweep_opts.checkpoint_path = value();
+			else if (arg == "--checkpoint-every") sweep_opts.checkpoint_every_sec = std::stod(value());
+			else if (arg == "--resume") sweep_opts.resume = true;
+			else if (arg == "--results") sweep_opts.results_path = value();
+			else if (arg == "--cache") sweep_opts.cache_path = value();
+			else if (arg == "--cache-append") sweep_opts.cache_append = true;
+			else if (arg == "--progress") sweep_opts.progress_every_sec = std::stod(value());
+			else if (arg == "--telemetry") sweep_opts.telemetry_path = value();
+			else if (arg == "--estimate") estimate_only = true;
+			else if (arg == "--max-runtime") max_runtime = std::stod(value());
+			else if (arg == "--from" || arg == "--to") {											// any time format the CSV loader reads
+				const auto spec = value();
+				const auto ts = sugar::parse_timestamp(spec);
+				if (ts == sugar::kNoTimestamp) throw std::runtime_error(std::string(arg) + " wants a date or ISO-8601 time: " + spec);
+				(arg == "--from" ? from_ts : to_ts) = ts;
+			}
+			else if (arg == "--timeframe") timeframe = sugar::parse_timeframe(value());
+			else if (arg == "--worker") return sugar::run_shard_worker(value());						// worker process: no local CSV/grid
+			else if (arg == "--coordinator") shard_dir = value();
+			else if (arg == "--workers") shard_opts.local_workers = std::stoull(value());
+			else if (arg == "--shards") shard_opts.shards = std::stoull(value());
+			else if (arg == "--search") search_name = value();
+			else if (arg == "--budget") search_budget = std::stoull(value());
+			else if (arg == "--seed") search_seed = std::stoull(value());
+			else if (arg == "--walk-forward") {															// TRAIN,TEST[,STEP] in bars
+				const std::string spec = value();
+				const auto c1 = spec.find(','), c2 = spec.find(',', c1 == std::string::npos ? c1 : c1 + 1);
+				if (c1 == std::string::npos) throw std::runtime_error("--walk-forward wants TRAIN,TEST[,STEP]: " + spec);
+				wf_opts.train_bars = std::stoull(spec.substr(0, c1));
+				wf_opts.test_bars = std::stoull(spec.substr(c1 + 1, c2 - c1 - 1));
+				if (c2 != std::string::npos) wf_opts.step_bars = std::stoull(spec.substr(c2 + 1));
+			}
+			else if (arg == "--anchored") wf_opts.anchored = true;
+			else if (arg == "--threads") threads = std::stoull(value());
+			else if (arg == "--monte-carlo") mc_mode = value();
+			else if (arg == "--resamples") mc_opts.resamples = std::stoull(value());
+			else if (arg == "--block") mc_opts.block_bars = std::stoull(value());
+			else if (arg == "--noise") mc_opts.noise_sigma = std::stod(value());
+			else if (arg == "--universe") universe_dir = value();
+			else if (arg == "--jobs") jobs_path = value();
+			else if (arg == "--batch") uni_opts.max_resident_symbols = std::stoull(value());
+			else if (arg == "--max-resident") uni_opts.max_resident_candles = std::stoull(value());
+			else if (arg == "--loaders") uni_opts.loader_threads = std::stoull(value());
+			else if (arg == "--no-mmap") uni_opts.mmap = false;
+			else if (arg == "--report") report_path = value();
+			else if (arg == "--stream") stream_source = value();
+			else if (arg == "--strategy") stream_strategy = value();
+			else if (arg == "--queue") stream_opts.queue = std::stoull(value());
+			else if (arg == "--wait") stream_opts.wait = sugar::parse_wait_mode(value());
+			else if (arg == "--profile") {																// per-stage timings to a JSON file at exit
+				const std::string path = value();
+				if (!sugar::prof::enable(path))
+					std::cerr << "[profile] this build has no probes; reconfigure with -DSUGAR_PROFILE=ON\n";
+			}
+			else if (arg == "--params") {																// FAST,SLOW,ROC,THRESH
+				const std::string spec = value();
+				std::size_t f, s, r; double th; char c1, c2, c3;
+				std::istringstream in(spec);
+				if (!(in >> f >> c1 >> s >> c2 >> r >> c3 >> th) || c1 != ',' || c2 != ',' || c3 != ',')
+					throw std::runtime_error("--params wants FAST,SLOW,ROC,THRESH: " + spec);
+				uni_opts.params = { f, s, r, th };
+				uni_opts.sweep = false;
+			}
+			else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Unknown option: " + std::string(arg));
+			else path = arg;
+		}
+		wf_opts.threads = mc_opts.threads = threads;
+		mc_opts.seed = search_seed;
+		if (!mc_mode.empty()) mc_opts.mode = sugar::parse_monte_carlo_mode(mc_mode);					// fail before loading data
+		if (sweep_opts.cache_append && sweep_opts.cache_path.empty())
+			sweep_opts.cache_path = "sweep.cache";														// default location for a bare --cache-append
+		if (sweep_opts.resume && sweep_opts.checkpoint_path.empty())
+			sweep_opts.checkpoint_path = "sweep.ckpt";													// default location for a bare --resume
+
+		if (!jobs_path.empty()) {																	// batch: grids, strategies and datasets from a file
+			auto file = sugar::parse_job_file(jobs_path);
+			if (threads) file.threads = threads;
+			sugar::JobStats st;
+			const auto t0 = std::chrono::steady_clock::now();
+			const auto results = sugar::run_jobs(file, &st);
+			const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+			for (const auto& res : results) {
+				std::cout << "\n[" << res.name << "] " << sugar::job_strategy_name(res.strategy) << " on '" << res.data << "'"
+					<< (res.timeframe ? " @" + sugar::timeframe_name(res.timeframe) : std::string()) << ": "
+					<< res.combos << " combos in " << res.seconds << "s\n";
+				for (const auto& row : res.top)
+					std::cout << " score=" << row.score << " | " << row.params << " | PnL: " << row.r.pnl
+						<< "%, Trades: " << row.r.trades << ", Max DD: " << row.r.max_drawdown << "%\n";
+			}
+			std::cout << "\n" << results.size() << " job(s) in " << secs << "s: " << st.datasets_loaded << " dataset load(s) ("
+				<< st.load_seconds << "s), " << st.timeframes_built << " timeframe(s) resampled (" << st.resample_seconds << "s), "
+				<< st.indicators_computed << " indicator series built for " << st.indicator_uses
+				<< " uses (" << st.indicator_seconds << "s)\n";
+			return 0;
+		}
+
+		// Sweep example
+		auto fasts = make_range(45, 55, 1);
+		auto slows = make_range(55,65, 1);
+		auto rocs = make_range(95, 105, 1);
+		auto thresholds = make_drange(0.10, 0.20, 0.01);
+
+		if (!stream_source.empty()) {																// live: one bar at a time from a feed
+			sugar::StreamStrategyPtr strat;
+			if (stream_strategy == "roc") {
+				const auto [f, s, rlen, th] = uni_opts.sweep ? sugar::RocSmaParams{ 50, 60, 100, 0.15 } : uni_opts.params;
+				strat = std::make_unique<sugar::RocSmaStream>(f, s, rlen, th);
+			}
+			else if (stream_strategy == "swing") strat = std::make_unique<sugar::SwingBreakoutStream>(2, 2, true, 2, 4.0, 3, 8.0);	// run_swing_breakout's defaults
+			else throw std::runtime_error("--strategy wants roc or swing: " + stream_strategy);
+
+			std::signal(SIGINT, [](int) { g_stop.store(true); });
+			sugar::LineFeed feed(stream_source);
+			std::cout << std::fixed << std::setprecision(2);
+			std::cerr << "[stream] " << strat->name() << " on '" << stream_source << "', "
+				<< (stream_opts.queue ? std::to_string(stream_opts.queue) + "-slot queue, " + sugar::wait_mode_name(stream_opts.wait) + " wait"
+					: std::string("single thread")) << ", Ctrl+C to stop\n";
+			const auto st = sugar::run_stream(feed, *strat, [](const sugar::StreamSignal& sig) {
+				char buf[9];
+				sugar::format_yyyymmdd(sig.date, buf);
+				std::cout << std::string_view(buf, 8) << (sig.kind == sugar::StreamSignal::Kind::Entry ? " ENTRY " : " EXIT  ")
+					<< sig.price;
+				if (sig.kind == sugar::StreamSignal::Kind::Exit) std::cout << " (" << sig.trade_ret << "%)";
+				std::cout << std::endl;																// flush: someone may be acting on it
+			}, g_stop, stream_opts);
+			const auto r = strat->result();
+			std::cout << "\nStream " << (g_stop.load() ? "stopped" : "ended") << ": " << st.lines << " lines, " << st.bars
+				<< " bars (" << st.rejected << " out of order), " << st.signals << " signals\n"
+				<< " PnL: " << r.pnl << "%, Trades: " << r.trades << ", Max DD: " << r.max_drawdown << "%\n"
+				<< " Decision latency: " << st.decision.summary() << "\n"
+				<< " Signal latency:   " << st.signal.summary() << "\n";
+			return 0;
+		}
+
+		if (!universe_dir.empty()) {																		// many symbols, one process
+			uni_opts.threads = threads;
+			uni_opts.space = { fasts, slows, rocs, thresholds };
+			const auto pf = sugar::run_universe(universe_dir, uni_opts);
+			std::cout << std::fixed << std::setprecision(2);
+			std::cout << "\nUniverse '" << universe_dir << "': " << pf.loaded << " symbols (" << pf.failed << " failed), "
+				<< (uni_opts.sweep ? "per-symbol sweep" : "fixed params") << ", " << pf.stages.wall_seconds << "s, peak "
+				<< pf.peak_resident_symbols << " symbols / " << pf.peak_resident_candles << " candles resident\n";
+			const auto& st = pf.stages;
+			std::cout << " Stages: load " << st.loader_threads << " thr, " << st.load_utilization() * 100.0 << "% busy, "
+				<< st.share(st.load_blocked, st.loader_threads) * 100.0 << "% blocked on memory | compute "
+				<< st.compute_threads << " thr, " << st.compute_utilization() * 100.0 << "% busy, "
+				<< st.share(st.compute_starved, st.compute_threads) * 100.0 << "% starved for data\n";
+			for (const auto& sr : pf.symbols)
+				if (!sr.error.empty()) std::cerr << "[universe] " << sr.symbol << ": " << sr.error << "\n";
+			std::cout << " Per symbol: mean PnL " << pf.mean_pnl << "%, median " << pf.median_pnl << "%, mean Max DD "
+				<< pf.mean_drawdown << "%, profitable " << pf.win_rate * 100.0 << "%, trades " << pf.trades << "\n"
+				<< " Portfolio (equal capital): PnL " << pf.portfolio.pnl << "%, Max DD " << pf.portfolio.max_drawdown << "%\n";
+			if (!report_path.empty()) {
+				std::ofstream rep(report_path);
+				if (!rep) throw std::runtime_error("Failed to open report: " + report_path);
+				rep << "symbol,bars,first_date,last_date,fast,slow,roc,thresh,pnl,max_drawdown,trades,error\n";
+				for (const auto& sr : pf.symbols) {
+					const auto& [f, s, rlen, th] = sr.params;
+					rep << sr.symbol << ',' << sr.bars << ',' << sr.first_date << ',' << sr.last_date << ','
+						<< f << ',' << s << ',' << rlen << ',' << th << ',' << sr.result.pnl << ','
+						<< sr.result.max_drawdown << ',' << sr.result.trades << ',' << sr.error << '\n';
+				}
+			}
+			return 0;
+		}
+
+		auto candles = sugar::load_candles(path);
 		sugar::CandleSeries series{ std::move(candles) };
+		if (from_ts != INT64_MIN || to_ts != INT64_MAX) {											// time window: O(log runs) lookups, no copy
+			const sugar::TimeIndex index(series.rows());
+			const auto [b, e] = index.range(from_ts, to_ts);
+			series = series.slice(b, e);
+		}
+		if (timeframe) {																			// e.g. minute file swept on hourly bars
+			const std::int64_t tfs[] = { timeframe };
+			series = std::move(sugar::resample(series, tfs)[0].series);
+		}
 
 
 		// Print tail to verify parse
@@ -78,9 +310,11 @@ int main(int argc, char** argv) {
 		std::size_t count = std::min<std::size_t>(rows.size(), 20);
 		std::cout << "Print data tail to verify csv loaded to user: " << '\n';
 		for (std::size_t i = rows.size() - count; i < rows.size(); ++i) {
-			const auto& c = rows[i]; char buf[9]; 
-			sugar::format_yyyymmdd(c.date, buf);
-			std::cout << std::string_view(buf, 8)
+			const auto& c = rows[i]; char buf[20];
+			const bool intraday = c.ts != sugar::ts_from_yyyymmdd(c.date);
+			if (intraday) sugar::format_iso8601(c.ts, buf);
+			else sugar::format_yyyymmdd(c.date, buf);
+			std::cout << std::string_view(buf, intraday ? 20 : 8)
 				<< ", " << c.open
 				<< ", " << c.high
 				<< ", " << c.low
@@ -88,6 +322,32 @@ int main(int argc, char** argv) {
 				<< ", vol=" << c.volume << "\n";
 		}
 		std::cout << "Loaded " << rows.size() << " candle(s) from '" << path << "'\n";
+
+		if (rule) {																					// one rule, one run
+			sugar::RuleStrategy strat{ *rule };
+			std::cout << "\nRule program (" << strat.program().code().size() << " instructions, "
+				<< strat.program().registers() << " registers):\n" << strat.program().disassemble();
+			sugar::TradeLog log(trade_log);
+			sugar::RunContext ctx;
+			if (trade_log > 0) ctx.trade_log = &log;
+			const auto t0 = std::chrono::steady_clock::now();
+			const auto r = strat.run(series, ctx);
+			const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+			std::cout << "\nRule backtest took " << secs << "s\n"
+				<< " PnL: " << r.pnl << "%, Trades: " << r.trades << ", Max DD: " << r.max_drawdown << "%\n"
+				<< " Sharpe: " << r.risk.sharpe << ", Sortino: " << r.risk.sortino << ", Ulcer: " << r.risk.ulcer
+				<< ", Win rate: " << r.risk.win_rate << "%, Profit factor: " << r.risk.profit_factor
+				<< ", Exposure: " << r.risk.exposure << "%, Avg hold: " << r.risk.avg_hold << " bars\n";
+			for (const auto& t : log.records()) {
+				char b0[9], b1[9];
+				sugar::format_yyyymmdd(series[t.entry_bar].date, b0);
+				sugar::format_yyyymmdd(series[t.exit_bar].date, b1);
+				std::cout << " " << std::string_view(b0, 8) << " -> " << std::string_view(b1, 8)
+					<< " (" << t.exit_bar - t.entry_bar << " bars): " << t.ret << "%\n";
+			}
+			if (log.dropped()) std::cout << " ... " << log.dropped() << " more\n";
+			return 0;
+		}
 		
 		/*
 		run_swing_breakout(series);
@@ -99,12 +359,6 @@ int main(int argc, char** argv) {
 			<< std::endl;
 		*/
 		
-		// Sweep example
-		auto fasts = make_range(45, 55, 1);
-		auto slows = make_range(55,65, 1);
-		auto rocs = make_range(95, 105, 1);
-		auto thresholds = make_drange(0.10, 0.20, 0.01);
-
 		// naive count (upper bound)
 		const std::size_t naive =
 			fasts.size() * slows.size() * rocs.size() * thresholds.size();
@@ -120,20 +374,77 @@ int main(int argc, char** argv) {
 		const std::size_t combos =
 			fasts.size() * slows.size() * rocs.size() * thresholds.size();
 
-		if (combos > 1000000) {
-			std::cerr << "[Note] Large grid (" << combos
-				<< " combos). Consider narrowing ranges or steps.\n"
-				<< "Continue anyway? y/n \n";
-				char a = 'n';
-				std::cin >> a;
-				if (a != 'y') {
-					std::cerr << "Exiting program with no calculation.\n";
-					return 0;
-				};
+		if (!search_name.empty()) {																			// budgeted search: cost is capped, no prompt needed
+			auto search = sugar::make_search(search_name, search_seed);
+			const sugar::RocSmaSpace space{ fasts, slows, rocs, thresholds };
+			auto t0 = std::chrono::high_resolution_clock::now();
+			const auto found = search->search(series, space, search_budget, sweep_opts.top_k);
+			auto t1 = std::chrono::high_resolution_clock::now();
+			std::chrono::duration<double> dt = t1 - t0;
+
+			std::cout << "\nSearch '" << search->name() << "' took " << dt.count() << "s, "
+				<< found.evaluations << " evaluations (" << found.full_run_equivalents
+				<< " full-run equivalents) of " << effective << " combos.\n";
+			for (const auto& row : found.top) {
+				const auto& [f, s, rlen, th] = row.p;
+				std::cout << " score=" << row.score << " | fast=" << f << " slow=" << s
+					<< " roc=" << rlen << " thresh=" << th << " | PnL: " << row.r.pnl
+					<< "%, Trades: " << row.r.trades << ", Max DD: " << row.r.max_drawdown << "%\n";
+			}
+			return 0;
+		}
+
+		if (wf_opts.train_bars > 0) {																		// walk-forward: out-of-sample view of the same grid
+			const sugar::RocSmaSpace space{ fasts, slows, rocs, thresholds };
+			auto t0 = std::chrono::high_resolution_clock::now();
+			const auto wf = sugar::walk_forward_roc_sma(series, space, wf_opts);
+			auto t1 = std::chrono::high_resolution_clock::now();
+			std::chrono::duration<double> dt = t1 - t0;
+
+			std::cout << "\nWalk-forward (" << (wf_opts.anchored ? "anchored" : "rolling") << ") took " << dt.count()
+				<< "s, " << wf.windows.size() << " windows, " << wf.evaluations << " train runs.\n";
+			for (const auto& w : wf.windows) {
+				const auto& [f, s, rlen, th] = w.params;
+				char b0[9], b1[9];
+				sugar::format_yyyymmdd(series[w.test_begin].date, b0);
+				sugar::format_yyyymmdd(series[w.test_end - 1].date, b1);
+				std::cout << " test " << std::string_view(b0, 8) << ".." << std::string_view(b1, 8)
+					<< " | fast=" << f << " slow=" << s << " roc=" << rlen << " thresh=" << th
+					<< " | train PnL: " << w.train.pnl << "% | test PnL: " << w.test.pnl
+					<< "%, Trades: " << w.test.trades << ", Max DD: " << w.test.max_drawdown << "%\n";
+			}
+			const auto& st = wf.stability;
+			std::cout << "\nOut-of-sample (stitched): PnL: " << wf.oos.pnl << "%, Trades: " << wf.oos.trades
+				<< ", Max DD: " << wf.oos.max_drawdown << "%\n"
+				<< "Parameter stability: " << st.changes << " changes over " << wf.windows.size() << " windows"
+				<< " | fast " << st.fast_mean << "+/-" << st.fast_stdev
+				<< ", slow " << st.slow_mean << "+/-" << st.slow_stdev
+				<< ", roc " << st.roc_mean << "+/-" << st.roc_stdev
+				<< ", thresh " << st.thresh_mean << "+/-" << st.thresh_stdev
+				<< " | efficiency " << st.efficiency << "\n";
+			return 0;
+		}
+
+		if (estimate_only || max_runtime > 0.0 || combos > 1000000) {								// time a sample instead of asking: jobs run unattended
+			const auto est = sugar::estimate_sweep_roc_sma(series, fasts, slows, rocs, thresholds, sweep_opts);
+			std::cerr << "[estimate] " << est.combos << " combos x " << est.sec_per_combo * 1e6 << " us (" << est.sampled
+				<< " sampled) = " << sugar::format_duration(est.seconds) << " single-threaded"
+				<< (sweep_opts.prune || !sweep_opts.cache_path.empty() ? " (upper bound: prune/cache cut this)" : "")
+				<< ", ~" << sugar::format_bytes(double(est.resident_bytes)) << " resident";
+			if (est.results_bytes) std::cerr << ", " << sugar::format_bytes(double(est.results_bytes)) << " of results on disk";
+			std::cerr << "\n";
+			if (estimate_only) return 0;
+			if (max_runtime > 0.0 && est.seconds > max_runtime) {
+				std::cerr << "[estimate] over --max-runtime " << max_runtime << "s"
+					<< "; narrow the grid, add --prune, or use --search. Exiting with no calculation.\n";
+				return 3;
+			}
 		}
 
 		auto t0 = std::chrono::high_resolution_clock::now();
-		auto best = sugar::sweep_roc_sma(series, fasts, slows, rocs, thresholds);
+		auto best = shard_dir.empty()
+			? sugar::sweep_roc_sma(series, fasts, slows, rocs, thresholds, sweep_opts)
+			: sugar::run_sharded_sweep(shard_dir, { path, fasts, slows, rocs, thresholds, sweep_opts }, shard_opts);
 		auto& [bf, bs, br, btval] = best.params;
 		auto t1 = std::chrono::high_resolution_clock::now();
 		std::chrono::duration<double> dt = t1 - t0;
@@ -146,6 +457,55 @@ int main(int argc, char** argv) {
 			<< " roc=" << br << " thresh=" << btval << "%\n";
 		std::cout << " PnL: " << best.best.pnl << "%, Trades: " << best.best.trades
 			<< ", Max DD: " << best.best.max_drawdown << "%\n";
+		const auto& risk = best.best.risk;
+		std::cout << " Sharpe: " << risk.sharpe << ", Sortino: " << risk.sortino << ", Ulcer: " << risk.ulcer
+			<< ", Win rate: " << risk.win_rate << "%, Profit factor: " << risk.profit_factor
+			<< ", Exposure: " << risk.exposure << "%, Avg hold: " << risk.avg_hold << " bars (per-bar ratios, ranked by "
+			<< sugar::sweep_rank_name(sweep_opts.rank) << ")\n";
+
+		if (trade_log > 0) {																		// the winner's trades, from one more run
+			sugar::RocSmaCrossoverStrategy strat{ bf, bs, br, btval };
+			sugar::TradeLog log(trade_log);
+			sugar::RunContext ctx;
+			ctx.trade_log = &log;
+			strat.run(series, ctx);
+			std::cout << "\nTrades:\n";
+			for (const auto& t : log.records()) {
+				char b0[9], b1[9];
+				sugar::format_yyyymmdd(series[t.entry_bar].date, b0);
+				sugar::format_yyyymmdd(series[t.exit_bar].date, b1);
+				std::cout << " " << std::string_view(b0, 8) << " -> " << std::string_view(b1, 8)
+					<< " (" << t.exit_bar - t.entry_bar << " bars): " << t.ret << "%\n";
+			}
+			if (log.dropped()) std::cout << " ... " << log.dropped() << " more\n";
+		}
+
+		if (!mc_mode.empty()) {																				// how fragile is the winner?
+			const sugar::RocSmaCrossoverStrategy strat{ bf, bs, br, btval };
+			sugar::MonteCarloResult mc;
+			if (mc_opts.mode == sugar::MonteCarloMode::PriceNoise) {
+				mc = sugar::monte_carlo(series, [strat](const sugar::CandleSeries& s) {
+					auto run = strat;																		// run() is non-const: one copy per resample
+					return run.run(s);
+				}, mc_opts);
+			}
+			else {
+				const sugar::SmaBank bank(series, { bf, bs });
+				sugar::TradeTrace trace;
+				strat.run_window(bank, 0, series.size(), &trace);
+				mc = sugar::monte_carlo(trace, mc_opts);
+			}
+			auto print = [](const char* name, const sugar::Distribution& d) {
+				std::cout << " " << name << ": mean " << d.mean << " sd " << d.stdev << " | min " << d.min
+					<< " p5 " << d.p5 << " p25 " << d.p25 << " p50 " << d.p50 << " p75 " << d.p75
+					<< " p95 " << d.p95 << " max " << d.max << "\n";
+			};
+			std::cout << "\nMonte Carlo (" << sugar::monte_carlo_mode_name(mc_opts.mode) << ", " << mc_opts.resamples
+				<< " resamples) took " << mc.seconds << "s, " << mc.resamples_per_sec << " resamples/s\n";
+			print("PnL %   ", mc.pnl_dist);
+			print("Max DD %", mc.dd_dist);
+			std::cout << " P(PnL < 0): " << mc.prob_loss << "\n";
+		}
 
 
 		// Run OOP strategy via Backtester
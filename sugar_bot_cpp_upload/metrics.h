@@ -1,16 +1,134 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
 
 
 namespace sugar {
 
 
+	struct RiskMetrics {										// extended metrics, filled by MetricsAccumulator::finish
+		std::size_t bars{};										// bars scored: first usable bar to the end of the run
+		double win_rate{};										// % of trades with a positive return
+		double profit_factor{};									// gross wins / gross losses (inf with wins and no losses)
+		double avg_trade{};										// mean trade return (%)
+		double avg_hold{};										// mean bars from entry to exit
+		double exposure{};										// % of bars spent in a position (entry to exit)
+		double sharpe{};										// mean / sd of the per-bar equity change (not annualised)
+		double sortino{};										// mean / downside deviation of the same changes
+		double ulcer{};											// RMS drawdown of marked equity below its peak (% points)
+	};
+
+
 	struct BacktestResult {
 		double pnl{};											// cumulative % return across closed trades
 		std::size_t trades{};									// round-trip trades
 		double max_drawdown{};									// max peak-to-trough drawdown (%)
 		int best_start_date{};									// first usable signal date (YYYYMMDD)
+		bool pruned{};											// run stopped early by a PruneLimit; metrics are partial
+		RiskMetrics risk{};										// Sharpe, Sortino, ulcer, win rate ... of the same run
+	};
+
+
+	struct TradeTrace {											// path behind a BacktestResult, for resampling / stitching
+		std::vector<double> trade_returns;						// % return of each closed trade, in order
+		std::vector<double> bar_pnl;							// per-bar change of marked-to-market equity (% points)
+	};
+
+
+	struct TradeRecord {										// 12 bytes per trade
+		std::uint32_t entry_bar{}, exit_bar{};					// series indices
+		float ret{};											// % return
+	};
+
+
+	// First `capacity` trades of a run, in a buffer sized once up front.
+	// Trades past the end are only counted; clear() to reuse for another run.
+	class TradeLog {
+	public:
+		explicit TradeLog(std::size_t capacity) : buf_(capacity) {}
+
+		void push(std::uint64_t entry_bar, std::uint64_t exit_bar, double ret) {	// no allocation: inlines into strategy loops
+			if (size_ == buf_.size()) { ++dropped_; return; }
+			buf_[size_++] = { static_cast<std::uint32_t>(entry_bar), static_cast<std::uint32_t>(exit_bar), static_cast<float>(ret) };
+		}
+		void clear() { size_ = 0; dropped_ = 0; }
+		std::span<const TradeRecord> records() const { return { buf_.data(), size_ }; }
+		std::size_t dropped() const { return dropped_; }
+
+	private:
+		std::vector<TradeRecord> buf_;
+		std::size_t size_{}, dropped_{};
+	};
+
+
+	// Online form of RiskMetrics: O(1) state, fed by a strategy once per entry
+	// and exit and once per bar after its trading decision. Plain data, so
+	// strategies can carry it in resumable state and files can store it.
+	struct MetricsAccumulator {
+		std::uint64_t bars{};									// bars fed
+		std::uint64_t trades{}, wins{}, hold{};					// hold: bars summed over closed trades
+		std::uint64_t open_bar{};								// entry bar of the open position
+		double basis{}, scale{};								// entry price and 100 / entry; scale 0 when flat
+		double marked{}, peak{};								// last marked equity and its running max
+		double sum_sq{}, down_sq{};								// per-bar changes: squares, squares of losses (their sum is marked)
+		double dd_sq{};											// squared drawdowns below peak
+		double gross_win{}, gross_loss{};						// summed returns of winning / losing trades
+
+		// equity = closed-trade equity; the open position is marked at `close`.
+		// No branches (position flips are as unpredictable as the signal; the
+		// flat case is a select, so a NaN close while flat marks nothing) and
+		// few running sums, so the state stays in registers in strategy loops.
+		void bar(double equity, double close) {
+			const double open_pnl = (close - basis) * scale;
+			const double now = equity + (scale != 0.0 ? open_pnl : 0.0);
+			const double d = now - marked;
+			marked = now;
+			++bars;
+			const double loss = std::min(d, 0.0);
+			sum_sq += d * d; down_sq += loss * loss;
+			peak = std::max(peak, marked);
+			const double dd = peak - marked;
+			dd_sq += dd * dd;
+		}
+
+		void open(std::uint64_t bar_index, double price) { open_bar = bar_index; basis = price; scale = 100.0 / price; }
+
+		void close(std::uint64_t bar_index, double ret, TradeLog* log = nullptr) {
+			scale = 0.0;
+			++trades; hold += bar_index - open_bar;
+			if (ret > 0.0) { ++wins; gross_win += ret; }
+			else gross_loss -= ret;
+			if (log) log->push(open_bar, bar_index, ret);
+		}
+
+		RiskMetrics finish() const {
+			RiskMetrics m{};
+			m.bars = static_cast<std::size_t>(bars);
+			if (trades > 0) {
+				const double t = static_cast<double>(trades);
+				m.win_rate = 100.0 * static_cast<double>(wins) / t;
+				m.avg_trade = (gross_win - gross_loss) / t;
+				m.avg_hold = static_cast<double>(hold) / t;
+				m.profit_factor = gross_loss > 0.0 ? gross_win / gross_loss
+					: gross_win > 0.0 ? std::numeric_limits<double>::infinity() : 0.0;
+			}
+			if (bars > 0) {
+				const double n = static_cast<double>(bars), mean = marked / n;	// changes telescope from 0
+				const double sd = std::sqrt(std::max(0.0, sum_sq / n - mean * mean));
+				const double dsd = std::sqrt(down_sq / n);
+				m.exposure = 100.0 * static_cast<double>(hold) / n;
+				m.sharpe = sd > 0.0 ? mean / sd : 0.0;
+				m.sortino = dsd > 0.0 ? mean / dsd : 0.0;
+				m.ulcer = std::sqrt(dd_sq / n);
+			}
+			return m;
+		}
 	};
 
 
-} // namespace sugar
\ No newline at end of file
+} // namespace sugar
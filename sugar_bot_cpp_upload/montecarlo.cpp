@@ -0,0 +1,133 @@
+#include "montecarlo.h"
+#include "parallel.h"
+#include "profile.h"
+#include "rng.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace sugar {
+
+    namespace {
+
+        constexpr std::size_t kChunk = 64;                              // resamples per parallel work item
+
+        // pnl / max_drawdown of a sequence of additive % steps, with the
+        // strategies' accounting (peak starts at 0, checked after every step).
+        void path_metrics(const std::vector<double>& steps, double& pnl, double& dd) {
+            double equity = 0.0, peak = 0.0;
+            dd = 0.0;
+            for (double x : steps) {
+                equity += x; peak = std::max(peak, equity);
+                dd = std::max(dd, peak - equity);
+            }
+            pnl = equity;
+        }
+
+        // Runs fn(i, rng, pnl, dd) for every resample on the pool and fills the result.
+        template <class Fn>
+        MonteCarloResult run_resamples(const MonteCarloOptions& opts, Fn fn) {
+            SUGAR_PROF_SCOPE("montecarlo/resamples");
+            MonteCarloResult out;
+            const std::size_t n = opts.resamples;
+            out.pnl.assign(n, 0.0);
+            out.max_drawdown.assign(n, 0.0);
+
+            const auto t0 = std::chrono::steady_clock::now();
+            parallel_for((n + kChunk - 1) / kChunk, opts.threads, [&](std::size_t chunk) {
+                const std::size_t end = std::min(n, (chunk + 1) * kChunk);
+                for (std::size_t i = chunk * kChunk; i < end; ++i) {
+                    SplitMix64 rng = rng_stream(opts.seed, i);
+                    fn(rng, out.pnl[i], out.max_drawdown[i]);
+                }
+            });
+            out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            out.resamples_per_sec = out.seconds > 0.0 ? double(n) / out.seconds : 0.0;
+
+            out.pnl_dist = summarize(out.pnl);
+            out.dd_dist = summarize(out.max_drawdown);
+            std::size_t losses = 0;
+            for (double p : out.pnl) losses += p < 0.0;
+            out.prob_loss = n ? double(losses) / double(n) : 0.0;
+            return out;
+        }
+
+    } // namespace
+
+    MonteCarloMode parse_monte_carlo_mode(const std::string& name) {
+        if (name == "shuffle") return MonteCarloMode::TradeShuffle;
+        if (name == "block") return MonteCarloMode::BlockBootstrap;
+        if (name == "noise") return MonteCarloMode::PriceNoise;
+        throw std::runtime_error("Unknown Monte Carlo mode: " + name);
+    }
+
+    const char* monte_carlo_mode_name(MonteCarloMode mode) {
+        switch (mode) {
+        case MonteCarloMode::TradeShuffle: return "shuffle";
+        case MonteCarloMode::BlockBootstrap: return "block";
+        case MonteCarloMode::PriceNoise: return "noise";
+        }
+        return "?";
+    }
+
+    Distribution summarize(std::vector<double> v) {
+        Distribution d;
+        if (v.empty()) return d;
+        std::sort(v.begin(), v.end());
+        auto q = [&](double p) { return v[static_cast<std::size_t>(p * double(v.size() - 1) + 0.5)]; };
+        double sum = 0.0;
+        for (double x : v) sum += x;
+        d.mean = sum / double(v.size());
+        double var = 0.0;
+        for (double x : v) var += (x - d.mean) * (x - d.mean);
+        d.stdev = std::sqrt(var / double(v.size()));
+        d.min = v.front(); d.max = v.back();
+        d.p5 = q(0.05); d.p25 = q(0.25); d.p50 = q(0.50); d.p75 = q(0.75); d.p95 = q(0.95);
+        return d;
+    }
+
+    MonteCarloResult monte_carlo(const TradeTrace& trace, const MonteCarloOptions& opts) {
+        if (opts.mode == MonteCarloMode::TradeShuffle) {
+            const auto& trades = trace.trade_returns;
+            return run_resamples(opts, [&](SplitMix64& rng, double& pnl, double& dd) {
+                std::vector<double> order(trades);
+                std::shuffle(order.begin(), order.end(), rng);
+                path_metrics(order, pnl, dd);
+            });
+        }
+        if (opts.mode == MonteCarloMode::BlockBootstrap) {
+            const auto& bars = trace.bar_pnl;
+            const std::size_t block = std::max<std::size_t>(1, opts.block_bars);
+            return run_resamples(opts, [&](SplitMix64& rng, double& pnl, double& dd) {
+                std::vector<double> path;
+                path.reserve(bars.size());
+                std::uniform_int_distribution<std::size_t> start(0, bars.empty() ? 0 : bars.size() - 1);
+                while (path.size() < bars.size()) {                     // circular blocks until the original length
+                    const std::size_t s = start(rng);
+                    for (std::size_t j = 0; j < block && path.size() < bars.size(); ++j)
+                        path.push_back(bars[(s + j) % bars.size()]);
+                }
+                path_metrics(path, pnl, dd);
+            });
+        }
+        throw std::invalid_argument("monte_carlo: price noise needs the series and a runner");
+    }
+
+    MonteCarloResult monte_carlo(const CandleSeries& data, const SeriesRunner& run, const MonteCarloOptions& opts) {
+        if (opts.mode != MonteCarloMode::PriceNoise) throw std::invalid_argument("monte_carlo: series overload is for price noise");
+        const auto rows = data.rows();
+        return run_resamples(opts, [&](SplitMix64& rng, double& pnl, double& dd) {
+            std::normal_distribution<double> noise(0.0, opts.noise_sigma);
+            std::vector<Candle> path(rows.begin(), rows.end());
+            for (Candle& c : path) {                                    // one factor per bar keeps each candle consistent
+                const double k = 1.0 + noise(rng);
+                c.open *= k; c.high *= k; c.low *= k; c.close *= k;
+            }
+            const auto r = run(CandleSeries{ std::move(path) });
+            pnl = r.pnl; dd = r.max_drawdown;
+        });
+    }
+
+} // namespace sugar
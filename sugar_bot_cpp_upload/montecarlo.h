@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "metrics.h"
+#include "series.h"
+
+namespace sugar {
+
+    // Monte Carlo robustness checks for one strategy result.
+    //
+    //   shuffle  - random permutations of the trade list: pnl is unchanged,
+    //              the drawdown distribution shows how lucky the order was.
+    //   block    - circular block bootstrap of per-bar marked-to-market P&L,
+    //              keeping short-range autocorrelation inside each block.
+    //   noise    - every candle's prices scaled by (1 + sigma * N(0,1)) and
+    //              the strategy re-run on the perturbed series.
+    //
+    // Resample i always draws from its own RNG stream seeded from (seed, i),
+    // so results are identical for any thread count.
+
+    enum class MonteCarloMode { TradeShuffle, BlockBootstrap, PriceNoise };
+
+    struct MonteCarloOptions {
+        MonteCarloMode mode = MonteCarloMode::TradeShuffle;
+        std::size_t resamples = 10000;
+        std::size_t block_bars = 20;                                    // block bootstrap block length
+        double noise_sigma = 0.002;                                     // price noise, fraction of price per bar
+        std::uint64_t seed = 42;
+        std::size_t threads = 0;                                        // 0 = hardware concurrency
+    };
+
+    struct Distribution {
+        double mean{}, stdev{};
+        double min{}, p5{}, p25{}, p50{}, p75{}, p95{}, max{};
+    };
+
+    struct MonteCarloResult {
+        std::vector<double> pnl;                                        // one entry per resample
+        std::vector<double> max_drawdown;
+        Distribution pnl_dist;
+        Distribution dd_dist;
+        double prob_loss{};                                             // share of resamples with pnl < 0
+        double seconds{};
+        double resamples_per_sec{};
+    };
+
+    // "shuffle" | "block" | "noise"; throws on anything else.
+    MonteCarloMode parse_monte_carlo_mode(const std::string& name);
+    const char* monte_carlo_mode_name(MonteCarloMode mode);
+
+    // Uses trace.trade_returns (shuffle) or trace.bar_pnl (block).
+    MonteCarloResult monte_carlo(const TradeTrace& trace, const MonteCarloOptions& opts);
+
+    // Re-runs `run` on noise-perturbed copies of `data` (mode must be PriceNoise).
+    using SeriesRunner = std::function<BacktestResult(const CandleSeries&)>;
+    MonteCarloResult monte_carlo(const CandleSeries& data, const SeriesRunner& run, const MonteCarloOptions& opts);
+
+    Distribution summarize(std::vector<double> v);
+
+} // namespace sugar
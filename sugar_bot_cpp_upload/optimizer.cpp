@@ -0,0 +1,261 @@
+#include "optimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace sugar {
+
+    namespace {
+
+        constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        // Flat numbering of valid combos: (fast, slow) pair major, then roc, then thresh.
+        class ComboIndex {
+        public:
+            struct Coord { std::size_t fi, si, ri, ti; };
+
+            explicit ComboIndex(const RocSmaSpace& sp) : sp_(sp), pair_of_(sp.fasts.size() * sp.slows.size(), npos) {
+                for (std::size_t fi = 0; fi < sp.fasts.size(); ++fi)
+                    for (std::size_t si = 0; si < sp.slows.size(); ++si)
+                        if (sp.fasts[fi] < sp.slows[si]) {
+                            pair_of_[fi * sp.slows.size() + si] = pairs_.size();
+                            pairs_.push_back({ fi, si });
+                        }
+            }
+
+            std::size_t size() const { return pairs_.size() * sp_.rocs.size() * sp_.threshes.size(); }
+
+            Coord coord(std::size_t idx) const {
+                const std::size_t nt = sp_.threshes.size(), nr = sp_.rocs.size();
+                const auto& pr = pairs_[idx / (nr * nt)];
+                return { pr.first, pr.second, (idx / nt) % nr, idx % nt };
+            }
+
+            // npos when fast >= slow at this coordinate.
+            std::size_t flat(const Coord& c) const {
+                const std::size_t p = pair_of_[c.fi * sp_.slows.size() + c.si];
+                if (p == npos) return npos;
+                return (p * sp_.rocs.size() + c.ri) * sp_.threshes.size() + c.ti;
+            }
+
+            RocSmaParams params(std::size_t idx) const {
+                const Coord c = coord(idx);
+                return { sp_.fasts[c.fi], sp_.slows[c.si], sp_.rocs[c.ri], sp_.threshes[c.ti] };
+            }
+
+        private:
+            const RocSmaSpace& sp_;
+            std::vector<std::pair<std::size_t, std::size_t>> pairs_;
+            std::vector<std::size_t> pair_of_;
+        };
+
+        // Budget accounting shared by every search. Full-series runs are memoised
+        // and feed the top-K; prefix runs only return a score.
+        class Evaluator {
+        public:
+            Evaluator(const CandleSeries& data, const ComboIndex& ix, std::size_t budget, std::size_t top_k, SearchResult& out)
+                : data_(data), ix_(ix), budget_(budget), top_(top_k), out_(out) {
+            }
+
+            bool exhausted() const { return out_.evaluations >= budget_; }
+            bool seen(std::size_t idx) const { return full_.count(idx) != 0; }
+
+            double on_prefix(std::size_t idx, const CandleSeries& prefix) {
+                if (prefix.size() >= data_.size()) return full(idx);
+                account(prefix.size());
+                const auto [f, s, rlen, th] = ix_.params(idx);
+                RocSmaCrossoverStrategy strat{ f, s, rlen, th };
+                return sweep_score(strat.run(prefix));
+            }
+
+            double full(std::size_t idx) {
+                if (auto it = full_.find(idx); it != full_.end()) return it->second;
+                account(data_.size());
+                const RocSmaParams p = ix_.params(idx);
+                const auto [f, s, rlen, th] = p;
+                RocSmaCrossoverStrategy strat{ f, s, rlen, th };
+                const BacktestResult r = strat.run(data_);
+                const double score = sweep_score(r);
+                full_.emplace(idx, score);
+                top_.push({ score, r, p });
+                return score;
+            }
+
+            const TopK& top() const { return top_; }
+
+        private:
+            void account(std::size_t bars) {
+                ++out_.evaluations;
+                out_.full_run_equivalents += data_.size() ? double(bars) / double(data_.size()) : 0.0;
+            }
+
+            const CandleSeries& data_;
+            const ComboIndex& ix_;
+            std::size_t budget_;
+            TopK top_;
+            SearchResult& out_;
+            std::unordered_map<std::size_t, double> full_;
+        };
+
+        // k distinct indices from [0, n), uniformly.
+        std::vector<std::size_t> sample_distinct(std::size_t n, std::size_t k, std::mt19937_64& rng) {
+            k = std::min(k, n);
+            std::vector<std::size_t> out;
+            if (k * 2 >= n) {                                                           // dense: shuffle and truncate
+                out.resize(n);
+                std::iota(out.begin(), out.end(), std::size_t{ 0 });
+                std::shuffle(out.begin(), out.end(), rng);
+                out.resize(k);
+                return out;
+            }
+            std::unordered_set<std::size_t> taken;                                      // sparse: rejection
+            std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+            out.reserve(k);
+            while (out.size() < k) {
+                const std::size_t idx = pick(rng);
+                if (taken.insert(idx).second) out.push_back(idx);
+            }
+            return out;
+        }
+
+    } // namespace
+
+    std::size_t RocSmaSpace::size() const {
+        return ComboIndex(*this).size();
+    }
+
+    // ---- RandomSearch --------------------------------------------------------
+
+    SearchResult RandomSearch::search(const CandleSeries& data, const RocSmaSpace& space,
+        std::size_t budget, std::size_t top_k) {
+        SearchResult out{};
+        const ComboIndex ix(space);
+        Evaluator ev(data, ix, budget, top_k, out);
+        std::mt19937_64 rng(seed_);
+
+        for (std::size_t idx : sample_distinct(ix.size(), budget, rng)) {
+            if (ev.exhausted()) break;
+            ev.full(idx);
+        }
+        out.top = ev.top().sorted();
+        return out;
+    }
+
+    // ---- SuccessiveHalving / Hyperband ---------------------------------------
+
+    SearchResult SuccessiveHalving::search(const CandleSeries& data, const RocSmaSpace& space,
+        std::size_t budget, std::size_t top_k) {
+        SearchResult out{};
+        const ComboIndex ix(space);
+        Evaluator ev(data, ix, budget, top_k, out);
+        if (ix.size() == 0 || data.size() == 0) return out;
+
+        // Brackets: plain halving runs one bracket with every rung; hyperband also
+        // runs the shorter brackets that start on longer prefixes.
+        const std::size_t first_bracket = hyperband_ ? 0 : rungs_ - 1;
+        const std::size_t brackets = rungs_ - first_bracket;
+
+        for (std::size_t b = rungs_; b-- > first_bracket;) {                            // b = halvings in this bracket
+            if (ev.exhausted()) break;
+            const std::size_t bracket_budget = std::min(budget - out.evaluations, budget / brackets + 1);
+
+            // evaluations = n0 * (1 + 1/eta + ... + 1/eta^b); solve for n0.
+            double per_config = 0.0;
+            for (std::size_t r = 0; r <= b; ++r) per_config += std::pow(double(eta_), -double(r));
+            const std::size_t n0 = std::max<std::size_t>(1, std::size_t(double(bracket_budget) / per_config));
+
+            std::mt19937_64 rng(seed_ + b);
+            std::vector<std::size_t> alive = sample_distinct(ix.size(), n0, rng);
+
+            for (std::size_t r = 0; r <= b && !alive.empty(); ++r) {
+                const double fraction = std::pow(double(eta_), double(r) - double(b));
+                const std::size_t bars = std::max<std::size_t>(1, std::size_t(std::ceil(fraction * double(data.size()))));
+                const CandleSeries prefix = data.prefix(bars);
+
+                std::vector<std::pair<double, std::size_t>> scored;
+                scored.reserve(alive.size());
+                for (std::size_t idx : alive) {
+                    if (ev.exhausted()) break;
+                    scored.push_back({ ev.on_prefix(idx, prefix), idx });
+                }
+                if (r == b) break;                                                      // last rung was the full series
+
+                std::stable_sort(scored.begin(), scored.end(),
+                    [](const auto& a, const auto& c) { return a.first > c.first; });
+                const std::size_t keep = std::max<std::size_t>(1, (alive.size() + eta_ - 1) / eta_);
+                alive.clear();
+                for (std::size_t k = 0; k < scored.size() && k < keep; ++k) alive.push_back(scored[k].second);
+            }
+        }
+        out.top = ev.top().sorted();
+        return out;
+    }
+
+    // ---- GridRefinement ------------------------------------------------------
+
+    SearchResult GridRefinement::search(const CandleSeries& data, const RocSmaSpace& space,
+        std::size_t budget, std::size_t top_k) {
+        SearchResult out{};
+        const ComboIndex ix(space);
+        Evaluator ev(data, ix, budget, top_k, out);
+
+        const std::size_t dims[4] = { space.fasts.size(), space.slows.size(), space.rocs.size(), space.threshes.size() };
+        for (std::size_t d : dims) if (d == 0) return out;
+
+        // Coarse pass: every stride-th value per axis, always including the last one.
+        std::vector<std::size_t> axis[4];
+        for (int a = 0; a < 4; ++a) {
+            for (std::size_t i = 0; i < dims[a]; i += stride_) axis[a].push_back(i);
+            if (axis[a].back() != dims[a] - 1) axis[a].push_back(dims[a] - 1);
+        }
+        auto try_coord = [&](const ComboIndex::Coord& c) {
+            const std::size_t idx = ix.flat(c);
+            if (idx == npos || ev.seen(idx) || ev.exhausted()) return false;
+            ev.full(idx);
+            return true;
+        };
+        for (auto fi : axis[0]) for (auto si : axis[1]) for (auto ri : axis[2]) for (auto ti : axis[3])
+            try_coord({ fi, si, ri, ti });
+
+        // Refinement: 3^4 neighbourhood around each top-K centre at a halving step.
+        // Once the step reaches 1, keep polishing while it still finds new combos.
+        auto around = [&](std::size_t c, std::size_t step, std::size_t dim) {
+            std::vector<std::size_t> v{ c };
+            if (c >= step) v.push_back(c - step);
+            if (c + step < dim) v.push_back(c + step);
+            return v;
+        };
+        std::size_t step = stride_;
+        while (!ev.exhausted()) {
+            step = std::max<std::size_t>(1, step / 2);
+            bool grew = false;
+            for (const SweepRow& row : ev.top().sorted()) {
+                const auto& [f, s, rlen, th] = row.p;
+                const ComboIndex::Coord c{
+                    std::size_t(std::find(space.fasts.begin(), space.fasts.end(), f) - space.fasts.begin()),
+                    std::size_t(std::find(space.slows.begin(), space.slows.end(), s) - space.slows.begin()),
+                    std::size_t(std::find(space.rocs.begin(), space.rocs.end(), rlen) - space.rocs.begin()),
+                    std::size_t(std::find(space.threshes.begin(), space.threshes.end(), th) - space.threshes.begin()) };
+                for (auto fi : around(c.fi, step, dims[0])) for (auto si : around(c.si, step, dims[1]))
+                    for (auto ri : around(c.ri, step, dims[2])) for (auto ti : around(c.ti, step, dims[3]))
+                        grew |= try_coord({ fi, si, ri, ti });
+            }
+            if (step == 1 && !grew) break;
+        }
+        out.top = ev.top().sorted();
+        return out;
+    }
+
+    SearchPtr make_search(const std::string& name, std::uint64_t seed) {
+        if (name == "random") return std::make_shared<RandomSearch>(seed);
+        if (name == "halving") return std::make_shared<SuccessiveHalving>(seed);
+        if (name == "hyperband") return std::make_shared<SuccessiveHalving>(seed, 3, 3, true);
+        if (name == "refine") return std::make_shared<GridRefinement>();
+        throw std::runtime_error("Unknown search strategy: " + name);
+    }
+
+} // namespace sugar
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sweep.h"
+
+namespace sugar {
+
+    // The parameter space sweep_roc_sma walks exhaustively. Combos with
+    // fast >= slow are invalid and never evaluated, exactly as in the sweep.
+    struct RocSmaSpace {
+        std::vector<std::size_t> fasts;
+        std::vector<std::size_t> slows;
+        std::vector<std::size_t> rocs;
+        std::vector<double> threshes;
+
+        std::size_t size() const;                                           // number of valid combos
+    };
+
+    struct SearchResult {
+        std::vector<SweepRow> top;                                          // best first, always scored on the full series
+        std::size_t evaluations{};                                          // strategy runs, whatever data length they used
+        double full_run_equivalents{};                                      // runs weighted by the fraction of bars they saw
+    };
+
+    // Pluggable search over a RocSmaSpace. `budget` caps strategy runs
+    // (evaluations); every strategy stops early once the budget is spent.
+    class ISearchStrategy {
+    public:
+        virtual ~ISearchStrategy() = default;
+        virtual const char* name() const = 0;
+        virtual SearchResult search(const CandleSeries& data, const RocSmaSpace& space,
+            std::size_t budget, std::size_t top_k) = 0;
+    };
+
+    using SearchPtr = std::shared_ptr<ISearchStrategy>;
+
+    // Uniform sampling of valid combos without replacement.
+    class RandomSearch final : public ISearchStrategy {
+    public:
+        explicit RandomSearch(std::uint64_t seed) : seed_(seed) {}
+        const char* name() const override { return "random"; }
+        SearchResult search(const CandleSeries& data, const RocSmaSpace& space,
+            std::size_t budget, std::size_t top_k) override;
+    private:
+        std::uint64_t seed_;
+    };
+
+    // Successive halving on growing data prefixes: score many random combos on
+    // a short prefix, keep the best 1/eta, grow the prefix by eta, repeat until
+    // the survivors are scored on the full series. With hyperband = true the
+    // budget is split over brackets that start at different prefix lengths,
+    // hedging against rankings that only settle late in the history.
+    class SuccessiveHalving final : public ISearchStrategy {
+    public:
+        SuccessiveHalving(std::uint64_t seed, std::size_t eta = 3, std::size_t rungs = 3, bool hyperband = false)
+            : seed_(seed), eta_(eta < 2 ? 2 : eta), rungs_(rungs < 1 ? 1 : rungs), hyperband_(hyperband) {
+        }
+        const char* name() const override { return hyperband_ ? "hyperband" : "halving"; }
+        SearchResult search(const CandleSeries& data, const RocSmaSpace& space,
+            std::size_t budget, std::size_t top_k) override;
+    private:
+        std::uint64_t seed_;
+        std::size_t eta_;
+        std::size_t rungs_;
+        bool hyperband_;
+    };
+
+    // Coarse-to-fine grid: evaluate every `stride`-th value on each axis, then
+    // repeatedly re-grid the neighbourhood of the current top-K at half the step.
+    class GridRefinement final : public ISearchStrategy {
+    public:
+        explicit GridRefinement(std::size_t stride = 4) : stride_(stride < 1 ? 1 : stride) {}
+        const char* name() const override { return "refine"; }
+        SearchResult search(const CandleSeries& data, const RocSmaSpace& space,
+            std::size_t budget, std::size_t top_k) override;
+    private:
+        std::size_t stride_;
+    };
+
+    // "random" | "halving" | "hyperband" | "refine"; throws on anything else.
+    SearchPtr make_search(const std::string& name, std::uint64_t seed = 42);
+
+} // namespace sugar
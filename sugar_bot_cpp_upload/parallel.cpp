@@ -0,0 +1,49 @@
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sugar {
+
+    std::size_t resolve_threads(std::size_t requested) {
+        if (requested > 0) return requested;
+        const unsigned hw = std::thread::hardware_concurrency();
+        return hw > 0 ? hw : 1;
+    }
+
+    void parallel_for(std::size_t n, std::size_t threads, const std::function<void(std::size_t)>& fn) {
+        if (n == 0) return;
+        threads = std::min(resolve_threads(threads), n);
+        if (threads == 1) {                                             // no thread start-up for the serial case
+            for (std::size_t i = 0; i < n; ++i) fn(i);
+            return;
+        }
+
+        std::atomic<std::size_t> next{ 0 };
+        std::atomic<bool> failed{ false };
+        std::exception_ptr error;
+        std::mutex error_mu;
+
+        auto worker = [&]() {
+            for (std::size_t i; !failed.load(std::memory_order_relaxed) && (i = next.fetch_add(1)) < n;) {
+                try { fn(i); }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mu);
+                    if (!error) error = std::current_exception();
+                    failed = true;
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (std::size_t t = 1; t < threads; ++t) pool.emplace_back(worker);
+        worker();                                                       // the calling thread works too
+        for (auto& th : pool) th.join();
+        if (error) std::rethrow_exception(error);
+    }
+
+} // namespace sugar
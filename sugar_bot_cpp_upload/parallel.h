@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace sugar {
+
+    // Number of worker threads to use for `requested` (0 = one per hardware thread).
+    std::size_t resolve_threads(std::size_t requested);
+
+    // Calls fn(i) for every i in [0, n) on up to `threads` threads (0 = hardware
+    // concurrency). Items are handed out one at a time from a shared counter, so
+    // uneven item costs balance themselves. Blocks until all items are done; the
+    // first exception thrown by fn stops further items and is rethrown here.
+    void parallel_for(std::size_t n, std::size_t threads, const std::function<void(std::size_t)>& fn);
+
+} // namespace sugar
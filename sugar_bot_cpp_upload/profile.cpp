@@ -0,0 +1,138 @@
+#include "profile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace sugar::prof {
+
+    std::atomic<bool> g_recording{ false };
+
+    namespace {
+
+        thread_local std::uint64_t t_bytes = 0, t_allocs = 0;
+
+        struct Registry {
+            std::mutex mu;
+            std::vector<std::unique_ptr<Stage>> stages;
+            std::string json_path;
+            std::chrono::steady_clock::time_point t0;
+        };
+
+        Registry& registry() {
+            static Registry* r = new Registry;                          // never destroyed: probes may fire during static destruction
+            return *r;
+        }
+
+        // Snapshot sorted by total time, so the report reads top-down.
+        std::vector<const Stage*> sorted_stages() {
+            auto& r = registry();
+            std::lock_guard<std::mutex> lock(r.mu);
+            std::vector<const Stage*> out;
+            for (const auto& s : r.stages) if (s->calls.load()) out.push_back(s.get());
+            std::sort(out.begin(), out.end(), [](const Stage* a, const Stage* b) { return a->ns.load() > b->ns.load(); });
+            return out;
+        }
+
+        double wall_seconds() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - registry().t0).count();
+        }
+
+        void dump_at_exit() {
+            g_recording.store(false);
+            const auto& path = registry().json_path;
+            std::ofstream out(path);
+            if (out) write_json(out);
+            else std::cerr << "[profile] failed to write " << path << "\n";
+            write_table(std::cerr);
+            std::cerr << "[profile] wrote " << path << "\n";
+        }
+
+    } // namespace
+
+    std::uint64_t thread_alloc_bytes() { return t_bytes; }
+    std::uint64_t thread_allocs() { return t_allocs; }
+
+    Stage& stage(const char* name) {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mu);
+        for (const auto& s : r.stages)
+            if (std::string_view(s->name) == name) return *s;
+        r.stages.push_back(std::make_unique<Stage>(name));
+        return *r.stages.back();
+    }
+
+    bool enable(const std::string& json_path) {
+        if (!kCompiledIn) return false;
+        auto& r = registry();
+        const bool first = r.json_path.empty();
+        r.json_path = json_path;
+        r.t0 = std::chrono::steady_clock::now();
+        if (first) std::atexit(dump_at_exit);
+        g_recording.store(true);
+        return true;
+    }
+
+    void write_json(std::ostream& out) {
+        const auto stages = sorted_stages();
+        out << "{\n  \"profile\": \"sugar\",\n  \"version\": 1,\n  \"wall_seconds\": " << wall_seconds() << ",\n  \"stages\": [\n";
+        for (std::size_t i = 0; i < stages.size(); ++i) {
+            const Stage& s = *stages[i];
+            const auto calls = s.calls.load(), ns = s.ns.load();
+            out << "    {\"name\": \"" << s.name << "\", \"calls\": " << calls << ", \"total_ms\": " << double(ns) / 1e6
+                << ", \"mean_us\": " << (calls ? double(ns) / 1e3 / double(calls) : 0.0) << ", \"items\": " << s.items.load()
+                << ", \"bytes_allocated\": " << s.bytes.load() << ", \"allocations\": " << s.allocs.load() << "}"
+                << (i + 1 < stages.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+
+    void write_table(std::ostream& out) {
+        const auto stages = sorted_stages();
+        const double wall = wall_seconds();
+        const auto flags = out.flags();
+        out << "[profile] " << std::fixed << std::setprecision(3) << wall << "s wall (inclusive times, summed over threads)\n"
+            << "  " << std::left << std::setw(26) << "stage" << std::right << std::setw(11) << "calls" << std::setw(12) << "total ms"
+            << std::setw(8) << "% wall" << std::setw(11) << "mean us" << std::setw(12) << "alloc MB" << std::setw(11) << "allocs" << "\n";
+        for (const Stage* s : stages) {
+            const auto calls = s->calls.load(), ns = s->ns.load();
+            out << "  " << std::left << std::setw(26) << s->name << std::right << std::setw(11) << calls
+                << std::setw(12) << std::setprecision(1) << double(ns) / 1e6
+                << std::setw(8) << (wall > 0 ? double(ns) / 1e7 / wall : 0.0)
+                << std::setw(11) << std::setprecision(2) << (calls ? double(ns) / 1e3 / double(calls) : 0.0)
+                << std::setw(12) << double(s->bytes.load()) / 1e6 << std::setw(11) << s->allocs.load() << "\n";
+        }
+        out.flags(flags);
+    }
+
+} // namespace sugar::prof
+
+#if SUGAR_PROFILE
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"                // free() of blocks our operator new got from malloc()
+#endif
+
+// Allocation accounting: every plain new/delete goes through here when the
+// probes are compiled in. Aligned and nothrow forms keep the library's own.
+
+void* operator new(std::size_t n) {
+    ++sugar::prof::t_allocs;
+    sugar::prof::t_bytes += n;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n) { return ::operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+#endif
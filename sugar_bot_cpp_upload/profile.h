@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Hot-path instrumentation. Build with SUGAR_PROFILE=1 (CMake option
+// SUGAR_PROFILE) to compile the probes in; otherwise every SUGAR_PROF_*
+// macro expands to nothing. Compiled in, probes still cost one relaxed load
+// until enable() turns recording on (sugar_Bot --profile PATH).
+//
+//   SUGAR_PROF_SCOPE("indicator/sma");        // time, calls, bytes allocated until end of scope
+//   SUGAR_PROF_COUNT("sweep/combos", n);      // calls += 1, items += n
+//
+// Times and allocations are inclusive: a strategy run's stage also contains
+// the indicator stages it calls. Allocations are counted by a replaced global
+// operator new, per thread, so parallel stages do not see each other's.
+
+#ifndef SUGAR_PROFILE
+#define SUGAR_PROFILE 0
+#endif
+
+namespace sugar::prof {
+
+    struct Stage {
+        const char* name;
+        std::atomic<std::uint64_t> calls{ 0 }, ns{ 0 }, items{ 0 };
+        std::atomic<std::uint64_t> bytes{ 0 }, allocs{ 0 };
+        explicit Stage(const char* n) : name(n) {}
+    };
+
+    inline constexpr bool kCompiledIn = SUGAR_PROFILE != 0;
+
+    extern std::atomic<bool> g_recording;
+
+    Stage& stage(const char* name);                                     // registered once per name; call sites keep the reference
+
+    // Starts recording; at exit the summary is written as JSON to `json_path`
+    // and as a table to stderr. Returns false when built without SUGAR_PROFILE.
+    bool enable(const std::string& json_path);
+
+    void write_json(std::ostream& out);
+    void write_table(std::ostream& out);
+
+    std::uint64_t thread_alloc_bytes();                                 // bytes / calls through operator new on this thread
+    std::uint64_t thread_allocs();
+
+    class Scope {
+    public:
+        explicit Scope(Stage& s) {
+            if (!g_recording.load(std::memory_order_relaxed)) return;
+            stage_ = &s;
+            bytes0_ = thread_alloc_bytes(); allocs0_ = thread_allocs();
+            t0_ = std::chrono::steady_clock::now();
+        }
+        ~Scope() {
+            if (!stage_) return;
+            const auto dt = std::chrono::steady_clock::now() - t0_;
+            stage_->ns.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count()), std::memory_order_relaxed);
+            stage_->calls.fetch_add(1, std::memory_order_relaxed);
+            stage_->bytes.fetch_add(thread_alloc_bytes() - bytes0_, std::memory_order_relaxed);
+            stage_->allocs.fetch_add(thread_allocs() - allocs0_, std::memory_order_relaxed);
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Stage* stage_ = nullptr;
+        std::uint64_t bytes0_ = 0, allocs0_ = 0;
+        std::chrono::steady_clock::time_point t0_{};
+    };
+
+    inline void count(Stage& s, std::uint64_t n) {
+        if (!g_recording.load(std::memory_order_relaxed)) return;
+        s.calls.fetch_add(1, std::memory_order_relaxed);
+        s.items.fetch_add(n, std::memory_order_relaxed);
+    }
+
+} // namespace sugar::prof
+
+#define SUGAR_PROF_CAT_(a, b) a##b
+#define SUGAR_PROF_CAT(a, b) SUGAR_PROF_CAT_(a, b)
+
+#if SUGAR_PROFILE
+#define SUGAR_PROF_SCOPE(name)                                                                          \
+    static ::sugar::prof::Stage& SUGAR_PROF_CAT(sugar_prof_stage_, __LINE__) = ::sugar::prof::stage(name); \
+    ::sugar::prof::Scope SUGAR_PROF_CAT(sugar_prof_scope_, __LINE__)(SUGAR_PROF_CAT(sugar_prof_stage_, __LINE__))
+#define SUGAR_PROF_COUNT(name, n)                                                                       \
+    do { static ::sugar::prof::Stage& sugar_prof_stage_ = ::sugar::prof::stage(name);                   \
+         ::sugar::prof::count(sugar_prof_stage_, static_cast<std::uint64_t>(n)); } while (0)
+#else
+#define SUGAR_PROF_SCOPE(name) ((void)0)
+#define SUGAR_PROF_COUNT(name, n) ((void)0)
+#endif
@@ -0,0 +1,48 @@
+#include "prune.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sugar {
+
+    static constexpr double kInf = std::numeric_limits<double>::infinity();
+
+    PruneBounds::PruneBounds(const std::vector<double>& closes)
+        : closes_(closes), up_moves_(closes.size(), 0.0), min_close_(closes.size(), kInf) {
+        const std::size_t n = closes.size();
+        if (n == 0) return;
+
+        // Suffix scans; a NaN anywhere in the tail poisons the bound to +inf below.
+        min_close_[n - 1] = closes[n - 1];
+        for (std::size_t i = n - 1; i-- > 0;) {
+            const double move = closes[i + 1] - closes[i];
+            up_moves_[i] = up_moves_[i + 1] + (move > 0.0 ? move : 0.0);
+            if (std::isnan(move)) up_moves_[i] = kInf;
+            min_close_[i] = std::min(closes[i], min_close_[i + 1]);
+            if (std::isnan(closes[i])) min_close_[i] = -kInf;
+        }
+    }
+
+    double PruneBounds::max_final_equity(std::size_t i, double equity, bool long_on, double entry) const {
+        if (i >= up_moves_.size()) return kInf;
+
+        double floor_price = min_close_[i];
+        double bound = equity;
+        if (long_on) {
+            // Open trade: what is already on the books plus every later up-move, measured against entry.
+            if (!(entry > 0.0)) return kInf;
+            bound += (closes_[i] / entry - 1.0) * 100.0;
+            floor_price = std::min(floor_price, entry);
+        }
+        if (!(floor_price > 0.0) || !std::isfinite(up_moves_[i])) return kInf;
+        return bound + up_moves_[i] / floor_price * 100.0;
+    }
+
+    bool PruneLimit::hopeless(std::size_t i, double equity, bool long_on, double entry, double max_drawdown) const {
+        if (!bounds || !std::isfinite(min_score)) return false;
+        const double best_case = bounds->max_final_equity(i, equity, long_on, entry) - dd_weight * max_drawdown;
+        if (!std::isfinite(best_case)) return false;
+        const double margin = 1e-9 * (1.0 + std::fabs(min_score));
+        return best_case < min_score - margin;
+    }
+
+} // namespace sugar
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace sugar {
+
+    // Optimistic bound on what a long-only, close-to-close strategy can still
+    // earn from bar i onward. Every trade return is measured in % of its entry
+    // close, so the sum of any set of non-overlapping future trades is at most
+    // (sum of positive close moves after i) / (lowest close from i on) * 100.
+    // Built once per series and shared by every run of a sweep.
+    class PruneBounds {
+    public:
+        PruneBounds() = default;
+        explicit PruneBounds(const std::vector<double>& closes);
+
+        bool empty() const { return up_moves_.empty(); }
+
+        // Upper bound on the final equity of a run whose state after bar i is
+        // (equity, long_on, entry). Returns +inf when no finite bound exists
+        // (non-positive or non-finite prices).
+        double max_final_equity(std::size_t i, double equity, bool long_on, double entry) const;
+
+    private:
+        std::vector<double> closes_;
+        std::vector<double> up_moves_;                                              // sum of max(0, c[t] - c[t-1]) for t > i
+        std::vector<double> min_close_;                                             // min c[t] for t >= i
+    };
+
+    // Early-exit contract handed to a strategy run during a pruning sweep.
+    // A run stops as soon as max_final_equity - dd_weight * max_drawdown drops
+    // below min_score: drawdown never shrinks, so the final score cannot recover.
+    struct PruneLimit {
+        const PruneBounds* bounds = nullptr;
+        double min_score = -std::numeric_limits<double>::infinity();               // live K-th best score
+        double dd_weight = 0.25;                                                    // must match the sweep's score
+        std::size_t check_every = 32;                                               // bars between bound checks
+
+        // True when the best reachable score is strictly below min_score
+        // (with a relative margin so FP rounding can never flip a top-K entry).
+        bool hopeless(std::size_t i, double equity, bool long_on, double entry, double max_drawdown) const;
+    };
+
+} // namespace sugar
@@ -0,0 +1,87 @@
+// sugar_query: re-rank a sweep's result store without re-running backtests.
+//
+//   sugar_query FILE [--top K] [--pareto]
+//                    [--score pnl:1,dd:-0.25,trades:0,calmar:0]
+//                    [--min-pnl X] [--max-dd X] [--min-trades N] [--include-pruned]
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "results_store.h"
+
+
+// "pnl:1,dd:-0.25" -> weights; unnamed terms are an error.
+static sugar::ScoreSpec parse_score(const std::string& spec) {
+	sugar::ScoreSpec s{ 0.0, 0.0, 0.0, 0.0 };
+	std::stringstream ss(spec);
+	std::string term;
+	while (std::getline(ss, term, ',')) {
+		const auto colon = term.find(':');
+		if (colon == std::string::npos) throw std::runtime_error("Bad score term (want name:weight): " + term);
+		const std::string name = term.substr(0, colon);
+		const double w = std::stod(term.substr(colon + 1));
+		if (name == "pnl") s.w_pnl = w;
+		else if (name == "dd") s.w_dd = w;
+		else if (name == "trades") s.w_trades = w;
+		else if (name == "calmar") s.w_calmar = w;
+		else throw std::runtime_error("Unknown score term: " + name);
+	}
+	return s;
+}
+
+
+static void print_row(const sugar::ResultColumns& c, std::size_t i, double score) {
+	std::cout << "  score=" << score
+		<< " | fast=" << c.fast[i] << " slow=" << c.slow[i]
+		<< " roc=" << c.roc[i] << " thresh=" << c.thresh[i]
+		<< " | PnL=" << c.pnl[i] << "%, DD=" << c.max_drawdown[i]
+		<< "%, Trades=" << c.trades[i] << ((c.flags[i] & 1) ? " (pruned)" : "") << "\n";
+}
+
+
+int main(int argc, char** argv) {
+	try {
+		std::string path;
+		std::size_t k = 10;
+		bool pareto = false;
+		sugar::ScoreSpec score{};
+		sugar::ResultFilter keep{};
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			auto value = [&]() -> std::string {
+				if (i + 1 >= argc) throw std::runtime_error("Missing value for " + std::string(arg));
+				return argv[++i];
+			};
+			if (arg == "--top") k = std::stoull(value());
+			else if (arg == "--pareto") pareto = true;
+			else if (arg == "--score") score = parse_score(value());
+			else if (arg == "--min-pnl") keep.min_pnl = std::stod(value());
+			else if (arg == "--max-dd") keep.max_dd = std::stod(value());
+			else if (arg == "--min-trades") keep.min_trades = std::stoull(value());
+			else if (arg == "--include-pruned") keep.include_pruned = true;
+			else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Unknown option: " + std::string(arg));
+			else path = arg;
+		}
+		if (path.empty()) throw std::runtime_error("Usage: sugar_query FILE [--top K] [--pareto] [--score ...]");
+
+		auto t0 = std::chrono::steady_clock::now();
+		const auto cols = sugar::load_result_store(path);
+		auto t1 = std::chrono::steady_clock::now();
+		const auto rows = pareto ? sugar::query_pareto(cols, keep) : sugar::query_top_k(cols, score, keep, k);
+		auto t2 = std::chrono::steady_clock::now();
+
+		std::cout << (pareto ? "Pareto front (max PnL, min DD):\n" : "Top rows:\n");
+		for (std::size_t i : rows) print_row(cols, i, score(cols, i));
+		std::cerr << "[query] " << cols.size() << " rows; load "
+			<< std::chrono::duration<double>(t1 - t0).count() << "s, query "
+			<< std::chrono::duration<double>(t2 - t1).count() << "s\n";
+		return 0;
+	}
+	catch (const std::exception& ex) {
+		std::cerr << "Error: " << ex.what() << "\n"; return 1;
+	}
+}
@@ -0,0 +1,161 @@
+// sugar_queue_bench: feed-thread -> strategy-thread handoff through the SPSC bar ring.
+//
+//   sugar_queue_bench [--bars N] [--latency-bars N] [--capacity N] [--wait spin,yield,futex]
+//
+// For each wait mode:
+//   latency    - bars sent one at a time (the next only after the previous was taken),
+//                histogram of push -> pop time
+//   throughput - bars pushed back to back, bars/s through the ring at saturation
+// A mutex + condition_variable queue is measured the same way for comparison.
+// Spin mode wants two idle cores; on one core every handoff waits for a time slice.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "latency.h"
+#include "spsc.h"
+#include "stream.h"
+
+
+using bench_clock = sugar::StreamClock;
+
+
+// Baseline: the obvious locked queue, same push/pop/close surface as SpscRing.
+class LockedQueue {
+public:
+	explicit LockedQueue(std::size_t capacity) : cap_(capacity) {}
+	void push(const sugar::TimedBar& v) {
+		std::unique_lock<std::mutex> lock(mu_);
+		not_full_.wait(lock, [&] { return q_.size() < cap_; });
+		q_.push_back(v);
+		not_empty_.notify_one();
+	}
+	bool pop(sugar::TimedBar& out) {
+		std::unique_lock<std::mutex> lock(mu_);
+		not_empty_.wait(lock, [&] { return closed_ || !q_.empty(); });
+		if (q_.empty()) return false;
+		out = q_.front(); q_.pop_front();
+		not_full_.notify_one();
+		return true;
+	}
+	void close() {
+		std::lock_guard<std::mutex> lock(mu_);
+		closed_ = true;
+		not_empty_.notify_all();
+	}
+private:
+	std::size_t cap_;
+	std::mutex mu_;
+	std::condition_variable not_full_, not_empty_;
+	std::deque<sugar::TimedBar> q_;
+	bool closed_ = false;
+};
+
+
+static sugar::TimedBar make_bar(std::size_t i) {
+	sugar::TimedBar tb;
+	tb.bar.date = 20000101 + static_cast<int>(i % 1000000);
+	tb.bar.open = tb.bar.high = tb.bar.low = tb.bar.close = 100.0 + static_cast<double>(i % 97);
+	return tb;
+}
+
+
+// One bar in flight at a time: measures the handoff itself, not queueing.
+template <class Queue>
+static sugar::LatencyHistogram bench_latency(Queue& q, std::size_t n) {
+	sugar::LatencyHistogram h;
+	std::atomic<std::size_t> taken{ 0 };
+	std::thread consumer([&]() {
+		sugar::TimedBar tb;
+		while (q.pop(tb)) {
+			const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - tb.arrived).count();
+			h.record(static_cast<std::uint64_t>(ns < 0 ? 0 : ns));
+			taken.fetch_add(1, std::memory_order_release);
+		}
+	});
+	for (std::size_t i = 0; i < n; ++i) {
+		sugar::TimedBar tb = make_bar(i);
+		tb.arrived = bench_clock::now();
+		q.push(tb);
+		while (taken.load(std::memory_order_acquire) <= i) std::this_thread::yield();
+	}
+	q.close();
+	consumer.join();
+	return h;
+}
+
+
+// Back to back: bars/s the queue sustains when the consumer only folds the close.
+template <class Queue>
+static double bench_throughput(Queue& q, std::size_t n, double& checksum) {
+	const auto t0 = bench_clock::now();
+	std::thread producer([&]() {
+		for (std::size_t i = 0; i < n; ++i) q.push(make_bar(i));
+		q.close();
+	});
+	sugar::TimedBar tb;
+	double sum = 0.0;
+	while (q.pop(tb)) sum += tb.bar.close;
+	producer.join();
+	checksum = sum;
+	const double secs = std::chrono::duration<double>(bench_clock::now() - t0).count();
+	return secs > 0.0 ? static_cast<double>(n) / secs : 0.0;
+}
+
+
+int main(int argc, char** argv) {
+	try {
+		std::size_t bars = 5000000, latency_bars = 100000, capacity = 1024;
+		std::vector<sugar::WaitMode> modes{ sugar::WaitMode::Spin, sugar::WaitMode::SpinYield, sugar::WaitMode::Futex };
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			auto value = [&]() -> std::string {
+				if (i + 1 >= argc) throw std::runtime_error("Missing value for " + std::string(arg));
+				return argv[++i];
+			};
+			if (arg == "--bars") bars = std::stoull(value());
+			else if (arg == "--latency-bars") latency_bars = std::stoull(value());
+			else if (arg == "--capacity") capacity = std::stoull(value());
+			else if (arg == "--wait") {
+				modes.clear();
+				std::stringstream ss(value());
+				std::string m;
+				while (std::getline(ss, m, ',')) modes.push_back(sugar::parse_wait_mode(m));
+			}
+			else throw std::runtime_error("Unknown option: " + std::string(arg));
+		}
+
+		std::cout << "Bar handoff, " << capacity << " slots, " << sizeof(sugar::TimedBar) << "-byte bars, "
+			<< std::thread::hardware_concurrency() << " hardware threads\n";
+		auto report = [&](const std::string& name, const sugar::LatencyHistogram& h, double rate, double checksum) {
+			std::cout << " " << name << "\n   latency:    " << h.summary() << "\n   throughput: "
+				<< rate / 1e6 << " M bars/s (checksum " << checksum << ")\n";
+		};
+		for (const auto mode : modes) {
+			sugar::SpscRing<sugar::TimedBar> lat_q(capacity, mode), thr_q(capacity, mode);
+			const auto h = bench_latency(lat_q, latency_bars);
+			double checksum = 0.0;
+			const double rate = bench_throughput(thr_q, bars, checksum);
+			report(std::string("spsc/") + sugar::wait_mode_name(mode), h, rate, checksum);
+		}
+		LockedQueue lat_q(capacity), thr_q(capacity);
+		const auto h = bench_latency(lat_q, latency_bars);
+		double checksum = 0.0;
+		const double rate = bench_throughput(thr_q, bars, checksum);
+		report("mutex+condvar", h, rate, checksum);
+		return 0;
+	}
+	catch (const std::exception& ex) {
+		std::cerr << "Error: " << ex.what() << "\n"; return 1;
+	}
+}
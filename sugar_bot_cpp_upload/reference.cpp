@@ -0,0 +1,212 @@
+#include "reference.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace sugar::ref {
+
+    namespace {
+
+        constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+        // Equity, drawdown and the marked path, shared by both strategies.
+        struct Book {
+            Run run;
+            bool long_on = false;
+            double entry = 0.0, equity = 0.0, peak = 0.0;
+            std::size_t entry_bar = 0;
+
+            void open(std::size_t i, double price) { long_on = true; entry = price; entry_bar = i; }
+            void close(std::size_t i, double price) {
+                const double ret = (price / entry - 1.0) * 100.0;
+                equity += ret; ++run.result.trades;
+                peak = std::max(peak, equity);
+                run.result.max_drawdown = std::max(run.result.max_drawdown, peak - equity);
+                run.trades.push_back({ entry_bar, i, ret });
+                long_on = false;
+            }
+            void mark(double close) { run.marked.push_back(equity + (long_on ? (close / entry - 1.0) * 100.0 : 0.0)); }
+            Run finish(const std::vector<double>& closes) {
+                if (long_on) close(closes.size() - 1, closes.back());
+                run.result.pnl = equity;
+                run.result.risk = risk_of(run.marked, run.trades);
+                return std::move(run);
+            }
+        };
+
+    } // namespace
+
+    std::vector<double> sma(const std::vector<double>& v, std::size_t n) {
+        std::vector<double> out(v.size(), kNaN);
+        if (n == 0 || v.size() < n) return out;
+        double window_sum = std::accumulate(v.begin(), v.begin() + n, 0.0);
+        out[n - 1] = window_sum / static_cast<double>(n);
+        for (std::size_t i = n; i < v.size(); ++i) {
+            window_sum += v[i] - v[i - n];
+            out[i] = window_sum / static_cast<double>(n);
+        }
+        return out;
+    }
+
+    std::vector<double> ema(const std::vector<double>& v, std::size_t n) {
+        std::vector<double> out(v.size(), kNaN);
+        if (n == 0 || v.size() < n) return out;
+        const double alpha = 2.0 / (static_cast<double>(n) + 1.0);
+        out[n - 1] = std::accumulate(v.begin(), v.begin() + n, 0.0) / static_cast<double>(n);
+        for (std::size_t i = n; i < v.size(); ++i) out[i] = alpha * v[i] + (1.0 - alpha) * out[i - 1];
+        return out;
+    }
+
+    std::vector<double> ema_indicator(const std::vector<double>& v, std::size_t n) {
+        if (n == 0 || v.empty() || v.size() >= n) return ema(v, n);
+        const double alpha = 2.0 / (static_cast<double>(n) + 1.0);
+        std::vector<double> out(v.size());
+        out[0] = v[0];
+        for (std::size_t i = 1; i < v.size(); ++i) out[i] = alpha * v[i] + (1.0 - alpha) * out[i - 1];
+        return out;
+    }
+
+    std::vector<double> roc(const std::vector<double>& v, std::size_t k) {
+        std::vector<double> out(v.size(), kNaN);
+        if (k == 0 || v.size() <= k) return out;
+        for (std::size_t i = k; i < v.size(); ++i) {
+            const double prev = v[i - k];
+            if (prev == 0.0 || !std::isfinite(prev) || !std::isfinite(v[i])) continue;
+            out[i] = (v[i] / prev - 1.0) * 100.0;
+        }
+        return out;
+    }
+
+    Run diff_cross(const CandleSeries& data, const std::vector<double>& a, const std::vector<double>& b, double thresh) {
+        const auto closes = data.closes();
+        Book book;
+        std::size_t i0 = 0;
+        while (i0 < closes.size() && (std::isnan(a[i0]) || std::isnan(b[i0]))) ++i0;
+        if (i0 == closes.size()) return {};
+        book.run.result.best_start_date = data[i0].date;
+        for (std::size_t i = i0; i < closes.size(); ++i) {
+            const double diff = a[i] - b[i];
+            if (!book.long_on && diff >= thresh) book.open(i, closes[i]);
+            else if (book.long_on && diff <= -thresh) book.close(i, closes[i]);
+            book.mark(closes[i]);
+        }
+        return book.finish(closes);
+    }
+
+    Run roc_sma(const CandleSeries& data, std::size_t fast, std::size_t slow, std::size_t roc_len, double thresh) {
+        if (data.size() == 0 || fast == 0 || slow == 0 || roc_len == 0) return {};
+        const auto closes = data.closes();
+        return diff_cross(data, roc(sma(closes, fast), roc_len), roc(sma(closes, slow), roc_len), thresh);
+    }
+
+    Run swing_breakout(const CandleSeries& data, std::size_t left, std::size_t right, bool use_ema10_stop,
+        int days_above_10_required, double pct_gain_threshold, int days_for_gain, double max_loss_pct) {
+        const std::size_t n = data.size();
+        if (n == 0) return {};
+        const auto closes = data.closes();
+        const auto ema10 = ema_indicator(closes, 10);
+        Book book;
+        int first_signal_date = 0;
+
+        bool trend_up = false, bo_flagged = false, validation_passed = false;
+        double last_swing_high = kNaN, breakout_low = kNaN, breakout_price = kNaN, entry_price = kNaN;
+        int breakout_bar = -1, days_above_10 = 0;
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const double close = closes[i], high = data[i].high, low = data[i].low;
+            bool is_breakout = false, is_swing_failure = false;
+
+            // pivot high at p = i - right, confirmed now (ta.pivothigh)
+            if (right > 0 && i >= right && i - right >= left) {
+                const std::size_t p = i - right;
+                bool pivot = true;
+                for (std::size_t j = p - left; j <= i; ++j)
+                    if (j != p && data[j].high >= data[p].high) { pivot = false; break; }
+                if (pivot) {
+                    last_swing_high = data[p].high;
+                    if (!trend_up) bo_flagged = false;
+                }
+            }
+
+            if (trend_up && !std::isnan(entry_price) && (entry_price - close) / entry_price * 100.0 >= max_loss_pct)
+                is_swing_failure = true;
+            if (trend_up && !validation_passed && !std::isnan(breakout_low) && low < breakout_low)
+                is_swing_failure = true;
+            if (trend_up && !validation_passed && breakout_bar >= 0) {
+                days_above_10 = !std::isnan(ema10[i]) && close > ema10[i] ? days_above_10 + 1 : 0;
+                const int bars_since = static_cast<int>(i) - breakout_bar;
+                const double gain = (close - breakout_price) / breakout_price * 100.0;
+                if (days_above_10 >= days_above_10_required && gain >= pct_gain_threshold && bars_since <= days_for_gain)
+                    validation_passed = true;
+            }
+            if (trend_up && use_ema10_stop && !std::isnan(ema10[i]) && close < ema10[i])
+                is_swing_failure = true;
+
+            if (!std::isnan(last_swing_high) && high > last_swing_high && !trend_up && !bo_flagged) {
+                if (close < last_swing_high) is_swing_failure = true;
+                else {
+                    is_breakout = true; trend_up = true; bo_flagged = true;
+                    entry_price = breakout_price = close;
+                    breakout_low = low;
+                    breakout_bar = static_cast<int>(i);
+                    days_above_10 = !std::isnan(ema10[i]) && close > ema10[i] ? 1 : 0;
+                    validation_passed = false;
+                    if (first_signal_date == 0) first_signal_date = data[i].date;
+                }
+            }
+
+            if (is_breakout && !book.long_on) book.open(i, close);
+            if (is_swing_failure && book.long_on) {
+                book.close(i, close);
+                trend_up = bo_flagged = validation_passed = false;
+                breakout_low = breakout_price = entry_price = kNaN;
+                breakout_bar = -1; days_above_10 = 0;
+            }
+            book.mark(close);
+        }
+
+        Run run = book.finish(closes);
+        run.result.best_start_date = first_signal_date;
+        return run;
+    }
+
+    RiskMetrics risk_of(const std::vector<double>& marked, const std::vector<Trade>& trades) {
+        RiskMetrics m{};
+        m.bars = marked.size();
+        double wins = 0.0, gross_win = 0.0, gross_loss = 0.0, hold = 0.0;
+        for (const Trade& t : trades) {
+            hold += static_cast<double>(t.exit_bar - t.entry_bar);
+            if (t.ret > 0.0) { wins += 1.0; gross_win += t.ret; }
+            else gross_loss -= t.ret;
+        }
+        if (!trades.empty()) {
+            const double n = static_cast<double>(trades.size());
+            m.win_rate = 100.0 * wins / n;
+            m.avg_trade = (gross_win - gross_loss) / n;
+            m.avg_hold = hold / n;
+            m.profit_factor = gross_loss > 0.0 ? gross_win / gross_loss
+                : gross_win > 0.0 ? std::numeric_limits<double>::infinity() : 0.0;
+        }
+        if (marked.empty()) return m;
+
+        const double n = static_cast<double>(marked.size());
+        std::vector<double> change(marked.size());
+        std::adjacent_difference(marked.begin(), marked.end(), change.begin());   // change[0] = marked[0] - 0
+        const double mean = std::accumulate(change.begin(), change.end(), 0.0) / n;
+        double var = 0.0, down = 0.0, dd = 0.0, peak = 0.0;
+        for (std::size_t i = 0; i < marked.size(); ++i) {
+            var += (change[i] - mean) * (change[i] - mean);
+            down += std::min(change[i], 0.0) * std::min(change[i], 0.0);
+            peak = std::max(peak, marked[i]);
+            dd += (peak - marked[i]) * (peak - marked[i]);
+        }
+        const double sd = std::sqrt(var / n), dsd = std::sqrt(down / n);
+        m.exposure = 100.0 * hold / n;
+        m.sharpe = sd > 0.0 ? mean / sd : 0.0;
+        m.sortino = dsd > 0.0 ? mean / dsd : 0.0;
+        m.ulcer = std::sqrt(dd / n);
+        return m;
+    }
+
+} // namespace sugar::ref
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "metrics.h"
+#include "series.h"
+
+// Frozen reference kernels for sugar_verify.
+//
+// These are the plain implementations the optimized paths grew out of: one
+// std::vector in, one out, a single loop per rule, no scratch arenas, no
+// blocking, no incremental or cached state. Keep them that way. They define
+// the semantics (NaN warm-up, the zero-divisor rule of ROC, entry/exit
+// bookkeeping) that every fast path is checked against, so a change here is
+// a change of behaviour, not an optimization.
+
+namespace sugar::ref {
+
+    // ---- indicators ----------------------------------------------------------
+
+    std::vector<double> sma(const std::vector<double>& v, std::size_t n);  // NaN until index n-1
+    std::vector<double> ema(const std::vector<double>& v, std::size_t n);  // SMA seed at n-1, then alpha = 2/(n+1)
+    // EMAIndicator::compute: as ema(), except that a series shorter than n
+    // is seeded with its first value (EMAIndicator's documented fallback).
+    std::vector<double> ema_indicator(const std::vector<double>& v, std::size_t n);
+    std::vector<double> roc(const std::vector<double>& v, std::size_t k);  // % change over k; NaN if v[i-k] is 0 or either side non-finite
+
+    // ---- strategies ------------------------------------------------------------
+
+    struct Trade {
+        std::size_t entry_bar{}, exit_bar{};
+        double ret{};                                                   // %
+    };
+
+    struct Run {
+        BacktestResult result;                                          // risk filled by risk_of(marked, trades)
+        std::vector<double> marked;                                     // equity marked to each scored bar's close
+        std::vector<Trade> trades;
+    };
+
+    // Long when a[i] - b[i] >= thresh, flat when it is <= -thresh, from the
+    // first bar where both are defined; an open position closes at the last bar.
+    // RocSmaCrossoverStrategy, DiffCrossStrategy and the equivalent rule.
+    Run diff_cross(const CandleSeries& data, const std::vector<double>& a, const std::vector<double>& b, double thresh);
+
+    Run roc_sma(const CandleSeries& data, std::size_t fast, std::size_t slow, std::size_t roc_len, double thresh);
+
+    Run swing_breakout(const CandleSeries& data, std::size_t left_bars, std::size_t right_bars, bool use_ema10_stop,
+        int days_above_10_required, double pct_gain_threshold, int days_for_gain, double max_loss_pct);
+
+    // Two passes over the stored path (mean first, then deviations), where
+    // MetricsAccumulator keeps running sums: equal up to rounding.
+    RiskMetrics risk_of(const std::vector<double>& marked, const std::vector<Trade>& trades);
+
+} // namespace sugar::ref
@@ -0,0 +1,122 @@
+// sugar_replay: play a candle CSV back as a live feed for `sugar_Bot --stream`.
+//
+//   sugar_replay FILE [--rate BARS_PER_SEC] [--to DEST]
+//
+//   --rate 0 (default) sends as fast as the reader takes it.
+//   DEST: "-" stdout (default), "unix:PATH" listen and serve the first client,
+//         or PATH: a named pipe (created if missing) or a file to append to
+//         (follow it with --stream tail:PATH).
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+
+#if defined(__unix__) || defined(__APPLE__)
+
+// Opens DEST for writing; for "unix:PATH" blocks until one client connects.
+static int open_dest(const std::string& dest) {
+	if (dest == "-") return ::dup(STDOUT_FILENO);
+	if (dest.rfind("unix:", 0) == 0) {
+		const std::string path = dest.substr(5);
+		sockaddr_un addr{};
+		if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path too long: " + path);
+		addr.sun_family = AF_UNIX;
+		std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+		::unlink(path.c_str());
+		const int srv = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (srv < 0 || ::bind(srv, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(srv, 1) != 0)
+			throw std::runtime_error("Failed to listen on " + path + ": " + std::strerror(errno));
+		std::cerr << "[replay] waiting for a client on " << path << "\n";
+		const int fd = ::accept(srv, nullptr, nullptr);
+		::close(srv);
+		::unlink(path.c_str());
+		return fd;
+	}
+	struct stat sb {};
+	if (::stat(dest.c_str(), &sb) != 0 && ::mkfifo(dest.c_str(), 0644) != 0)
+		throw std::runtime_error("Failed to create pipe " + dest + ": " + std::strerror(errno));
+	return ::open(dest.c_str(), O_WRONLY | O_APPEND);											// on a pipe: blocks until a reader opens it
+}
+
+static void write_all(int fd, const std::string& s) {
+	std::size_t off = 0;
+	while (off < s.size()) {
+		const ssize_t n = ::write(fd, s.data() + off, s.size() - off);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+		off += static_cast<std::size_t>(n);
+	}
+}
+
+#endif
+
+
+int main(int argc, char** argv) {
+	try {
+#if defined(__unix__) || defined(__APPLE__)
+		std::string path, dest = "-";
+		double rate = 0.0;
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			auto value = [&]() -> std::string {
+				if (i + 1 >= argc) throw std::runtime_error("Missing value for " + std::string(arg));
+				return argv[++i];
+			};
+			if (arg == "--rate") rate = std::stod(value());
+			else if (arg == "--to") dest = value();
+			else if (arg.rfind("--", 0) == 0) throw std::runtime_error("Unknown option: " + std::string(arg));
+			else path = arg;
+		}
+		if (path.empty()) throw std::runtime_error("Usage: sugar_replay FILE [--rate BARS_PER_SEC] [--to DEST]");
+
+		std::ifstream in(path, std::ios::binary);
+		if (!in) throw std::runtime_error("Failed to open file: " + path);
+		std::signal(SIGPIPE, SIG_IGN);																// reader went away: write() fails instead of killing us
+		const int fd = open_dest(dest);
+		if (fd < 0) throw std::runtime_error("Failed to open " + dest + ": " + std::strerror(errno));
+
+		using clock = std::chrono::steady_clock;
+		const auto period = rate > 0.0 ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / rate))
+			: clock::duration::zero();
+		auto due = clock::now();
+		std::size_t lines = 0;
+		std::string line;
+		const auto t0 = clock::now();
+		while (std::getline(in, line)) {
+			if (lines > 0 && period > clock::duration::zero()) {										// header goes out at once
+				due += period;
+				std::this_thread::sleep_until(due);
+			}
+			line += '\n';
+			write_all(fd, line);
+			++lines;
+		}
+		::close(fd);
+		std::cerr << "[replay] " << lines << " lines in "
+			<< std::chrono::duration<double>(clock::now() - t0).count() << "s\n";
+		return 0;
+#else
+		(void)argc; (void)argv;
+		throw std::runtime_error("sugar_replay needs a POSIX system");
+#endif
+	}
+	catch (const std::exception& ex) {
+		std::cerr << "Error: " << ex.what() << "\n"; return 1;
+	}
+}
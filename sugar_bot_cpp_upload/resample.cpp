@@ -0,0 +1,161 @@
+#include "resample.h"
+#include "profile.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace sugar {
+
+    namespace {
+
+        constexpr std::int64_t kDay = 86400, kWeek = 7 * kDay;
+
+        std::int64_t offset_of(std::int64_t seconds) {                  // 1970-01-05 was the first Monday
+            return seconds % kWeek == 0 ? 4 * kDay : 0;
+        }
+
+        // Buckets of `outer` are unions of buckets of `inner`.
+        bool nests(std::int64_t inner, std::int64_t outer) {
+            return outer % inner == 0 && (offset_of(outer) - offset_of(inner)) % inner == 0;
+        }
+
+        // One pass: consecutive bars in the same bucket fold into one bar.
+        // starts receives the index in `in` where each output bar begins.
+        void aggregate(std::span<const Candle> in, std::int64_t seconds, std::vector<Candle>& out,
+            std::vector<std::uint32_t>& starts) {
+            if (!in.empty() && in.back().ts > in.front().ts)             // bars cannot outnumber buckets spanned
+                out.reserve(std::min<std::size_t>(in.size(), static_cast<std::size_t>((in.back().ts - in.front().ts) / seconds) + 2));
+            std::int64_t lo = 0, hi = std::numeric_limits<std::int64_t>::min();   // current bucket [lo, hi)
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                const Candle& c = in[i];
+                if (c.ts >= lo && c.ts < hi) {                          // common case: no division
+                    Candle& o = out.back();
+                    o.high = std::max(o.high, c.high);
+                    o.low = std::min(o.low, c.low);
+                    o.close = c.close;
+                    o.volume += c.volume;
+                    continue;
+                }
+                lo = bucket_start(c.ts, seconds); hi = lo + seconds;
+                starts.push_back(static_cast<std::uint32_t>(i));
+                Candle o = c;
+                o.ts = lo;
+                out.push_back(o);
+            }
+        }
+
+    } // namespace
+
+    std::int64_t parse_timeframe(const std::string& text) {
+        std::size_t used = 0;
+        long long n = 0;
+        try { n = std::stoll(text, &used); }
+        catch (const std::exception&) { throw std::invalid_argument("Bad timeframe (want e.g. 15m, 1h, 1d): " + text); }
+        const std::string unit = text.substr(used);
+        std::int64_t mult = 0;
+        if (unit.empty() || unit == "s") mult = 1;
+        else if (unit == "m") mult = 60;
+        else if (unit == "h") mult = 3600;
+        else if (unit == "d") mult = kDay;
+        else if (unit == "w") mult = kWeek;
+        if (mult == 0 || n <= 0) throw std::invalid_argument("Bad timeframe (want e.g. 15m, 1h, 1d): " + text);
+        return n * mult;
+    }
+
+    std::string timeframe_name(std::int64_t s) {
+        if (s > 0 && s % kWeek == 0) return std::to_string(s / kWeek) + "w";
+        if (s > 0 && s % kDay == 0) return std::to_string(s / kDay) + "d";
+        if (s > 0 && s % 3600 == 0) return std::to_string(s / 3600) + "h";
+        if (s > 0 && s % 60 == 0) return std::to_string(s / 60) + "m";
+        return std::to_string(s) + "s";
+    }
+
+    std::int64_t bucket_start(std::int64_t ts, std::int64_t seconds) {
+        const std::int64_t off = offset_of(seconds);
+        std::int64_t q = (ts - off) / seconds;
+        if ((ts - off) % seconds < 0) --q;                              // floor for times before the epoch
+        return q * seconds + off;
+    }
+
+    std::int64_t bar_seconds(std::span<const Candle> rows) {
+        std::int64_t best = 0;
+        for (std::size_t i = 1; i < rows.size(); ++i) {
+            const std::int64_t d = rows[i].ts - rows[i - 1].ts;
+            if (d > 0 && (best == 0 || d < best)) best = d;
+        }
+        return best;
+    }
+
+    std::vector<Resampled> resample(const CandleSeries& source, std::span<const std::int64_t> timeframes) {
+        SUGAR_PROF_SCOPE("resample/total");
+        const auto rows = source.rows();
+        if (rows.size() > std::numeric_limits<std::uint32_t>::max())
+            throw std::invalid_argument("resample: more than 2^32 source bars");
+        const std::int64_t step = bar_seconds(rows);
+        std::vector<std::int64_t> order(timeframes.begin(), timeframes.end());
+        std::sort(order.begin(), order.end());
+        order.erase(std::unique(order.begin(), order.end()), order.end());
+        for (auto t : order)
+            if (t <= 0 || t < step)
+                throw std::invalid_argument("resample: timeframe " + timeframe_name(t) + " is finer than the source bars ("
+                    + timeframe_name(step) + ")");
+
+        std::vector<Resampled> built(order.size());
+        for (std::size_t t = 0; t < order.size(); ++t) {
+            Resampled& r = built[t];
+            r.seconds = order[t];
+            const Resampled* from = nullptr;                            // largest finished target nesting inside this one
+            for (std::size_t p = t; p-- > 0;)
+                if (nests(order[p], order[t])) { from = &built[p]; break; }
+
+            std::vector<Candle> bars;
+            if (!from) aggregate(rows, r.seconds, bars, r.first);
+            else {
+                std::vector<std::uint32_t> starts;                      // in from's bars
+                aggregate(from->series.rows(), r.seconds, bars, starts);
+                r.first.reserve(starts.size() + 1);
+                for (auto s : starts) r.first.push_back(from->first[s]);
+            }
+            r.first.push_back(static_cast<std::uint32_t>(rows.size()));
+            r.series = CandleSeries{ std::move(bars) };
+            r.closed = closed_map(rows, step, r.series.rows(), r.seconds);
+        }
+
+        std::vector<Resampled> out;
+        out.reserve(timeframes.size());
+        std::vector<char> taken(built.size());
+        for (auto t : timeframes) {                                     // requested order; a repeated timeframe gets a copy
+            const auto k = static_cast<std::size_t>(std::lower_bound(order.begin(), order.end(), t) - order.begin());
+            if (taken[k]) out.push_back(out[static_cast<std::size_t>(std::find(timeframes.begin(), timeframes.end(), t) - timeframes.begin())]);
+            else { out.push_back(std::move(built[k])); taken[k] = 1; }
+        }
+        return out;
+    }
+
+    std::vector<std::int32_t> closed_map(std::span<const Candle> fine, std::int64_t fine_seconds,
+        std::span<const Candle> coarse, std::int64_t coarse_seconds) {
+        std::vector<std::int32_t> out(fine.size());
+        auto closes_by = [&](std::size_t j, std::int64_t end) { return fine[j].ts + fine_seconds >= end; };
+        std::size_t i = 0;                                              // fine bars [0, i) are filled
+        for (std::size_t k = 0; k < coarse.size() && i < fine.size(); ++k) {
+            const std::int64_t end = coarse[k].ts + coarse_seconds;
+            std::size_t lo = i, hi = i, step = 1;                       // gallop from i, then bisect: only the
+            while (hi < fine.size() && !closes_by(hi, end)) { lo = hi + 1; hi += step; step *= 2; }   // bars near the boundary are read
+            hi = std::min(hi, fine.size());
+            while (lo < hi) { const std::size_t mid = lo + (hi - lo) / 2; if (closes_by(mid, end)) hi = mid; else lo = mid + 1; }
+            std::fill(out.begin() + static_cast<std::ptrdiff_t>(i), out.begin() + static_cast<std::ptrdiff_t>(lo), static_cast<std::int32_t>(k) - 1);
+            i = lo;
+        }
+        std::fill(out.begin() + static_cast<std::ptrdiff_t>(i), out.end(), static_cast<std::int32_t>(coarse.size()) - 1);
+        return out;
+    }
+
+    std::vector<double> align_values(std::span<const double> coarse, std::span<const std::int32_t> map) {
+        std::vector<double> out(map.size());
+        for (std::size_t i = 0; i < map.size(); ++i)
+            out[i] = map[i] < 0 ? std::numeric_limits<double>::quiet_NaN() : coarse[static_cast<std::size_t>(map[i])];
+        return out;
+    }
+
+} // namespace sugar
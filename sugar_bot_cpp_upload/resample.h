@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "series.h"
+
+namespace sugar {
+
+    // ---- timeframes ----------------------------------------------------------
+
+    // "30s", "1m", "15m", "1h", "4h", "1d", "1w" -> bar length in seconds.
+    // Throws std::invalid_argument on anything else.
+    std::int64_t parse_timeframe(const std::string& text);
+    std::string timeframe_name(std::int64_t seconds);                   // largest whole unit: 3600 -> "1h"
+
+    // Bucket start for a bar at ts: buckets are aligned to the epoch (UTC
+    // midnight for days), except weeks, which start on Monday 00:00 UTC.
+    std::int64_t bucket_start(std::int64_t ts, std::int64_t seconds);
+
+    // Length of one source bar: the smallest gap between consecutive bars
+    // (0 for fewer than two bars).
+    std::int64_t bar_seconds(std::span<const Candle> rows);
+
+    // ---- resampling ------------------------------------------------------------
+
+    struct Resampled {
+        std::int64_t seconds{};                                         // target bar length
+        CandleSeries series;                                            // coarse bars; ts = bucket start, date = first source bar's date
+        std::vector<std::uint32_t> first;                               // first source bar of each coarse bar, plus size() at the end
+        std::vector<std::int32_t> closed;                               // per source bar: last coarse bar complete by its close, -1 = none yet
+    };
+
+    // Aggregates `source` into every target timeframe in one call:
+    // open = first, high = max, low = min, close = last, volume = sum.
+    // Targets are built smallest first, each from the largest finished
+    // target whose buckets nest inside its own (15m from 1m, 1h from 15m,
+    // 1d from 1h ...), so only the first one reads every source bar.
+    // Targets must be at least the source bar length; results come back in
+    // the order asked for.
+    std::vector<Resampled> resample(const CandleSeries& source, std::span<const std::int64_t> timeframes);
+
+    // For each fine bar, the last coarse bar whose bucket has ended by the
+    // time the fine bar closes (bar end = ts + its length), -1 if none: a
+    // coarse value read through this map never comes from the future.
+    std::vector<std::int32_t> closed_map(std::span<const Candle> fine, std::int64_t fine_seconds,
+        std::span<const Candle> coarse, std::int64_t coarse_seconds);
+
+    // Coarse-timeframe values (an indicator computed on a Resampled series)
+    // laid onto fine bars through a closed map; NaN where the map is -1.
+    std::vector<double> align_values(std::span<const double> coarse, std::span<const std::int32_t> map);
+
+} // namespace sugar
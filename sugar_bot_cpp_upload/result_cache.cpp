@@ -0,0 +1,143 @@
+#include "result_cache.h"
+#include "binio.h"
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+
+namespace sugar {
+
+    static constexpr std::uint32_t kMagic = 0x43524753;                // "SGRC"
+    static constexpr std::uint32_t kVersion = 2;
+    static constexpr std::uint8_t kResultRecord = 1;
+    static constexpr std::uint8_t kSnapshotRecord = 2;
+    static constexpr std::size_t kFlushBytes = 1 << 20;
+
+    static void put_state(std::string& buf, const RocSmaState& s) {
+        put(buf, s.bars);
+        put(buf, s.fast_sum); put(buf, s.fast_lag_sum);
+        put(buf, s.slow_sum); put(buf, s.slow_lag_sum);
+        put(buf, static_cast<std::uint8_t>(s.started));
+        put(buf, static_cast<std::uint8_t>(s.long_on));
+        put(buf, s.entry); put(buf, s.equity); put(buf, s.peak);
+        put_result(buf, s.r);
+        const MetricsAccumulator& a = s.acc;
+        put(buf, a.bars); put(buf, a.trades); put(buf, a.wins); put(buf, a.hold); put(buf, a.open_bar);
+        put(buf, a.basis); put(buf, a.scale);
+        put(buf, a.marked); put(buf, a.peak); put(buf, a.sum_sq); put(buf, a.down_sq);
+        put(buf, a.dd_sq); put(buf, a.gross_win); put(buf, a.gross_loss);
+    }
+
+    static RocSmaState get_state(BinReader& in) {
+        RocSmaState s{};
+        s.bars = in.get<std::uint64_t>();
+        s.fast_sum = in.get<double>(); s.fast_lag_sum = in.get<double>();
+        s.slow_sum = in.get<double>(); s.slow_lag_sum = in.get<double>();
+        s.started = in.get<std::uint8_t>() != 0;
+        s.long_on = in.get<std::uint8_t>() != 0;
+        s.entry = in.get<double>(); s.equity = in.get<double>(); s.peak = in.get<double>();
+        s.r = get_result(in);
+        MetricsAccumulator& a = s.acc;
+        a.bars = in.get<std::uint64_t>(); a.trades = in.get<std::uint64_t>();
+        a.wins = in.get<std::uint64_t>(); a.hold = in.get<std::uint64_t>(); a.open_bar = in.get<std::uint64_t>();
+        a.basis = in.get<double>(); a.scale = in.get<double>();
+        a.marked = in.get<double>(); a.peak = in.get<double>(); a.sum_sq = in.get<double>();
+        a.down_sq = in.get<double>(); a.dd_sq = in.get<double>(); a.gross_win = in.get<double>(); a.gross_loss = in.get<double>();
+        return s;
+    }
+
+    ResultCache::ResultCache(const std::string& path) {
+        std::error_code ec;
+        const bool fresh = std::filesystem::file_size(path, ec) == 0 || ec;
+        if (!fresh) {
+            std::ifstream ifs(path, std::ios::binary);
+            const std::string buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+            BinReader in(buf);
+            if (in.get<std::uint32_t>() != kMagic || in.get<std::uint32_t>() != kVersion)
+                throw std::runtime_error("Not a result cache (or unsupported version): " + path);
+            try {
+                while (in.remaining() > 0) {
+                    const auto kind = in.get<std::uint8_t>();
+                    const auto key = in.get<std::uint64_t>();
+                    if (kind == kResultRecord) results_[key] = get_result(in);
+                    else if (kind == kSnapshotRecord) {
+                        Snapshot s;
+                        s.prefix_hash = in.get<std::uint64_t>();
+                        s.state = get_state(in);
+                        snapshots_[key] = s;
+                    }
+                    else break;                                         // unknown tail: ignore, we only append
+                }
+            }
+            catch (const std::runtime_error&) {}                        // torn last record from a crash: drop it
+        }
+
+        log_.open(path, std::ios::binary | std::ios::app);
+        if (!log_) throw std::runtime_error("Failed to open result cache: " + path);
+        if (fresh) {
+            put(pending_, kMagic);
+            put(pending_, kVersion);
+        }
+    }
+
+    ResultCache::~ResultCache() {
+        try { flush(); }
+        catch (...) {}
+    }
+
+    const BacktestResult* ResultCache::find(std::uint64_t key) const {
+        auto it = results_.find(key);
+        return it == results_.end() ? nullptr : &it->second;
+    }
+
+    void ResultCache::store(std::uint64_t key, const BacktestResult& r) {
+        if (r.pruned) return;                                           // partial metrics are never cacheable
+        results_[key] = r;
+        put(pending_, kResultRecord);
+        put(pending_, key);
+        put_result(pending_, r);
+        if (pending_.size() >= kFlushBytes) flush();
+    }
+
+    const ResultCache::Snapshot* ResultCache::find_snapshot(std::uint64_t param_key) const {
+        auto it = snapshots_.find(param_key);
+        return it == snapshots_.end() ? nullptr : &it->second;
+    }
+
+    void ResultCache::store_snapshot(std::uint64_t param_key, const Snapshot& s) {
+        snapshots_[param_key] = s;
+        put(pending_, kSnapshotRecord);
+        put(pending_, param_key);
+        put(pending_, s.prefix_hash);
+        put_state(pending_, s.state);
+        if (pending_.size() >= kFlushBytes) flush();
+    }
+
+    void ResultCache::flush() {
+        if (pending_.empty()) return;
+        log_.write(pending_.data(), static_cast<std::streamsize>(pending_.size()));
+        log_.flush();
+        if (!log_) throw std::runtime_error("Failed to write result cache");
+        pending_.clear();
+    }
+
+    std::uint64_t roc_sma_param_key(const RocSmaParams& p) {
+        const auto& [f, s, rlen, th] = p;
+        const std::uint64_t ints[3] = { f, s, rlen };
+        std::uint64_t h = fnv1a64("RocSmaCrossoverStrategy", 23);
+        h = fnv1a64(ints, sizeof(ints), h);
+        return fnv1a64(&th, sizeof(th), h);
+    }
+
+    std::uint64_t roc_sma_result_key(const RocSmaParams& p, std::uint64_t data_hash) {
+        return fnv1a64(&data_hash, sizeof(data_hash), roc_sma_param_key(p));
+    }
+
+    std::vector<std::uint64_t> prefix_hashes(const CandleSeries& data) {
+        std::vector<std::uint64_t> h(data.size() + 1);
+        h[0] = kFnvOffset;
+        const auto rows = data.rows();
+        for (std::size_t i = 0; i < rows.size(); ++i) h[i + 1] = hash_candles(rows.subspan(i, 1), h[i]);
+        return h;
+    }
+
+} // namespace sugar
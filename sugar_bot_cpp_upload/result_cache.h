@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "metrics.h"
+#include "series.h"
+#include "strategy_roc_sma.h"
+#include "sweep.h"
+
+namespace sugar {
+
+    // On-disk, content-addressed cache of backtest results.
+    //
+    // A result is keyed by hash(strategy type, parameters, every candle the
+    // run reads), so any change to the data or parameters is a different key
+    // and a stale hit is impossible. The file is an append-only log of
+    // records loaded into memory on open; later records win.
+    //
+    // Append-aware mode additionally keeps, per (strategy, parameters), the
+    // latest resumable RocSmaState together with the hash of the candles it
+    // was captured on. When today's series starts with exactly those candles,
+    // only the new bars are replayed.
+    class ResultCache {
+    public:
+        struct Snapshot {
+            RocSmaState state;
+            std::uint64_t prefix_hash{};                                // hash_candles of the first state.bars candles
+        };
+
+        explicit ResultCache(const std::string& path);
+        ~ResultCache();
+
+        ResultCache(const ResultCache&) = delete;
+        ResultCache& operator=(const ResultCache&) = delete;
+
+        const BacktestResult* find(std::uint64_t key) const;
+        void store(std::uint64_t key, const BacktestResult& r);
+
+        const Snapshot* find_snapshot(std::uint64_t param_key) const;
+        void store_snapshot(std::uint64_t param_key, const Snapshot& s);
+
+        void flush();
+        std::size_t size() const { return results_.size(); }
+
+    private:
+        std::unordered_map<std::uint64_t, BacktestResult> results_;
+        std::unordered_map<std::uint64_t, Snapshot> snapshots_;
+        std::ofstream log_;
+        std::string pending_;                                           // buffered records not yet on disk
+    };
+
+    // Key of (RocSmaCrossoverStrategy, params) without the data.
+    std::uint64_t roc_sma_param_key(const RocSmaParams& p);
+
+    // Full key: parameters plus the content hash of the candles used.
+    std::uint64_t roc_sma_result_key(const RocSmaParams& p, std::uint64_t data_hash);
+
+    // h[i] = hash_candles of the first i candles, for i in [0, size()].
+    std::vector<std::uint64_t> prefix_hashes(const CandleSeries& data);
+
+} // namespace sugar
@@ -0,0 +1,156 @@
+#include "results_store.h"
+#include "binio.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace sugar {
+
+    static constexpr std::uint32_t kFileMagic = 0x53524753;            // "SGRS"
+    static constexpr std::uint32_t kBlockMagic = 0x4B4C4253;           // "SBLK"
+    static constexpr std::uint32_t kVersion = 1;
+
+    void ResultColumns::push(const RocSmaParams& p, const BacktestResult& r) {
+        const auto& [f, s, rlen, th] = p;
+        fast.push_back(static_cast<std::uint32_t>(f));
+        slow.push_back(static_cast<std::uint32_t>(s));
+        roc.push_back(static_cast<std::uint32_t>(rlen));
+        thresh.push_back(th);
+        pnl.push_back(r.pnl);
+        max_drawdown.push_back(r.max_drawdown);
+        trades.push_back(static_cast<std::uint32_t>(r.trades));
+        start_date.push_back(r.best_start_date);
+        flags.push_back(r.pruned ? 1 : 0);
+    }
+
+    void ResultColumns::clear() {
+        fast.clear(); slow.clear(); roc.clear(); thresh.clear();
+        pnl.clear(); max_drawdown.clear(); trades.clear(); start_date.clear(); flags.clear();
+    }
+
+    // ---- writer --------------------------------------------------------------
+
+    ResultStoreWriter::ResultStoreWriter(const std::string& path, std::size_t block_rows)
+        : block_rows_(block_rows < 1 ? 1 : block_rows) {
+        std::error_code ec;
+        const auto existing = std::filesystem::file_size(path, ec);
+        ofs_.open(path, std::ios::binary | std::ios::app);
+        if (!ofs_) throw std::runtime_error("Failed to open result store: " + path);
+        if (ec || existing == 0) {
+            std::string hdr;
+            put(hdr, kFileMagic);
+            put(hdr, kVersion);
+            ofs_.write(hdr.data(), static_cast<std::streamsize>(hdr.size()));
+            bytes_ = hdr.size();
+        }
+        else bytes_ = existing;
+    }
+
+    ResultStoreWriter::~ResultStoreWriter() {
+        try { flush(); }
+        catch (...) {}                                                  // destructor must not throw; flush() explicitly to see errors
+    }
+
+    template <class T>
+    static void write_col(std::ofstream& ofs, const std::vector<T>& v) {
+        ofs.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+    }
+
+    std::uint64_t ResultStoreWriter::flush() {
+        if (buf_.size() > 0) {
+            std::string hdr;
+            put(hdr, kBlockMagic);
+            put(hdr, static_cast<std::uint32_t>(buf_.size()));
+            ofs_.write(hdr.data(), static_cast<std::streamsize>(hdr.size()));
+            write_col(ofs_, buf_.fast); write_col(ofs_, buf_.slow); write_col(ofs_, buf_.roc);
+            write_col(ofs_, buf_.thresh); write_col(ofs_, buf_.pnl); write_col(ofs_, buf_.max_drawdown);
+            write_col(ofs_, buf_.trades); write_col(ofs_, buf_.start_date); write_col(ofs_, buf_.flags);
+            bytes_ += hdr.size() + buf_.size() * (3 * 4 + 3 * 8 + 4 + 4 + 1);
+            buf_.clear();
+        }
+        ofs_.flush();
+        if (!ofs_) throw std::runtime_error("Failed to write result store");
+        return bytes_;
+    }
+
+    // ---- reader --------------------------------------------------------------
+
+    template <class T>
+    static void read_col(const char*& p, const char* end, std::size_t n, std::vector<T>& out) {
+        const std::size_t bytes = n * sizeof(T);
+        if (static_cast<std::size_t>(end - p) < bytes) throw std::runtime_error("Truncated result store");
+        const std::size_t at = out.size();
+        out.resize(at + n);
+        std::memcpy(out.data() + at, p, bytes);
+        p += bytes;
+    }
+
+    ResultColumns load_result_store(const std::string& path) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs.is_open()) throw std::runtime_error("Failed to open result store: " + path);
+        const std::string buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+        BinReader hdr(buf);
+        if (hdr.get<std::uint32_t>() != kFileMagic || hdr.get<std::uint32_t>() != kVersion)
+            throw std::runtime_error("Not a result store (or unsupported version): " + path);
+
+        ResultColumns c;
+        const char* p = buf.data() + 8;
+        const char* end = buf.data() + buf.size();
+        while (p < end) {
+            BinReader blk(p, static_cast<std::size_t>(end - p));
+            if (blk.get<std::uint32_t>() != kBlockMagic) throw std::runtime_error("Corrupt result store block: " + path);
+            const std::size_t n = blk.get<std::uint32_t>();
+            p += 8;
+            read_col(p, end, n, c.fast); read_col(p, end, n, c.slow); read_col(p, end, n, c.roc);
+            read_col(p, end, n, c.thresh); read_col(p, end, n, c.pnl); read_col(p, end, n, c.max_drawdown);
+            read_col(p, end, n, c.trades); read_col(p, end, n, c.start_date); read_col(p, end, n, c.flags);
+        }
+        return c;
+    }
+
+    // ---- queries -------------------------------------------------------------
+
+    double ScoreSpec::operator()(const ResultColumns& c, std::size_t i) const {
+        double s = w_pnl * c.pnl[i] + w_dd * c.max_drawdown[i] + w_trades * double(c.trades[i]);
+        if (w_calmar != 0.0) s += w_calmar * c.pnl[i] / std::max(c.max_drawdown[i], 1e-9);
+        return s;
+    }
+
+    bool ResultFilter::operator()(const ResultColumns& c, std::size_t i) const {
+        if (!include_pruned && (c.flags[i] & 1)) return false;
+        return c.pnl[i] >= min_pnl && c.max_drawdown[i] <= max_dd && c.trades[i] >= min_trades;
+    }
+
+    std::vector<std::size_t> query_top_k(const ResultColumns& c, const ScoreSpec& score, const ResultFilter& keep, std::size_t k) {
+        std::vector<std::pair<double, std::size_t>> scored;
+        for (std::size_t i = 0; i < c.size(); ++i)
+            if (keep(c, i)) scored.push_back({ score(c, i), i });
+        k = std::min(k, scored.size());
+        std::partial_sort(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(k), scored.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first || (a.first == b.first && a.second < b.second); });
+        std::vector<std::size_t> out;
+        for (std::size_t j = 0; j < k; ++j) out.push_back(scored[j].second);
+        return out;
+    }
+
+    std::vector<std::size_t> query_pareto(const ResultColumns& c, const ResultFilter& keep) {
+        std::vector<std::size_t> idx;
+        for (std::size_t i = 0; i < c.size(); ++i) if (keep(c, i)) idx.push_back(i);
+        std::sort(idx.begin(), idx.end(), [&](std::size_t a, std::size_t b) {
+            if (c.pnl[a] != c.pnl[b]) return c.pnl[a] > c.pnl[b];
+            return c.max_drawdown[a] < c.max_drawdown[b];
+        });
+        // Walking down in pnl, a row is on the front iff its drawdown beats everything above it.
+        std::vector<std::size_t> front;
+        double best_dd = std::numeric_limits<double>::infinity();
+        for (std::size_t i : idx)
+            if (c.max_drawdown[i] < best_dd) { front.push_back(i); best_dd = c.max_drawdown[i]; }
+        return front;
+    }
+
+} // namespace sugar
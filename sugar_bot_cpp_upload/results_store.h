@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "metrics.h"
+#include "sweep.h"
+
+namespace sugar {
+
+    // Columnar, append-only store of every combo a sweep evaluates.
+    //
+    // File = header ("SGRS", version) followed by blocks. Each block is
+    // (magic, row count) and then one contiguous array per column, so a reader
+    // can scan a metric for millions of rows without touching the others.
+    // Rows are buffered in memory and written a block at a time.
+
+    struct ResultColumns {
+        std::vector<std::uint32_t> fast, slow, roc;
+        std::vector<double> thresh;
+        std::vector<double> pnl, max_drawdown;
+        std::vector<std::uint32_t> trades;
+        std::vector<std::int32_t> start_date;
+        std::vector<std::uint8_t> flags;                                // bit 0: pruned (metrics are partial)
+
+        std::size_t size() const { return pnl.size(); }
+        void push(const RocSmaParams& p, const BacktestResult& r);
+        void clear();
+    };
+
+    // Bytes one row adds to the file (block headers aside).
+    inline constexpr std::size_t kResultRowBytes = 4 * sizeof(std::uint32_t) + 3 * sizeof(double)
+        + sizeof(std::int32_t) + sizeof(std::uint8_t);
+
+    class ResultStoreWriter {
+    public:
+        // Appends to `path`, creating it (with header) if missing or empty.
+        explicit ResultStoreWriter(const std::string& path, std::size_t block_rows = 65536);
+        ~ResultStoreWriter();
+
+        ResultStoreWriter(const ResultStoreWriter&) = delete;
+        ResultStoreWriter& operator=(const ResultStoreWriter&) = delete;
+
+        void append(const RocSmaParams& p, const BacktestResult& r) {
+            buf_.push(p, r);
+            if (buf_.size() >= block_rows_) flush();
+        }
+
+        // Writes buffered rows and returns the durable file size in bytes.
+        std::uint64_t flush();
+
+    private:
+        std::ofstream ofs_;
+        ResultColumns buf_;
+        std::size_t block_rows_;
+        std::uint64_t bytes_{};
+    };
+
+    // Whole-file load; throws on a foreign or truncated file.
+    ResultColumns load_result_store(const std::string& path);
+
+    // ---- queries -----------------------------------------------------------
+
+    // score = w_pnl * pnl + w_dd * max_drawdown + w_trades * trades + w_calmar * pnl / max_drawdown
+    // Defaults reproduce sweep_score.
+    struct ScoreSpec {
+        double w_pnl = 1.0;
+        double w_dd = -0.25;
+        double w_trades = 0.0;
+        double w_calmar = 0.0;
+
+        double operator()(const ResultColumns& c, std::size_t i) const;
+    };
+
+    struct ResultFilter {
+        double min_pnl = -1e300;
+        double max_dd = 1e300;
+        std::size_t min_trades = 0;
+        bool include_pruned = false;
+
+        bool operator()(const ResultColumns& c, std::size_t i) const;
+    };
+
+    // Row indices of the k best rows under `score`, best first.
+    std::vector<std::size_t> query_top_k(const ResultColumns& c, const ScoreSpec& score, const ResultFilter& keep, std::size_t k);
+
+    // Row indices on the (max pnl, min max_drawdown) Pareto front, by descending pnl.
+    std::vector<std::size_t> query_pareto(const ResultColumns& c, const ResultFilter& keep);
+
+} // namespace sugar
@@ -0,0 +1,60 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace sugar {
+
+    // SplitMix64: tiny, fast, and good enough to seed independent streams.
+    // Satisfies UniformRandomBitGenerator, so it plugs into <random> too.
+    class SplitMix64 {
+    public:
+        using result_type = std::uint64_t;
+        explicit SplitMix64(std::uint64_t seed) : s_(seed) {}
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type(0); }
+        result_type operator()() {
+            std::uint64_t z = (s_ += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        // Uniform in [0, 1) with 53 random bits.
+        double uniform() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+
+    private:
+        std::uint64_t s_;
+    };
+
+    // Stream i of `seed`: decorrelated from its neighbours and from the seed.
+    inline SplitMix64 rng_stream(std::uint64_t seed, std::size_t i) {
+        SplitMix64 mix(seed ^ (0xD1B54A32D192ED03ull * (static_cast<std::uint64_t>(i) + 1)));
+        return SplitMix64(mix());
+    }
+
+    // Standard normals by Marsaglia's polar method, two per accepted pair of
+    // uniforms (no sin/cos). Unlike std::normal_distribution the sequence is
+    // the same on every standard library, so seeded data is reproducible
+    // across toolchains.
+    class NormalGen {
+    public:
+        double operator()(SplitMix64& rng) {
+            if (has_spare_) { has_spare_ = false; return spare_; }
+            double x, y, s;
+            do {
+                x = 2.0 * rng.uniform() - 1.0;
+                y = 2.0 * rng.uniform() - 1.0;
+                s = x * x + y * y;
+            } while (s >= 1.0 || s == 0.0);
+            const double k = std::sqrt(-2.0 * std::log(s) / s);
+            spare_ = y * k; has_spare_ = true;
+            return x * k;
+        }
+
+    private:
+        double spare_ = 0.0;
+        bool has_spare_ = false;
+    };
+
+} // namespace sugar
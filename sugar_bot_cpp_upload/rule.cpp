@@ -0,0 +1,613 @@
+#include "rule.h"
+#include "indicators_sma.h"
+#include "indicators_ema.h"
+#include "indicators_roc.h"
+#include "arena.h"
+#include "profile.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+
+namespace sugar {
+
+    namespace {
+
+        constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+        // ---- element kernels (shared by constant folding and evaluation) -----
+
+        struct FAdd { double operator()(double a, double b) const { return a + b; } };
+        struct FSub { double operator()(double a, double b) const { return a - b; } };
+        struct FMul { double operator()(double a, double b) const { return a * b; } };
+        struct FDiv { double operator()(double a, double b) const { return a / b; } };
+        struct FMin { double operator()(double a, double b) const { return std::min(a, b); } };
+        struct FMax { double operator()(double a, double b) const { return std::max(a, b); } };
+        struct FLt { double operator()(double a, double b) const { return a < b ? 1.0 : 0.0; } };
+        struct FLe { double operator()(double a, double b) const { return a <= b ? 1.0 : 0.0; } };
+        struct FGt { double operator()(double a, double b) const { return a > b ? 1.0 : 0.0; } };
+        struct FGe { double operator()(double a, double b) const { return a >= b ? 1.0 : 0.0; } };
+        struct FEq { double operator()(double a, double b) const { return a == b ? 1.0 : 0.0; } };
+        struct FNe { double operator()(double a, double b) const { return a < b || a > b ? 1.0 : 0.0; } };   // false on NaN, like the rest
+        struct FAnd { double operator()(double a, double b) const { return a * b; } };                        // conditions are exactly 0 or 1
+        struct FOr { double operator()(double a, double b) const { return std::max(a, b); } };
+        struct FNeg { double operator()(double a) const { return -a; } };
+        struct FAbs { double operator()(double a) const { return std::abs(a); } };
+        struct FNot { double operator()(double a) const { return 1.0 - a; } };
+        struct FCopy { double operator()(double a) const { return a; } };
+
+        template <class Fn>
+        void with_binary(RuleOp op, Fn&& fn) {
+            switch (op) {
+            case RuleOp::Add: fn(FAdd{}); break;
+            case RuleOp::Sub: fn(FSub{}); break;
+            case RuleOp::Mul: fn(FMul{}); break;
+            case RuleOp::Div: fn(FDiv{}); break;
+            case RuleOp::Min: fn(FMin{}); break;
+            case RuleOp::Max: fn(FMax{}); break;
+            case RuleOp::Lt: fn(FLt{}); break;
+            case RuleOp::Le: fn(FLe{}); break;
+            case RuleOp::Gt: fn(FGt{}); break;
+            case RuleOp::Ge: fn(FGe{}); break;
+            case RuleOp::Eq: fn(FEq{}); break;
+            case RuleOp::Ne: fn(FNe{}); break;
+            case RuleOp::And: fn(FAnd{}); break;
+            case RuleOp::Or: fn(FOr{}); break;
+            default: throw std::logic_error("rule: not a binary op");
+            }
+        }
+
+        template <class Fn>
+        void with_unary(RuleOp op, Fn&& fn) {
+            switch (op) {
+            case RuleOp::Neg: fn(FNeg{}); break;
+            case RuleOp::Abs: fn(FAbs{}); break;
+            case RuleOp::Not: fn(FNot{}); break;
+            case RuleOp::Copy: fn(FCopy{}); break;
+            default: throw std::logic_error("rule: not a unary op");
+            }
+        }
+
+        bool is_window(RuleOp op) { return op == RuleOp::Sma || op == RuleOp::Ema || op == RuleOp::Roc || op == RuleOp::Lag; }
+        bool is_series(RuleOp op) { return op <= RuleOp::Volume; }
+        bool is_unary(RuleOp op) { return op == RuleOp::Neg || op == RuleOp::Abs || op == RuleOp::Not; }
+
+        const char* op_name(RuleOp op) {
+            static const char* const names[] = {
+                "open", "high", "low", "close", "volume", "sma", "ema", "roc", "lag",
+                "add", "sub", "mul", "div", "min", "max", "lt", "le", "gt", "ge", "eq", "ne", "and", "or",
+                "neg", "abs", "not", "copy", "fill",
+            };
+            return names[static_cast<int>(op)];
+        }
+
+        // ---- expression DAG ---------------------------------------------------
+
+        struct Node {
+            RuleOp op{};
+            int a = -1, b = -1;                                         // operand nodes
+            std::uint32_t n{};
+            double k{};
+            bool constant{};                                            // a folded value in k
+            bool cond{};                                                // 0/1 condition rather than a value
+        };
+
+        // Nodes are hash-consed, so equal subexpressions are one node, and an
+        // operand always has a smaller index than its users.
+        class Graph {
+        public:
+            const Node& operator[](int i) const { return nodes_[static_cast<std::size_t>(i)]; }
+            std::size_t size() const { return nodes_.size(); }
+
+            int constant(double k, bool cond = false) {
+                Node n; n.op = RuleOp::Fill; n.k = k; n.constant = true; n.cond = cond;
+                return add(n);
+            }
+            int series(RuleOp op) { Node n; n.op = op; return add(n); }
+
+            int binary(RuleOp op, int a, int b, bool cond) {
+                if ((*this)[a].constant && (*this)[b].constant) {
+                    double v = 0.0;
+                    with_binary(op, [&](auto f) { v = f((*this)[a].k, (*this)[b].k); });
+                    return constant(v, cond);
+                }
+                Node n; n.op = op; n.a = a; n.b = b; n.cond = cond;
+                return add(n);
+            }
+
+            int unary(RuleOp op, int a) {
+                const bool cond = op == RuleOp::Not;
+                if ((*this)[a].constant) {
+                    double v = 0.0;
+                    with_unary(op, [&](auto f) { v = f((*this)[a].k); });
+                    return constant(v, cond);
+                }
+                Node n; n.op = op; n.a = a; n.cond = cond;
+                return add(n);
+            }
+
+            int window(RuleOp op, int a, std::uint32_t len) {
+                if ((*this)[a].constant) {                              // a flat series: every average is itself
+                    const double k = (*this)[a].k;
+                    return constant(op != RuleOp::Roc ? k : k == 0.0 || !std::isfinite(k) ? kNaN : 0.0);
+                }
+                Node n; n.op = op; n.a = a; n.n = len;
+                return add(n);
+            }
+
+        private:
+            int add(const Node& n) {
+                const auto key = std::make_tuple(static_cast<int>(n.op), n.a, n.b, n.n, std::bit_cast<std::uint64_t>(n.k), n.cond);
+                const auto [it, fresh] = index_.try_emplace(key, static_cast<int>(nodes_.size()));
+                if (fresh) nodes_.push_back(n);
+                return it->second;
+            }
+
+            std::vector<Node> nodes_;
+            std::map<std::tuple<int, int, int, std::uint32_t, std::uint64_t, bool>, int> index_;
+        };
+
+        // ---- parser -------------------------------------------------------------
+
+        // Recursive descent, lowest precedence first:
+        // or, and, not, comparison, + -, * /, unary -, primary.
+        class Parser {
+        public:
+            Parser(Graph& g, std::string_view src, std::string clause, std::size_t col0)
+                : g_(g), src_(src), clause_(std::move(clause)), col0_(col0) { next(); }
+
+            int parse() {
+                const std::size_t at = tok_.pos;
+                const int root = or_expr();
+                if (tok_.kind != Tok::End) fail(tok_.pos, "unexpected '" + std::string(tok_.text) + "'");
+                want_cond(root, at);
+                return root;
+            }
+
+        private:
+            struct Tok {
+                enum Kind { End, Num, Ident, Punct } kind = End;
+                std::string_view text;
+                double num{};
+                std::size_t pos{};
+            };
+
+            [[noreturn]] void fail(std::size_t pos, const std::string& msg) const {
+                throw std::invalid_argument("rule " + clause_ + ", col " + std::to_string(col0_ + pos + 1) + ": " + msg);
+            }
+
+            void next() {
+                std::size_t i = end_;
+                while (i < src_.size() && std::isspace(static_cast<unsigned char>(src_[i]))) ++i;
+                tok_ = Tok{}; tok_.pos = i;
+                if (i == src_.size()) { end_ = i; return; }
+                const char c = src_[i];
+                std::size_t j = i + 1;
+                if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+                    const auto [p, ec] = std::from_chars(src_.data() + i, src_.data() + src_.size(), tok_.num);
+                    if (ec != std::errc()) fail(i, "bad number");
+                    tok_.kind = Tok::Num; j = static_cast<std::size_t>(p - src_.data());
+                }
+                else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                    while (j < src_.size() && (std::isalnum(static_cast<unsigned char>(src_[j])) || src_[j] == '_')) ++j;
+                    tok_.kind = Tok::Ident;
+                }
+                else {
+                    static const std::string_view two[] = { "<=", ">=", "==", "!=", "&&", "||" };
+                    for (auto t : two) if (src_.substr(i, 2) == t) j = i + 2;
+                    if (j == i + 1 && std::string_view("+-*/(),<>!").find(c) == std::string_view::npos)
+                        fail(i, std::string("unexpected character '") + c + "'");
+                    tok_.kind = Tok::Punct;
+                }
+                tok_.text = src_.substr(i, j - i);
+                end_ = j;
+            }
+
+            bool accept(std::string_view t) {
+                if (tok_.kind == Tok::End || tok_.kind == Tok::Num || tok_.text != t) return false;
+                next();
+                return true;
+            }
+            void expect(std::string_view t) {
+                if (!accept(t)) fail(tok_.pos, "expected '" + std::string(t) + "'");
+            }
+
+            void want_cond(int node, std::size_t pos) const {
+                if (!g_[node].cond) fail(pos, "expected a condition (a comparison), got a value");
+            }
+            void want_value(int node, std::size_t pos) const {
+                if (g_[node].cond) fail(pos, "expected a value, got a condition");
+            }
+
+            int or_expr() {
+                const std::size_t at = tok_.pos;
+                int a = and_expr();
+                while (accept("or") || accept("||")) {
+                    want_cond(a, at);
+                    const std::size_t bt = tok_.pos;
+                    const int b = and_expr();
+                    want_cond(b, bt);
+                    a = g_.binary(RuleOp::Or, a, b, true);
+                }
+                return a;
+            }
+
+            int and_expr() {
+                const std::size_t at = tok_.pos;
+                int a = not_expr();
+                while (accept("and") || accept("&&")) {
+                    want_cond(a, at);
+                    const std::size_t bt = tok_.pos;
+                    const int b = not_expr();
+                    want_cond(b, bt);
+                    a = g_.binary(RuleOp::And, a, b, true);
+                }
+                return a;
+            }
+
+            int not_expr() {
+                if (accept("not") || accept("!")) {
+                    const std::size_t at = tok_.pos;
+                    const int a = not_expr();
+                    want_cond(a, at);
+                    return g_.unary(RuleOp::Not, a);
+                }
+                return comparison();
+            }
+
+            int comparison() {
+                static const std::pair<std::string_view, RuleOp> ops[] = {
+                    { "<", RuleOp::Lt }, { "<=", RuleOp::Le }, { ">", RuleOp::Gt },
+                    { ">=", RuleOp::Ge }, { "==", RuleOp::Eq }, { "!=", RuleOp::Ne },
+                };
+                const std::size_t at = tok_.pos;
+                const int a = additive();
+                for (const auto& [t, op] : ops) {
+                    if (!accept(t)) continue;
+                    want_value(a, at);
+                    const std::size_t bt = tok_.pos;
+                    const int b = additive();
+                    want_value(b, bt);
+                    for (const auto& o : ops)
+                        if (tok_.kind == Tok::Punct && tok_.text == o.first) fail(tok_.pos, "comparisons do not chain; use 'and'");
+                    return g_.binary(op, a, b, true);
+                }
+                return a;
+            }
+
+            int additive() {
+                const std::size_t at = tok_.pos;
+                int a = multiplicative();
+                for (;;) {
+                    const RuleOp op = accept("+") ? RuleOp::Add : accept("-") ? RuleOp::Sub : RuleOp::Fill;
+                    if (op == RuleOp::Fill) return a;
+                    want_value(a, at);
+                    const std::size_t bt = tok_.pos;
+                    const int b = multiplicative();
+                    want_value(b, bt);
+                    a = g_.binary(op, a, b, false);
+                }
+            }
+
+            int multiplicative() {
+                const std::size_t at = tok_.pos;
+                int a = unary_expr();
+                for (;;) {
+                    const RuleOp op = accept("*") ? RuleOp::Mul : accept("/") ? RuleOp::Div : RuleOp::Fill;
+                    if (op == RuleOp::Fill) return a;
+                    want_value(a, at);
+                    const std::size_t bt = tok_.pos;
+                    const int b = unary_expr();
+                    want_value(b, bt);
+                    a = g_.binary(op, a, b, false);
+                }
+            }
+
+            int unary_expr() {
+                if (accept("-")) {
+                    const std::size_t at = tok_.pos;
+                    const int a = unary_expr();
+                    want_value(a, at);
+                    return g_.unary(RuleOp::Neg, a);
+                }
+                return primary();
+            }
+
+            int primary() {
+                const Tok t = tok_;
+                if (t.kind == Tok::Num) { next(); return g_.constant(t.num); }
+                if (accept("(")) {
+                    const int a = or_expr();
+                    expect(")");
+                    return a;
+                }
+                if (t.kind != Tok::Ident) fail(t.pos, t.kind == Tok::End ? "unexpected end of rule" : "unexpected '" + std::string(t.text) + "'");
+                next();
+
+                static const std::pair<std::string_view, RuleOp> series[] = {
+                    { "open", RuleOp::Open }, { "high", RuleOp::High }, { "low", RuleOp::Low },
+                    { "close", RuleOp::Close }, { "volume", RuleOp::Volume },
+                };
+                for (const auto& [name, op] : series)
+                    if (t.text == name) return g_.series(op);
+
+                static const std::pair<std::string_view, RuleOp> windows[] = {
+                    { "sma", RuleOp::Sma }, { "ema", RuleOp::Ema }, { "roc", RuleOp::Roc }, { "lag", RuleOp::Lag },
+                };
+                for (const auto& [name, op] : windows) {
+                    if (t.text != name) continue;
+                    expect("(");
+                    const int a = value_arg();
+                    expect(",");
+                    const std::uint32_t len = length_arg();
+                    expect(")");
+                    return g_.window(op, a, len);
+                }
+
+                if (t.text == "abs") {
+                    expect("(");
+                    const int a = value_arg();
+                    expect(")");
+                    return g_.unary(RuleOp::Abs, a);
+                }
+                if (t.text == "min" || t.text == "max") {
+                    expect("(");
+                    const int a = value_arg();
+                    expect(",");
+                    const int b = value_arg();
+                    expect(")");
+                    return g_.binary(t.text == "min" ? RuleOp::Min : RuleOp::Max, a, b, false);
+                }
+                if (t.text == "cross_up" || t.text == "cross_down") {        // a crosses b on this bar
+                    expect("(");
+                    int a = value_arg();
+                    expect(",");
+                    int b = value_arg();
+                    expect(")");
+                    if (t.text == "cross_down") std::swap(a, b);
+                    const int now = g_.binary(RuleOp::Gt, a, b, true);
+                    const int before = g_.binary(RuleOp::Le, g_.window(RuleOp::Lag, a, 1), g_.window(RuleOp::Lag, b, 1), true);
+                    return g_.binary(RuleOp::And, now, before, true);
+                }
+                fail(t.pos, "unknown name '" + std::string(t.text) + "'");
+            }
+
+            int value_arg() {
+                const std::size_t at = tok_.pos;
+                const int a = or_expr();
+                want_value(a, at);
+                return a;
+            }
+
+            std::uint32_t length_arg() {
+                const std::size_t at = tok_.pos;
+                const int a = or_expr();
+                const Node& n = g_[a];
+                if (!n.constant || n.cond || !(n.k >= 1.0) || n.k > 4294967295.0 || n.k != std::floor(n.k))
+                    fail(at, "length must be a positive whole number");
+                return static_cast<std::uint32_t>(n.k);
+            }
+
+            Graph& g_;
+            std::string_view src_;
+            std::string clause_;
+            std::size_t col0_;                                          // column of src_[0] in its line
+            std::size_t end_ = 0;                                       // just past the current token
+            Tok tok_;
+        };
+
+        // ---- code generation ----------------------------------------------------
+
+        std::vector<RuleInstr> generate(const Graph& g, int enter, int exit, std::size_t& registers) {
+            const std::size_t count = g.size();
+            std::vector<char> live(count, 0);
+            std::vector<int> last_use(count, -1);
+            std::vector<int> stack{ enter, exit };
+            while (!stack.empty()) {
+                const int i = stack.back(); stack.pop_back();
+                if (live[static_cast<std::size_t>(i)] || g[i].constant) continue;
+                live[static_cast<std::size_t>(i)] = 1;
+                for (const int o : { g[i].a, g[i].b }) if (o >= 0) stack.push_back(o);
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                if (!live[i]) continue;
+                for (const int o : { g[static_cast<int>(i)].a, g[static_cast<int>(i)].b })
+                    if (o >= 0) last_use[static_cast<std::size_t>(o)] = std::max(last_use[static_cast<std::size_t>(o)], static_cast<int>(i));
+            }
+
+            std::vector<std::uint16_t> reg(count, 0), free;
+            std::uint16_t next_reg = 2;
+            auto acquire = [&](int node) -> std::uint16_t {
+                if (node == enter) return RuleProgram::kEnter;
+                if (node == exit) return RuleProgram::kExit;
+                if (!free.empty()) { const auto r = free.back(); free.pop_back(); return r; }
+                if (next_reg == std::numeric_limits<std::uint16_t>::max()) throw std::invalid_argument("rule: expression too large");
+                return next_reg++;
+            };
+            auto release = [&](int at) {                                // operands whose last reader is `at`
+                const Node& u = g[at];
+                for (const int o : { u.a, u.b }) {
+                    if (o < 0 || g[o].constant || last_use[static_cast<std::size_t>(o)] != at || o == enter || o == exit) continue;
+                    if (o == u.b && u.a == u.b) continue;               // x op x: free once
+                    free.push_back(reg[static_cast<std::size_t>(o)]);
+                }
+            };
+
+            std::vector<RuleInstr> code;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (!live[i]) continue;
+                const int id = static_cast<int>(i);
+                const Node& n = g[id];
+                RuleInstr in;
+                in.op = n.op; in.n = n.n;
+                if (n.a >= 0) { if (g[n.a].constant) { in.imm |= RuleInstr::kImmA; in.k = g[n.a].k; } else in.a = reg[static_cast<std::size_t>(n.a)]; }
+                if (n.b >= 0) { if (g[n.b].constant) { in.imm |= RuleInstr::kImmB; in.k = g[n.b].k; } else in.b = reg[static_cast<std::size_t>(n.b)]; }
+                if (is_window(n.op)) { in.dst = acquire(id); release(id); }         // window kernels must not write their input
+                else { release(id); in.dst = acquire(id); }                         // element ops may overwrite a dying operand
+                reg[i] = in.dst;
+                code.push_back(in);
+            }
+
+            auto finish = [&](int root, std::uint16_t out) {
+                if (g[root].constant) { RuleInstr in; in.op = RuleOp::Fill; in.dst = out; in.k = g[root].k; code.push_back(in); }
+            };
+            finish(enter, RuleProgram::kEnter);
+            if (exit == enter && !g[enter].constant) { RuleInstr in; in.op = RuleOp::Copy; in.dst = RuleProgram::kExit; in.a = RuleProgram::kEnter; code.push_back(in); }
+            else finish(exit, RuleProgram::kExit);
+            registers = next_reg;
+            return code;
+        }
+
+        // ---- evaluation ---------------------------------------------------------
+
+        template <class F>
+        void binary_loop(F f, const RuleInstr& in, double* const* r, std::size_t n) {
+            double* d = r[in.dst];
+            const double* a = r[in.a];
+            const double* b = r[in.b];
+            const double k = in.k;
+            if (in.imm & RuleInstr::kImmA) for (std::size_t i = 0; i < n; ++i) d[i] = f(k, b[i]);
+            else if (in.imm & RuleInstr::kImmB) for (std::size_t i = 0; i < n; ++i) d[i] = f(a[i], k);
+            else for (std::size_t i = 0; i < n; ++i) d[i] = f(a[i], b[i]);
+        }
+
+        template <class F>
+        void unary_loop(F f, const RuleInstr& in, double* const* r, std::size_t n) {
+            double* d = r[in.dst];
+            const double* a = r[in.a];
+            for (std::size_t i = 0; i < n; ++i) d[i] = f(a[i]);
+        }
+
+        std::size_t first_defined(const double* v, std::size_t n) {
+            std::size_t i = 0;
+            while (i < n && std::isnan(v[i])) ++i;
+            return i;
+        }
+
+    } // namespace
+
+    RuleProgram RuleProgram::compile(const std::string& text) {
+        Graph g;
+        int roots[2] = { -1, -1 };                                      // enter, exit
+        std::size_t line_start = 0;
+        while (line_start <= text.size()) {
+            std::size_t line_end = text.find('\n', line_start);
+            if (line_end == std::string::npos) line_end = text.size();
+            std::string_view line(text.data() + line_start, line_end - line_start);
+            line = line.substr(0, line.find('#'));
+
+            for (std::size_t seg = 0; seg <= line.size();) {
+                std::size_t stop = line.find(';', seg);
+                if (stop == std::string_view::npos) stop = line.size();
+                const std::string_view part = line.substr(seg, stop - seg);
+                const std::size_t colon = part.find(':');
+                std::string_view label = part.substr(0, colon);
+                while (!label.empty() && std::isspace(static_cast<unsigned char>(label.front()))) label.remove_prefix(1);
+                while (!label.empty() && std::isspace(static_cast<unsigned char>(label.back()))) label.remove_suffix(1);
+                if (!label.empty() || colon != std::string_view::npos) {
+                    const int slot = label == "enter" ? 0 : label == "exit" ? 1 : -1;
+                    if (colon == std::string_view::npos || slot < 0)
+                        throw std::invalid_argument("rule: want 'enter: EXPR' or 'exit: EXPR', got '" + std::string(part) + "'");
+                    if (roots[slot] >= 0) throw std::invalid_argument("rule: more than one '" + std::string(label) + "' clause");
+                    Parser p(g, part.substr(colon + 1), std::string(label), seg + colon + 1);
+                    roots[slot] = p.parse();
+                }
+                seg = stop + 1;
+            }
+            line_start = line_end + 1;
+        }
+        if (roots[0] < 0 || roots[1] < 0) throw std::invalid_argument("rule: needs both an 'enter:' and an 'exit:' clause");
+
+        RuleProgram prog;
+        prog.text_ = text;
+        prog.code_ = generate(g, roots[0], roots[1], prog.registers_);
+        return prog;
+    }
+
+    std::size_t RuleProgram::evaluate(const CandleSeries& data, std::span<double> enter, std::span<double> exit) const {
+        return evaluate(data, enter, exit, thread_scratch());
+    }
+
+    std::size_t RuleProgram::evaluate(const CandleSeries& data, std::span<double> enter, std::span<double> exit,
+        ScratchArena& arena) const {
+        SUGAR_PROF_SCOPE("rule/evaluate");
+        const std::size_t n = data.size();
+        if (enter.size() != n || exit.size() != n) throw std::invalid_argument("RuleProgram::evaluate: output size != series size");
+
+        ScratchScope scratch(arena);
+        std::pmr::vector<double> pool((registers_ - 2) * n, scratch.resource());
+        std::pmr::vector<double*> r(registers_, scratch.resource());
+        r[kEnter] = enter.data(); r[kExit] = exit.data();
+        for (std::size_t i = 2; i < registers_; ++i) r[i] = pool.data() + (i - 2) * n;
+
+        const auto rows = data.rows();
+        std::size_t first = 0;
+        for (const RuleInstr& in : code_) {
+            double* d = r[in.dst];
+            switch (in.op) {
+            case RuleOp::Open: for (std::size_t i = 0; i < n; ++i) d[i] = rows[i].open; break;
+            case RuleOp::High: for (std::size_t i = 0; i < n; ++i) d[i] = rows[i].high; break;
+            case RuleOp::Low: for (std::size_t i = 0; i < n; ++i) d[i] = rows[i].low; break;
+            case RuleOp::Close: for (std::size_t i = 0; i < n; ++i) d[i] = rows[i].close; break;
+            case RuleOp::Volume: for (std::size_t i = 0; i < n; ++i) d[i] = rows[i].volume; break;
+            case RuleOp::Sma: case RuleOp::Ema: case RuleOp::Roc: case RuleOp::Lag: {
+                const double* a = r[in.a];
+                const std::size_t s = first_defined(a, n);                  // stacked indicators start where their input does
+                std::fill(d, d + s, kNaN);
+                const std::span<const double> src(a + s, n - s);
+                const std::span<double> out(d + s, n - s);
+                if (in.op == RuleOp::Sma) sma_into(src, in.n, out);
+                else if (in.op == RuleOp::Ema) ema_into(src, in.n, out);
+                else if (in.op == RuleOp::Roc) roc_into(src, in.n, out);
+                else for (std::size_t i = 0; i < out.size(); ++i) out[i] = i < in.n ? kNaN : src[i - in.n];
+                first = std::max(first, first_defined(d, n));
+                break;
+            }
+            case RuleOp::Fill: std::fill(d, d + n, in.k); break;
+            default:
+                if (is_unary(in.op) || in.op == RuleOp::Copy) with_unary(in.op, [&](auto f) { unary_loop(f, in, r.data(), n); });
+                else with_binary(in.op, [&](auto f) { binary_loop(f, in, r.data(), n); });
+            }
+        }
+        return first;
+    }
+
+    std::string RuleProgram::disassemble() const {
+        std::ostringstream out;
+        out.precision(10);
+        auto operand = [&](std::uint16_t reg, bool imm, double k) {
+            if (imm) out << k;
+            else out << 'r' << reg;
+        };
+        for (std::size_t i = 0; i < code_.size(); ++i) {
+            const RuleInstr& in = code_[i];
+            out << (i < 10 ? "  " : i < 100 ? " " : "") << i << "  r" << in.dst << " = " << op_name(in.op);
+            if (in.op == RuleOp::Fill) out << ' ' << in.k;
+            else if (is_window(in.op)) { out << " r" << in.a << ", " << in.n; }
+            else if (is_unary(in.op) || in.op == RuleOp::Copy) { out << ' '; operand(in.a, in.imm & RuleInstr::kImmA, in.k); }
+            else if (!is_series(in.op)) {
+                out << ' '; operand(in.a, in.imm & RuleInstr::kImmA, in.k);
+                out << ", "; operand(in.b, in.imm & RuleInstr::kImmB, in.k);
+            }
+            out << '\n';
+        }
+        return out.str();
+    }
+
+    std::string read_rule_arg(const std::string& arg) {
+        if (arg.empty() || arg[0] != '@') return arg;
+        std::ifstream in(arg.substr(1), std::ios::binary);
+        if (!in) throw std::runtime_error("Failed to open rule file: " + arg.substr(1));
+        std::ostringstream text;
+        text << in.rdbuf();
+        return text.str();
+    }
+
+} // namespace sugar
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "arena.h"
+#include "series.h"
+
+namespace sugar {
+
+    // ---- rule language -------------------------------------------------------
+    //
+    // A rule is two clauses, one per line or separated by ';':
+    //
+    //     enter: roc(sma(close,50),100) - roc(sma(close,60),100) >= 0.15
+    //     exit:  roc(sma(close,50),100) - roc(sma(close,60),100) <= -0.15
+    //
+    // Series:     open high low close volume
+    // Indicators: sma(x,n) ema(x,n) roc(x,n) lag(x,n)   (n a positive integer constant)
+    // Functions:  min(a,b) max(a,b) abs(x) cross_up(a,b) cross_down(a,b)
+    // Operators:  * /  + -  < <= > >= == !=  not  and  or   (also ! && ||)
+    //
+    // Both clauses must be conditions; a comparison with a NaN operand (an
+    // indicator still warming up, a division by zero) is false. '#' starts a
+    // comment that runs to the end of the line.
+
+    enum class RuleOp : std::uint8_t {
+        Open, High, Low, Close, Volume,                                 // dst = series column
+        Sma, Ema, Roc, Lag,                                             // dst = window op over a, length n (dst != a)
+        Add, Sub, Mul, Div, Min, Max,                                   // dst = a op b
+        Lt, Le, Gt, Ge, Eq, Ne, And, Or,                                // conditions: 1.0 or 0.0
+        Neg, Abs, Not,                                                  // dst = op a
+        Copy, Fill,                                                     // dst = a; dst = k
+    };
+
+    struct RuleInstr {
+        static constexpr std::uint8_t kImmA = 1, kImmB = 2;             // operand replaced by the constant k
+
+        RuleOp op{};
+        std::uint8_t imm{};
+        std::uint16_t dst{}, a{}, b{};                                  // registers
+        std::uint32_t n{};                                              // window length
+        double k{};
+    };
+
+    // A rule compiled to register bytecode. Compiling parses both clauses
+    // into one expression DAG (common subexpressions are shared, also
+    // between enter and exit), folds constants, and allocates registers by
+    // liveness. Evaluation runs each instruction over the whole series
+    // (column at a time) with the indicator kernels the hand-written
+    // strategies use, so a rule computes what its C++ twin computes.
+    class RuleProgram {
+    public:
+        static constexpr std::uint16_t kEnter = 0, kExit = 1;           // output registers
+
+        // Throws std::invalid_argument naming the clause and column at fault.
+        static RuleProgram compile(const std::string& text);
+
+        // Writes both conditions (1.0 / 0.0) for every bar of `data` into
+        // caller storage of data.size() doubles; other registers come from
+        // `scratch` (the thread's arena if not given). Returns the first
+        // usable bar: the first where every indicator the rule reads has a
+        // value (data.size() if there is none).
+        std::size_t evaluate(const CandleSeries& data, std::span<double> enter, std::span<double> exit) const;
+        std::size_t evaluate(const CandleSeries& data, std::span<double> enter, std::span<double> exit,
+            ScratchArena& scratch) const;
+
+        const std::string& text() const { return text_; }
+        std::span<const RuleInstr> code() const { return code_; }
+        std::size_t registers() const { return registers_; }            // outputs included
+        std::string disassemble() const;                                // one instruction per line
+
+    private:
+        std::string text_;
+        std::vector<RuleInstr> code_;
+        std::size_t registers_ = 2;
+    };
+
+    // "@path" reads the rule from a file; anything else is the rule itself.
+    std::string read_rule_arg(const std::string& arg);
+
+} // namespace sugar
@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include "candle.h"
+#include "profile.h"
+#include <memory>
 #include <span>
 
 
@@ -11,27 +13,53 @@ namespace sugar {
 	public:																						// accessors
 		CandleSeries() = default;																// set constructor to default 
 																								// set parameters for Pass By Value class object initialization (member initializer list) moves into 'rows'
-		explicit CandleSeries(std::vector<Candle> rows) : rows_(std::move(rows)) {}				// rows is a temp std::vector<Candle> object for calculation
+		explicit CandleSeries(std::vector<Candle> rows)											// rows is a temp std::vector<Candle> object for calculation
+			: store_(std::make_shared<const std::vector<Candle>>(std::move(rows))), len_(store_->size()) {}
+																								// View of candles someone else already placed in a shared store (e.g. a CandleArena block)
+		CandleSeries(std::shared_ptr<const std::vector<Candle>> store, std::size_t offset, std::size_t len)
+			: store_(std::move(store)), off_(offset), len_(len) {}
 																								
 
-		const std::vector<Candle>& rows() const { return rows_; }								// CandleSeries member function to return a read only const ref to data member 'rows_'
-		std::size_t size() const { return rows_.size(); }										// CandleSeries member function to return a size_t copy of vector::rows_.size() by value, will not mutate (const)
+
+		std::span<const Candle> rows() const { return { data(), len_ }; }						// read only view of this series' candles (a window of the shared store)
+		std::size_t size() const { return len_; }												// CandleSeries member function to return the number of candles in view, will not mutate (const)
+
+
+																								// Cheap sub-series views: share the same storage, copy nothing.
+		CandleSeries slice(std::size_t begin, std::size_t end) const {							// half-open [begin, end) relative to this view, clamped to size()
+			end = end < len_ ? end : len_;
+			begin = begin < end ? begin : end;
+			CandleSeries out;
+			out.store_ = store_; out.off_ = off_ + begin; out.len_ = end - begin;
+			return out;
+		}
+		CandleSeries prefix(std::size_t n) const { return slice(0, n); }						// first n candles (e.g. growing-prefix evaluation)
 
 
 																								// Convenience extractor for indicator inputs (close-only for now)
 		std::vector<double> closes() const {													// returns a vector of close values by value.
+			SUGAR_PROF_SCOPE("series/closes");
 			std::vector<double> out;															// temp vec to build and return by value
-			out.reserve(rows_.size());															// set capacity
-			for (const auto& c : rows_) out.push_back(c.close);									// loop to build the closing values
+			out.reserve(len_);																	// set capacity
+			for (const auto& c : rows()) out.push_back(c.close);								// loop to build the closing values
 			return out;																			// return close values as vector
 		}
+		void closes_into(std::span<double> out) const {											// same, into caller storage of size() doubles (no allocation)
+			SUGAR_PROF_SCOPE("series/closes");
+			std::size_t i = 0;
+			for (const auto& c : rows()) out[i++] = c.close;
+		}
 
 
-		const Candle& operator[](std::size_t i) const { return rows_[i]; }						// overload the [] operator to return an indexed candle value.
+		const Candle& operator[](std::size_t i) const { return data()[i]; }						// overload the [] operator to return an indexed candle value.
 
 
 	private:																					// encapsulation
-		std::vector<Candle> rows_;																// CandleSeries (only) Data member
+		const Candle* data() const { return store_ ? store_->data() + off_ : nullptr; }			// first candle of this view
+
+		std::shared_ptr<const std::vector<Candle>> store_;										// shared by every slice of the same load
+		std::size_t off_{};																		// view offset into *store_
+		std::size_t len_{};																		// view length
 	};
 
 
@@ -0,0 +1,319 @@
+#include "shard.h"
+#include "binio.h"
+#include "checkpoint.h"
+#include "candle_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#define SUGAR_HAS_FORK 1
+#endif
+
+namespace fs = std::filesystem;
+
+namespace sugar {
+
+    namespace {
+
+        constexpr std::uint32_t kJobMagic = 0x424A4753;                 // "SGJB"
+        constexpr std::uint32_t kDoneMagic = 0x444E4753;                // "SGND"
+        constexpr std::uint32_t kVersion = 2;
+        constexpr auto kPoll = std::chrono::milliseconds(50);
+
+        std::string read_file(const fs::path& p) {
+            std::ifstream ifs(p, std::ios::binary);
+            if (!ifs.is_open()) throw std::runtime_error("Failed to open: " + p.string());
+            return { std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+        }
+
+        // Write-then-rename so readers only ever see complete files.
+        void publish(const fs::path& p, const std::string& buf) {
+            const fs::path tmp = p.string() + ".tmp";
+            {
+                std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+                ofs.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+                if (!ofs) throw std::runtime_error("Failed to write: " + tmp.string());
+            }
+            fs::rename(tmp, p);
+        }
+
+        template <class T>
+        void put_vec(std::string& buf, const std::vector<T>& v) {
+            put(buf, static_cast<std::uint64_t>(v.size()));
+            for (const T& x : v) put(buf, x);
+        }
+
+        template <class T>
+        std::vector<T> get_vec(BinReader& in) {
+            std::vector<T> v(static_cast<std::size_t>(in.get<std::uint64_t>()));
+            for (T& x : v) x = in.get<T>();
+            return v;
+        }
+
+        std::string shard_name(std::size_t i) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "shard_%05zu", i);
+            return buf;
+        }
+
+        // Shard index from "shard_NNNNN.<anything>", or npos.
+        std::size_t shard_index(const std::string& name) {
+            if (name.rfind("shard_", 0) != 0 || name.size() < 12) return static_cast<std::size_t>(-1);
+            return static_cast<std::size_t>(std::stoull(name.substr(6, 5)));
+        }
+
+        std::string host_name() {
+#ifdef SUGAR_HAS_FORK
+            char buf[256] = {};
+            if (gethostname(buf, sizeof(buf) - 1) == 0) return buf;
+#endif
+            return "localhost";
+        }
+
+        long process_id() {
+#ifdef SUGAR_HAS_FORK
+            return static_cast<long>(getpid());
+#else
+            return 0;
+#endif
+        }
+
+        struct LoadedJob {
+            ShardJob job;
+            std::uint64_t shards{};
+            std::uint64_t config_hash{};
+        };
+
+        void write_job(const fs::path& dir, const ShardJob& job, std::uint64_t shards, std::uint64_t hash) {
+            std::string buf;
+            put(buf, kJobMagic);
+            put(buf, kVersion);
+            put(buf, static_cast<std::uint64_t>(job.data_path.size()));
+            buf += job.data_path;
+            put_vec(buf, job.fasts);
+            put_vec(buf, job.slows);
+            put_vec(buf, job.rocs);
+            put_vec(buf, job.threshes);
+            put(buf, static_cast<std::uint8_t>(job.sweep.prune));
+            put(buf, static_cast<std::uint64_t>(job.sweep.top_k));
+            put(buf, static_cast<std::uint8_t>(job.sweep.rank));
+            put(buf, shards);
+            put(buf, hash);
+            publish(dir / "job.bin", buf);
+        }
+
+        LoadedJob read_job(const fs::path& dir) {
+            const std::string buf = read_file(dir / "job.bin");
+            BinReader in(buf);
+            if (in.get<std::uint32_t>() != kJobMagic || in.get<std::uint32_t>() != kVersion)
+                throw std::runtime_error("Not a sweep job file: " + (dir / "job.bin").string());
+            LoadedJob lj;
+            const auto len = static_cast<std::size_t>(in.get<std::uint64_t>());
+            for (std::size_t i = 0; i < len; ++i) lj.job.data_path.push_back(in.get<char>());
+            lj.job.fasts = get_vec<std::size_t>(in);
+            lj.job.slows = get_vec<std::size_t>(in);
+            lj.job.rocs = get_vec<std::size_t>(in);
+            lj.job.threshes = get_vec<double>(in);
+            lj.job.sweep.prune = in.get<std::uint8_t>() != 0;
+            lj.job.sweep.top_k = static_cast<std::size_t>(in.get<std::uint64_t>());
+            lj.job.sweep.rank = static_cast<SweepRank>(in.get<std::uint8_t>());
+            lj.shards = in.get<std::uint64_t>();
+            lj.config_hash = in.get<std::uint64_t>();
+            return lj;
+        }
+
+        std::uint64_t job_hash(const CandleSeries& data, const ShardJob& job) {
+            SweepOptions o{};
+            o.prune = job.sweep.prune;
+            o.top_k = job.sweep.top_k;
+            o.rank = job.sweep.rank;
+            return sweep_config_hash(data, job.fasts, job.slows, job.rocs, job.threshes, o);
+        }
+
+        // Shard i covers pairs [i * P / n, (i + 1) * P / n).
+        std::pair<std::uint64_t, std::uint64_t> shard_range(std::uint64_t i, std::uint64_t n, std::uint64_t pairs) {
+            return { i * pairs / n, (i + 1) * pairs / n };
+        }
+
+        // Put a claimed shard back in the queue (no-op if it finished meanwhile).
+        void requeue(const fs::path& run_file) {
+            const std::string name = run_file.filename().string();
+            std::error_code ec;
+            fs::rename(run_file, run_file.parent_path() / (name.substr(0, name.find('.')) + ".todo"), ec);
+        }
+
+#ifdef SUGAR_HAS_FORK
+        long spawn_worker(const std::string& exe, const std::string& dir) {
+            const pid_t pid = fork();
+            if (pid < 0) throw std::runtime_error("fork failed");
+            if (pid == 0) {
+                execl(exe.c_str(), exe.c_str(), "--worker", dir.c_str(), static_cast<char*>(nullptr));
+                _exit(127);
+            }
+            return static_cast<long>(pid);
+        }
+#endif
+
+    } // namespace
+
+    // ---- worker --------------------------------------------------------------
+
+    int run_shard_worker(const std::string& dir_str) {
+        const fs::path dir(dir_str);
+        const LoadedJob lj = read_job(dir);
+        const CandleSeries data{ load_candles(lj.job.data_path) };
+        if (job_hash(data, lj.job) != lj.config_hash)
+            throw std::runtime_error("Worker data differs from the coordinator's: " + lj.job.data_path);
+
+        const std::uint64_t pairs = lj.job.fasts.size() * lj.job.slows.size();
+        const std::string claim_tag = ".run." + host_name() + "." + std::to_string(process_id());
+
+        while (!fs::exists(dir / "finished")) {
+            // Claim the first .todo we can win the rename race for.
+            fs::path claimed;
+            std::size_t idx = 0;
+            for (const auto& e : fs::directory_iterator(dir)) {
+                const std::string name = e.path().filename().string();
+                if (e.path().extension() != ".todo") continue;
+                idx = shard_index(name);
+                const fs::path target = dir / (shard_name(idx) + claim_tag);
+                std::error_code ec;
+                fs::rename(e.path(), target, ec);
+                if (!ec) { claimed = target; break; }
+            }
+            if (claimed.empty()) { std::this_thread::sleep_for(kPoll); continue; }
+
+            SweepOptions so = lj.job.sweep;
+            std::tie(so.pair_begin, so.pair_end) = shard_range(idx, lj.shards, pairs);
+            so.quiet = true;
+            so.on_pair = [&](std::uint64_t) {                                           // heartbeat
+                std::error_code ec;
+                fs::last_write_time(claimed, fs::file_time_type::clock::now(), ec);
+            };
+            const SweepResult r = sweep_roc_sma(data, lj.job.fasts, lj.job.slows, lj.job.rocs, lj.job.threshes, so);
+
+            std::string buf;
+            put(buf, kDoneMagic);
+            put(buf, kVersion);
+            put(buf, static_cast<std::uint64_t>(r.evaluated));
+            put(buf, static_cast<std::uint64_t>(r.pruned));
+            put(buf, static_cast<std::uint64_t>(r.bars_skipped));
+            put(buf, static_cast<std::uint64_t>(r.top.size()));
+            for (const auto& row : r.top) put_row(buf, row);
+            publish(dir / (shard_name(idx) + ".done"), buf);
+
+            std::error_code ec;
+            fs::remove(claimed, ec);
+        }
+        return 0;
+    }
+
+    // ---- coordinator ---------------------------------------------------------
+
+    SweepResult run_sharded_sweep(const std::string& dir_str, const ShardJob& job_in, const ShardOptions& opts) {
+        const fs::path dir(dir_str);
+        fs::create_directories(dir);
+        for (const auto& e : fs::directory_iterator(dir))                              // stale state from an earlier job
+            if (e.path().filename().string().rfind("shard_", 0) == 0 || e.path().filename() == "finished")
+                fs::remove(e.path());
+
+        ShardJob job = job_in;
+        job.data_path = fs::absolute(job.data_path).string();
+        const CandleSeries data{ load_candles(job.data_path) };
+
+        const std::uint64_t pairs = job.fasts.size() * job.slows.size();
+        std::uint64_t shards = opts.shards ? opts.shards : std::max<std::size_t>(1, opts.local_workers) * 4;
+        shards = std::max<std::uint64_t>(1, std::min(shards, pairs));
+
+        write_job(dir, job, shards, job_hash(data, job));
+        for (std::uint64_t i = 0; i < shards; ++i) publish(dir / (shard_name(i) + ".todo"), {});
+
+        // Local workers (optional: remote workers can serve the same directory).
+        std::map<long, bool> workers;                                                   // pid -> alive
+        std::size_t respawns = 0;
+#ifdef SUGAR_HAS_FORK
+        for (std::size_t w = 0; w < opts.local_workers; ++w) workers[spawn_worker(opts.worker_exe, dir.string())] = true;
+#else
+        if (opts.local_workers > 0)
+            throw std::runtime_error("Local worker processes need a POSIX system; start workers with --worker DIR");
+#endif
+
+        std::vector<std::size_t> retries(shards, 0);
+        auto retry = [&](std::size_t idx, const fs::path& run_file) {
+            if (++retries[idx] > opts.max_retries)
+                throw std::runtime_error("Shard " + std::to_string(idx) + " failed " + std::to_string(retries[idx]) + " times");
+            std::cerr << "[shard] retrying " << shard_name(idx) << " (attempt " << retries[idx] + 1 << ")\n";
+            requeue(run_file);
+        };
+
+        std::vector<bool> done(shards, false);
+        std::size_t done_count = 0;
+        while (done_count < shards) {
+#ifdef SUGAR_HAS_FORK
+            // A local worker that exits early crashed: requeue its claims, replace it.
+            int status = 0;
+            pid_t pid;
+            while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+                workers.erase(static_cast<long>(pid));
+                const std::string tag = ".run." + host_name() + "." + std::to_string(pid);
+                for (const auto& e : fs::directory_iterator(dir)) {
+                    const std::string name = e.path().filename().string();
+                    if (name.size() > tag.size() && name.compare(name.size() - tag.size(), tag.size(), tag) == 0)
+                        retry(shard_index(name), e.path());
+                }
+                if (respawns++ < opts.local_workers * opts.max_retries)
+                    workers[spawn_worker(opts.worker_exe, dir.string())] = true;
+            }
+#endif
+            const auto now = fs::file_time_type::clock::now();
+            for (const auto& e : fs::directory_iterator(dir)) {
+                const std::string name = e.path().filename().string();
+                const std::size_t idx = shard_index(name);
+                if (idx >= shards) continue;
+                if (e.path().extension() == ".done" && !done[idx]) { done[idx] = true; ++done_count; }
+                else if (name.find(".run.") != std::string::npos && name.find(".tmp") == std::string::npos && !done[idx]) {
+                    std::error_code ec;
+                    const auto age = now - fs::last_write_time(e.path(), ec);
+                    if (!ec && age > std::chrono::duration<double>(opts.stale_after_sec)) retry(idx, e.path());
+                }
+            }
+            if (done_count < shards) std::this_thread::sleep_for(kPoll);
+        }
+        publish(dir / "finished", {});
+
+#ifdef SUGAR_HAS_FORK
+        for (const auto& [pid, alive] : workers) { int st = 0; waitpid(static_cast<pid_t>(pid), &st, 0); }
+#endif
+
+        // Merge in shard order so the result does not depend on completion order.
+        SweepResult out{};
+        TopK top(job.sweep.top_k);
+        for (std::uint64_t i = 0; i < shards; ++i) {
+            const std::string buf = read_file(dir / (shard_name(i) + ".done"));
+            BinReader in(buf);
+            if (in.get<std::uint32_t>() != kDoneMagic || in.get<std::uint32_t>() != kVersion)
+                throw std::runtime_error("Corrupt shard result: " + shard_name(i));
+            out.evaluated += static_cast<std::size_t>(in.get<std::uint64_t>());
+            out.pruned += static_cast<std::size_t>(in.get<std::uint64_t>());
+            out.bars_skipped += static_cast<std::size_t>(in.get<std::uint64_t>());
+            const auto n = in.get<std::uint64_t>();
+            for (std::uint64_t k = 0; k < n; ++k) top.push(get_row(in));
+        }
+        out.top = top.sorted();
+        out.bars_total = out.evaluated * data.size();
+        if (!out.top.empty()) { out.best = out.top.front().r; out.params = out.top.front().p; }
+        return out;
+    }
+
+} // namespace sugar
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sweep.h"
+
+namespace sugar {
+
+    // Multi-process sweep over a shared directory.
+    //
+    // The coordinator writes the job (data path, grid, options) and one
+    // `shard_NNNNN.todo` file per range of (fast, slow) pairs. Workers claim a
+    // shard by renaming its .todo to `.run.<host>.<pid>` (rename is atomic, so
+    // exactly one claimant wins), touch that file as a heartbeat after every
+    // pair, and publish the shard's top-K rows and counters as `.done`.
+    // The coordinator requeues shards whose worker process died or whose
+    // heartbeat went stale, then merges every .done into the final top-K.
+    // Workers may run on other hosts as long as they see the same directory
+    // and the data path stored in the job.
+
+    struct ShardJob {
+        std::string data_path;                                          // stored absolute
+        std::vector<std::size_t> fasts;
+        std::vector<std::size_t> slows;
+        std::vector<std::size_t> rocs;
+        std::vector<double> threshes;
+        SweepOptions sweep;                                             // prune / top_k are honoured per shard
+    };
+
+    struct ShardOptions {
+        std::size_t shards = 0;                                         // 0 = 4 per worker
+        std::size_t local_workers = 0;                                  // processes spawned on this host (POSIX)
+        double stale_after_sec = 120.0;                                 // heartbeat age that marks a claim as dead
+        std::size_t max_retries = 3;                                    // per shard, before the sweep fails
+        std::string worker_exe = "/proc/self/exe";                      // binary launched as `<exe> --worker DIR`
+    };
+
+    // Runs the coordinator until every shard is done; merges as sweep_roc_sma would.
+    SweepResult run_sharded_sweep(const std::string& dir, const ShardJob& job, const ShardOptions& opts);
+
+    // Worker loop: claims and evaluates shards until the coordinator marks the
+    // job finished. Returns a process exit code.
+    int run_shard_worker(const std::string& dir);
+
+} // namespace sugar
@@ -0,0 +1,21 @@
+#include "spsc.h"
+
+namespace sugar {
+
+    WaitMode parse_wait_mode(const std::string& name) {
+        if (name == "spin") return WaitMode::Spin;
+        if (name == "yield") return WaitMode::SpinYield;
+        if (name == "futex") return WaitMode::Futex;
+        throw std::runtime_error("Unknown wait mode (want spin, yield or futex): " + name);
+    }
+
+    const char* wait_mode_name(WaitMode mode) {
+        switch (mode) {
+        case WaitMode::Spin: return "spin";
+        case WaitMode::SpinYield: return "yield";
+        case WaitMode::Futex: return "futex";
+        }
+        return "?";
+    }
+
+} // namespace sugar
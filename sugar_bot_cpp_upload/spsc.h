@@ -0,0 +1,161 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace sugar {
+
+    // How a blocked side of the ring waits for the other one.
+    enum class WaitMode {
+        Spin,                                                           // busy loop: lowest latency, burns a core
+        SpinYield,                                                      // spin a little, then yield the CPU between checks
+        Futex,                                                          // spin a little, then sleep in the kernel until woken
+    };
+
+    WaitMode parse_wait_mode(const std::string& name);                 // "spin", "yield", "futex"
+    const char* wait_mode_name(WaitMode mode);
+
+    inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    inline constexpr std::size_t kCacheLine = 64;
+
+    // Bounded lock-free single-producer / single-consumer ring.
+    //
+    // One thread may push, one other thread may pop. The two indices live on
+    // their own cache lines, each side keeps a private copy of the other's
+    // index and only re-reads the shared one when its copy says full/empty,
+    // so in steady state a push or pop touches no line the other side writes.
+    // Slots are allocated once; nothing allocates per element.
+    //
+    // close() ends the stream: pop() drains what is left, then returns false.
+    template <class T>
+    class SpscRing {
+    public:
+        explicit SpscRing(std::size_t capacity, WaitMode mode = WaitMode::SpinYield)
+            : mask_(round_up(capacity) - 1), slots_(new T[mask_ + 1]), mode_(mode) {
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        std::size_t capacity() const { return mask_ + 1; }
+        WaitMode mode() const { return mode_; }
+
+        // ---- producer side ----
+
+        bool try_push(const T& v) {
+            const std::size_t t = prod_.tail.load(std::memory_order_relaxed);
+            if (t - prod_.head_cache > mask_) {                         // looks full: refresh the consumer's index
+                prod_.head_cache = cons_.head.load(std::memory_order_acquire);
+                if (t - prod_.head_cache > mask_) return false;
+            }
+            slots_[t & mask_] = v;
+            publish(prod_.tail, t + 1, cons_waiting_, cons_wake_);
+            return true;
+        }
+
+        void push(const T& v) {
+            for (unsigned spins = 0; !try_push(v); ++spins)
+                wait(spins, prod_waiting_, prod_wake_, [&] {
+                    return prod_.tail.load(std::memory_order_relaxed) - cons_.head.load(std::memory_order_seq_cst) <= mask_;
+                });
+        }
+
+        void close() {
+            closed_.store(true, std::memory_order_seq_cst);
+            cons_wake_.fetch_add(1, std::memory_order_seq_cst);
+            cons_wake_.notify_all();
+        }
+
+        // ---- consumer side ----
+
+        bool try_pop(T& out) {
+            const std::size_t h = cons_.head.load(std::memory_order_relaxed);
+            if (h == cons_.tail_cache) {                                // looks empty: refresh the producer's index
+                cons_.tail_cache = prod_.tail.load(std::memory_order_acquire);
+                if (h == cons_.tail_cache) return false;
+            }
+            out = slots_[h & mask_];
+            publish(cons_.head, h + 1, prod_waiting_, prod_wake_);
+            return true;
+        }
+
+        // Blocks until an element arrives; false once closed and drained.
+        bool pop(T& out) {
+            for (unsigned spins = 0;; ++spins) {
+                if (try_pop(out)) return true;
+                if (closed_.load(std::memory_order_acquire)) return try_pop(out);
+                wait(spins, cons_waiting_, cons_wake_, [&] {
+                    return closed_.load(std::memory_order_seq_cst)
+                        || prod_.tail.load(std::memory_order_seq_cst) != cons_.head.load(std::memory_order_relaxed);
+                });
+            }
+        }
+
+    private:
+        static constexpr unsigned kSpinBeforeBlock = 256;
+
+        static std::size_t round_up(std::size_t n) {
+            if (n < 2) n = 2;
+            std::size_t p = 1;
+            while (p < n) p <<= 1;
+            return p;
+        }
+
+        // Index store; in futex mode also wakes the other side if it went to sleep.
+        // seq_cst on both the index and the `waiting` flag closes the lost-wakeup race.
+        void publish(std::atomic<std::size_t>& index, std::size_t value,
+            std::atomic<bool>& other_waiting, std::atomic<std::uint32_t>& other_wake) {
+            if (mode_ != WaitMode::Futex) { index.store(value, std::memory_order_release); return; }
+            index.store(value, std::memory_order_seq_cst);
+            if (other_waiting.load(std::memory_order_seq_cst)) {
+                other_wake.fetch_add(1, std::memory_order_seq_cst);
+                other_wake.notify_one();
+            }
+        }
+
+        template <class Ready>
+        void wait(unsigned spins, std::atomic<bool>& waiting, std::atomic<std::uint32_t>& wake, Ready ready) {
+            if (mode_ == WaitMode::Spin || spins < kSpinBeforeBlock) { cpu_relax(); return; }
+            if (mode_ == WaitMode::SpinYield) { std::this_thread::yield(); return; }
+            const std::uint32_t seen = wake.load(std::memory_order_seq_cst);
+            waiting.store(true, std::memory_order_seq_cst);
+            if (!ready()) wake.wait(seen, std::memory_order_seq_cst);   // futex on Linux
+            waiting.store(false, std::memory_order_relaxed);
+        }
+
+        struct alignas(kCacheLine) Producer {
+            std::atomic<std::size_t> tail{ 0 };
+            std::size_t head_cache = 0;
+        };
+        struct alignas(kCacheLine) Consumer {
+            std::atomic<std::size_t> head{ 0 };
+            std::size_t tail_cache = 0;
+        };
+
+        const std::size_t mask_;
+        const std::unique_ptr<T[]> slots_;
+        const WaitMode mode_;
+        Producer prod_;
+        Consumer cons_;
+        alignas(kCacheLine) std::atomic<bool> closed_{ false };
+        std::atomic<bool> cons_waiting_{ false }, prod_waiting_{ false };
+        std::atomic<std::uint32_t> cons_wake_{ 0 }, prod_wake_{ 0 };
+    };
+
+} // namespace sugar
@@ -0,0 +1,32 @@
+#include "strategy.h"
+
+namespace sugar {
+
+    RunContext& thread_context() {
+        thread_local RunContext ctx;
+        return ctx;
+    }
+
+    RunContextPool::Lease RunContextPool::acquire() {
+        std::unique_ptr<RunContext> ctx;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (!idle_.empty()) { ctx = std::move(idle_.back()); idle_.pop_back(); }
+            else ++created_;
+        }
+        if (!ctx) ctx = std::make_unique<RunContext>();                 // outside the lock: first runs are not serialized
+        ctx->trade_log = nullptr;
+        return Lease(this, std::move(ctx));
+    }
+
+    std::size_t RunContextPool::created() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return created_;
+    }
+
+    void RunContextPool::release(std::unique_ptr<RunContext> ctx) {
+        std::lock_guard<std::mutex> lock(mu_);
+        idle_.push_back(std::move(ctx));
+    }
+
+} // namespace sugar
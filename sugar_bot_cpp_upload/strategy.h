@@ -1,5 +1,9 @@
 #pragma once
+#include <cstddef>
 #include <memory>
+#include <mutex>
+#include <vector>
+#include "arena.h"
 #include "series.h"
 #include "metrics.h"
 
@@ -7,10 +11,57 @@
 namespace sugar {
 
 
+	// Everything a run mutates besides its result. Serves one run at a time:
+	// keep one per thread, or lease them from a RunContextPool.
+	struct RunContext {
+		ScratchArena scratch;											// the run's temporaries, rewound when it returns
+		TradeLog* trade_log = nullptr;									// closed trades recorded here; nullptr = off (not owned)
+	};
+
+	RunContext& thread_context();										// this thread's default context (no trade log), made on first use
+
+
+	// Contexts kept warm for reuse: a leased context keeps the scratch its
+	// earlier runs grew, so steady-state runs allocate nothing. Thread safe.
+	class RunContextPool {
+	public:
+		class Lease {													// returns the context to the pool on destruction
+		public:
+			Lease(Lease&& other) noexcept : pool_(other.pool_), ctx_(std::move(other.ctx_)) {}
+			Lease& operator=(Lease&&) = delete;
+			~Lease() { if (ctx_) pool_->release(std::move(ctx_)); }
+
+			RunContext& operator*() const { return *ctx_; }
+			RunContext* operator->() const { return ctx_.get(); }
+
+		private:
+			friend class RunContextPool;
+			Lease(RunContextPool* pool, std::unique_ptr<RunContext> ctx) : pool_(pool), ctx_(std::move(ctx)) {}
+			RunContextPool* pool_;
+			std::unique_ptr<RunContext> ctx_;
+		};
+
+		Lease acquire();												// an idle context (trade log cleared) or a new one
+		std::size_t created() const;									// contexts made so far: the most leased at once
+
+	private:
+		void release(std::unique_ptr<RunContext> ctx);
+
+		mutable std::mutex mu_;
+		std::vector<std::unique_ptr<RunContext>> idle_;
+		std::size_t created_ = 0;
+	};
+
+
 	class IStrategy {													// abstract class, can not be referenced directly
 	public:																
 		virtual ~IStrategy() = default;									// call destructor in derived classes through pointer operations
-		virtual BacktestResult run(const CandleSeries& data) = 0;		// virtual base function "run" with contract definition 
+
+		// const and reentrant: a run reads only the strategy's parameters and
+		// keeps its mutable state in ctx, so one instance may run on any number
+		// of threads at once, each with its own context.
+		virtual BacktestResult run(const CandleSeries& data, RunContext& ctx) const = 0;
+		BacktestResult run(const CandleSeries& data) const { return run(data, thread_context()); }	// on this thread's context
 	};
 
 
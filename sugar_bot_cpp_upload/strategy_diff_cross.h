@@ -1,25 +1,34 @@
-#pragma once
-#include <utility>
-#include "strategy.h"
-#include "indicator.h"
-
-namespace sugar {
-
-                                                                                        // Go long when (A - B) crosses up through +thresh.
-                                                                                        // Exit (or flip) when it crosses down through -thresh.
-                                                                                        // Units: whatever A and B output; choose thresh accordingly (e.g., % points).
-    class DiffCrossStrategy final : public IStrategy {
-    public:
-        DiffCrossStrategy(IndicatorPtr a, IndicatorPtr b, double thresh_percent)
-            : a_(std::move(a)), b_(std::move(b)), thresh_(thresh_percent) {
-        }
-
-        BacktestResult run(const CandleSeries& data) override;
-
-    private:
-        IndicatorPtr a_;
-        IndicatorPtr b_;
-        double thresh_{};
-    };
-
-} // namespace sugar
+#pragma once
+#include <span>
+#include <utility>
+#include <vector>
+#include "strategy.h"
+#include "indicator.h"
+
+namespace sugar {
+
+                                                                                        // Go long when (A - B) crosses up through +thresh.
+                                                                                        // Exit (or flip) when it crosses down through -thresh.
+                                                                                        // Units: whatever A and B output; choose thresh accordingly (e.g., % points).
+    class DiffCrossStrategy final : public IStrategy {
+    public:
+        DiffCrossStrategy(IndicatorPtr a, IndicatorPtr b, double thresh_percent)
+            : a_(std::move(a)), b_(std::move(b)), thresh_(thresh_percent) {
+        }
+
+        using IStrategy::run;
+        BacktestResult run(const CandleSeries& data, RunContext& ctx) const override;
+
+        // Same rule over values already computed for `data` (A, B and closes
+        // aligned to it), so callers can share indicator series across runs.
+        static BacktestResult run_on(const CandleSeries& data, std::span<const double> av,
+            std::span<const double> bv, std::span<const double> closes, double thresh,
+            TradeLog* log = nullptr);
+
+    private:
+        IndicatorPtr a_;
+        IndicatorPtr b_;
+        double thresh_{};
+    };
+
+} // namespace sugar
@@ -1,8 +1,13 @@
 #include "strategy_roc_sma.h"
 #include "indicators_sma.h"
-#include "indicators_composite.h"
+#include "indicators_roc.h"
+#include "arena.h"
+#include "profile.h"
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
 
 
 namespace sugar {
@@ -16,22 +21,64 @@ namespace sugar {
 	}
 
 
-	BacktestResult RocSmaCrossoverStrategy::run(const CandleSeries& data) {
-		BacktestResult r{};
-		if (data.size() == 0 || sma_fast_ == 0 || sma_slow_ == 0 || roc_len_ == 0) return r;
+	BacktestResult RocSmaCrossoverStrategy::run(const CandleSeries& data, RunContext& ctx) const {
+		return run_impl(data, nullptr, nullptr, nullptr, nullptr, ctx);
+	}
 
 
-		auto f = std::make_shared<SMAIndicator>(sma_fast_);
-		auto s = std::make_shared<SMAIndicator>(sma_slow_);
+	BacktestResult RocSmaCrossoverStrategy::run(const CandleSeries& data, const PruneLimit& limit,
+		std::size_t& bars_skipped, RunContext& ctx) const {
+		bars_skipped = 0;
+		return run_impl(data, &limit, &bars_skipped, nullptr, nullptr, ctx);
+	}
 
 
-		ROCOfIndicator f_mom{ f, roc_len_ };
-		ROCOfIndicator s_mom{ s, roc_len_ };
+	BacktestResult RocSmaCrossoverStrategy::run(const CandleSeries& data, RocSmaState& state, bool& captured,
+		RunContext& ctx) const {
+		return run_impl(data, nullptr, nullptr, &state, &captured, ctx);
+	}
 
 
-		const auto fv = f_mom.compute(data);
-		const auto sv = s_mom.compute(data);
-		const auto closes = data.closes();
+	// Window sum of sma_over_series at index j, replaying its exact accumulation order.
+	static double sma_window_sum(std::span<const double> v, std::size_t n, std::size_t j) {
+		double sum = std::accumulate(v.begin(), v.begin() + n, 0.0);
+		for (std::size_t i = n; i <= j; ++i) sum += v[i] - v[i - n];
+		return sum;
+	}
+
+
+	// ROC of two SMA samples with roc_over_series' guards.
+	static double roc_of(double prev, double cur) {
+		if (prev == 0.0 || !std::isfinite(prev) || !std::isfinite(cur)) return std::numeric_limits<double>::quiet_NaN();
+		return (cur / prev - 1.0) * 100.0;
+	}
+
+
+	bool RocSmaCrossoverStrategy::can_capture(std::size_t bars) const {
+		if (sma_fast_ == 0 || sma_slow_ == 0 || roc_len_ == 0) return false;
+		return bars >= roc_len_ + std::max(sma_fast_, sma_slow_);
+	}
+
+
+	BacktestResult RocSmaCrossoverStrategy::run_impl(const CandleSeries& data,
+		const PruneLimit* limit, std::size_t* bars_skipped,
+		RocSmaState* state, bool* captured, RunContext& ctx) const {
+		SUGAR_PROF_SCOPE("strategy/roc_sma");
+		if (captured) *captured = false;
+		BacktestResult r{};
+		if (data.size() == 0 || sma_fast_ == 0 || sma_slow_ == 0 || roc_len_ == 0) return r;
+
+
+		// Per-run temporaries live in the context's scratch arena (rewound on return),
+		// so a sweep does no heap allocation per combo once the arena has grown.
+		// Same kernels as ROCOfIndicator(SMAIndicator), so results are bit-identical.
+		ScratchScope scratch(ctx.scratch);
+		const std::size_t n = data.size();
+		std::pmr::vector<double> closes(n, scratch.resource()), tmp(n, scratch.resource());
+		std::pmr::vector<double> fv(n, scratch.resource()), sv(n, scratch.resource());
+		data.closes_into(closes);
+		sma_into(closes, sma_fast_, tmp); roc_into(tmp, roc_len_, fv);
+		sma_into(closes, sma_slow_, tmp); roc_into(tmp, roc_len_, sv);
 
 
 		// find first usable index
@@ -39,36 +86,188 @@ namespace sugar {
 		for (; i0 < fv.size(); ++i0) {
 			if (!std::isnan(fv[i0]) && !std::isnan(sv[i0])) { found = true; break; }
 		}
-		if (!found) return r;
+		auto capture_sums = [&]() {
+			const std::size_t last = closes.size() - 1, lag = last - roc_len_;
+			state->bars = closes.size();
+			state->fast_sum = sma_window_sum(closes, sma_fast_, last); state->fast_lag_sum = sma_window_sum(closes, sma_fast_, lag);
+			state->slow_sum = sma_window_sum(closes, sma_slow_, last); state->slow_lag_sum = sma_window_sum(closes, sma_slow_, lag);
+			*captured = true;
+		};
+		if (!found) {
+			if (state && can_capture(closes.size())) { *state = RocSmaState{}; capture_sums(); }	// nothing usable yet is still a valid state
+			return r;
+		}
 		r.best_start_date = data[i0].date;
 
 
 		bool long_on = false; double entry = 0.0; double equity = 0.0; double peak = 0.0;
+		MetricsAccumulator acc;
+		const std::size_t check_every = (limit && limit->check_every > 0) ? limit->check_every : 1;
 
 
-		for (std::size_t i = i0; i < closes.size(); ++i) {
-			const double diff = fv[i] - sv[i];
-			if (!long_on && diff >= thresh_) {
-				long_on = true; entry = closes[i];
+		// Bars run in blocks ending where the bound is checked (bars i0, i0 + check_every, ...),
+		// so the inner loop makes no calls and its running sums can stay in registers.
+		for (std::size_t b = i0; b < closes.size();) {
+			const std::size_t e = !limit ? closes.size() : std::min(closes.size(), b == i0 ? i0 + 1 : b + check_every);
+			for (std::size_t i = b; i < e; ++i) {
+				const double diff = fv[i] - sv[i];
+				if (!long_on && diff >= thresh_) {
+					long_on = true; entry = closes[i]; acc.open(i, entry);
+				}
+				else if (long_on && diff <= -thresh_) {
+					const double trade_ret = (closes[i] / entry - 1.0) * 100.0;
+					equity += trade_ret; ++r.trades; peak = std::max(peak, equity);
+					r.max_drawdown = std::max(r.max_drawdown, peak - equity);
+					long_on = false; acc.close(i, trade_ret, ctx.trade_log);
+				}
+				acc.bar(equity, closes[i]);
 			}
-			else if (long_on && diff <= -thresh_) {
-				const double trade_ret = (closes[i] / entry - 1.0) * 100.0;
-				equity += trade_ret; ++r.trades; peak = std::max(peak, equity);
-				r.max_drawdown = std::max(r.max_drawdown, peak - equity);
-				long_on = false;
+			b = e;
+
+			const std::size_t i = e - 1;
+			if (limit && (i - i0) % check_every == 0
+				&& limit->hopeless(i, equity, long_on, entry, r.max_drawdown)) {
+				r.pnl = equity; r.pruned = true; r.risk = acc.finish();
+				*bars_skipped = closes.size() - i - 1;
+				return r;
 			}
 		}
 
 
+		if (state && can_capture(closes.size())) {
+			capture_sums();
+			state->started = true; state->long_on = long_on;
+			state->entry = entry; state->equity = equity; state->peak = peak;
+			state->r = r; state->acc = acc;
+		}
+
+
 		if (long_on) {
 			const double trade_ret = (closes.back() / entry - 1.0) * 100.0;
 			equity += trade_ret; ++r.trades;
 			peak = std::max(peak, equity);
 			r.max_drawdown = std::max(r.max_drawdown, peak - equity);
+			acc.close(closes.size() - 1, trade_ret, ctx.trade_log);
+		}
+
+
+		r.pnl = equity; r.risk = acc.finish(); return r;
+	}
+
+
+	BacktestResult RocSmaCrossoverStrategy::run_window(const SmaBank& bank, std::size_t begin,
+		std::size_t end, TradeTrace* trace, RunContext& ctx) const {
+		SUGAR_PROF_SCOPE("strategy/roc_sma_window");
+		BacktestResult r{};
+		const auto& closes = bank.closes();
+		end = std::min(end, closes.size());
+		if (begin >= end || sma_fast_ == 0 || sma_slow_ == 0 || roc_len_ == 0) return r;
+		const auto& fs = bank.sma(sma_fast_);
+		const auto& ss = bank.sma(sma_slow_);
+		const std::size_t k = roc_len_;
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+		auto mom = [&](const std::vector<double>& v, std::size_t i) { return i < k ? nan : roc_of(v[i - k], v[i]); };
+
+
+		// find first usable index inside the window
+		std::size_t i0 = begin;
+		for (; i0 < end; ++i0) {
+			if (!std::isnan(mom(fs, i0)) && !std::isnan(mom(ss, i0))) break;
+		}
+		if (trace) trace->bar_pnl.insert(trace->bar_pnl.end(), i0 - begin, 0.0);	// flat until the first usable bar
+		if (i0 == end) return r;
+		r.best_start_date = bank.series()[i0].date;
+
+
+		bool long_on = false; double entry = 0.0; double equity = 0.0; double peak = 0.0;
+		MetricsAccumulator acc;
+		auto close_trade = [&](std::size_t i) {
+			const double trade_ret = (closes[i] / entry - 1.0) * 100.0;
+			equity += trade_ret; ++r.trades; peak = std::max(peak, equity);
+			r.max_drawdown = std::max(r.max_drawdown, peak - equity);
+			acc.close(i, trade_ret, ctx.trade_log);
+			if (trace) trace->trade_returns.push_back(trade_ret);
+		};
+		double marked = 0.0;												// equity marked to the close, for bar_pnl
+		auto mark = [&](std::size_t i) {
+			if (!trace) return;
+			const double now = equity + (long_on ? (closes[i] / entry - 1.0) * 100.0 : 0.0);
+			trace->bar_pnl.push_back(now - marked); marked = now;
+		};
+
+
+		for (std::size_t i = i0; i < end; ++i) {
+			const double diff = mom(fs, i) - mom(ss, i);
+			if (!long_on && diff >= thresh_) {
+				long_on = true; entry = closes[i]; acc.open(i, entry);
+			}
+			else if (long_on && diff <= -thresh_) {
+				close_trade(i);
+				long_on = false;
+			}
+			acc.bar(equity, closes[i]);											// as run(): the forced close adds no bar
+			if (i + 1 < end) mark(i);
+		}
+		if (long_on) close_trade(end - 1);
+		long_on = false; mark(end - 1);											// last bar marks the forced close
+
+
+		r.pnl = equity; r.risk = acc.finish(); return r;
+	}
+
+
+	BacktestResult RocSmaCrossoverStrategy::resume(const CandleSeries& data, const RocSmaState& from,
+		RocSmaState& state, RunContext& ctx) const {
+		if (data.size() < from.bars || !can_capture(static_cast<std::size_t>(from.bars)))
+			throw std::invalid_argument("RocSmaCrossoverStrategy::resume: state does not fit this series");
+		state = from;
+		BacktestResult& r = state.r;
+		const auto closes = data.closes();
+		const std::size_t f = sma_fast_, s = sma_slow_, k = roc_len_;
+
+		// Advance lead (bar i) and lag (bar i-k) window sums exactly as sma_over_series would.
+		for (std::size_t i = static_cast<std::size_t>(from.bars); i < closes.size(); ++i) {
+			state.fast_sum += closes[i] - closes[i - f];
+			state.slow_sum += closes[i] - closes[i - s];
+			state.fast_lag_sum += closes[i - k] - closes[i - k - f];
+			state.slow_lag_sum += closes[i - k] - closes[i - k - s];
+			const double fv = roc_of(state.fast_lag_sum / static_cast<double>(f), state.fast_sum / static_cast<double>(f));
+			const double sv = roc_of(state.slow_lag_sum / static_cast<double>(s), state.slow_sum / static_cast<double>(s));
+
+			if (!state.started) {
+				if (std::isnan(fv) || std::isnan(sv)) continue;
+				state.started = true; r.best_start_date = data[i].date;
+			}
+
+			const double diff = fv - sv;
+			if (!state.long_on && diff >= thresh_) {
+				state.long_on = true; state.entry = closes[i]; state.acc.open(i, state.entry);
+			}
+			else if (state.long_on && diff <= -thresh_) {
+				const double trade_ret = (closes[i] / state.entry - 1.0) * 100.0;
+				state.equity += trade_ret; ++r.trades; state.peak = std::max(state.peak, state.equity);
+				r.max_drawdown = std::max(r.max_drawdown, state.peak - state.equity);
+				state.long_on = false; state.acc.close(i, trade_ret, ctx.trade_log);
+			}
+			state.acc.bar(state.equity, closes[i]);
+		}
+		state.bars = closes.size();
+
+
+		BacktestResult out = r;
+		double equity = state.equity, peak = state.peak;
+		MetricsAccumulator acc = state.acc;
+		if (state.long_on) {
+			const double trade_ret = (closes.back() / state.entry - 1.0) * 100.0;
+			equity += trade_ret; ++out.trades;
+			peak = std::max(peak, equity);
+			out.max_drawdown = std::max(out.max_drawdown, peak - equity);
+			acc.close(closes.size() - 1, trade_ret, ctx.trade_log);
 		}
+		if (!state.started) return BacktestResult{};
 
 
-		r.pnl = equity; return r;
+		out.pnl = equity; out.risk = acc.finish(); return out;
 	}
 
 
@@ -1,11 +1,30 @@
 #pragma once
 #include "strategy.h"
 #include "indicator.h"
+#include "prune.h"
+#include "indicators_sma.h"
+#include <cstdint>
 
 
 namespace sugar {
 
 
+																				// Everything needed to continue a run over bars appended later,
+																				// without recomputing the history (append-aware result cache).
+																				// The SMA window sums are kept at the last bar and roc_len bars back
+																				// so resumed values are bit-identical to a full recompute.
+	struct RocSmaState {														//
+		std::uint64_t bars{};													// candles consumed
+		double fast_sum{}, fast_lag_sum{};										// fast SMA window sum at bars-1 and bars-1-roc_len
+		double slow_sum{}, slow_lag_sum{};										// slow SMA window sum, same two bars
+		bool started{};															// first usable bar reached
+		bool long_on{};															//
+		double entry{}, equity{}, peak{};										//
+		BacktestResult r{};														// trades, max_drawdown, best_start_date so far
+		MetricsAccumulator acc{};												// risk metrics so far, before the final forced close
+	};
+
+
 	class RocSmaCrossoverStrategy final : public IStrategy {					//
 	public:																		//
 		RocSmaCrossoverStrategy(std::size_t sma_fast,							//
@@ -14,10 +33,40 @@ namespace sugar {
 			double thresh_percent);												//
 
 
-		BacktestResult run(const CandleSeries& data) override;					//
+		using IStrategy::run;													//
+		BacktestResult run(const CandleSeries& data, RunContext& ctx) const override;	//
+
+																				// Same run, abandoned once limit says the top-K is out of reach.
+																				// bars_skipped receives the number of strategy-loop bars not visited.
+		BacktestResult run(const CandleSeries& data, const PruneLimit& limit,	//
+			std::size_t& bars_skipped, RunContext& ctx = thread_context()) const;	//
+
+																				// Full run that also captures the state before the final forced close.
+																				// Returns false in `captured` when the series is too short to resume from.
+		BacktestResult run(const CandleSeries& data, RocSmaState& state, bool& captured,	//
+			RunContext& ctx = thread_context()) const;							//
+
+																				// Continue `from` over bars [from.bars, data.size()). data's first
+																				// from.bars candles must be the ones the state was captured on.
+		BacktestResult resume(const CandleSeries& data, const RocSmaState& from,	//
+			RocSmaState& state, RunContext& ctx = thread_context()) const;		//
+
+																				// Trading loop over bars [begin, end) on SMAs precomputed for the whole
+																				// series (bank must hold both periods). Indicator warm-up may use bars
+																				// before `begin` (causal, no look-ahead), so this is not run(slice).
+																				// With begin = 0 and end = size() it equals run(bank.series()).
+																				// trace, if given, gets the closed trades and one bar_pnl per bar appended.
+		BacktestResult run_window(const SmaBank& bank, std::size_t begin,		//
+			std::size_t end, TradeTrace* trace = nullptr,						//
+			RunContext& ctx = thread_context()) const;							//
 
 
 	private:																	//
+		BacktestResult run_impl(const CandleSeries& data,						//
+			const PruneLimit* limit, std::size_t* bars_skipped,					//
+			RocSmaState* state, bool* captured, RunContext& ctx) const;		//
+		bool can_capture(std::size_t bars) const;								// lag sums need bars-1-roc_len past both warm-ups
+
 		std::size_t sma_fast_{};												//
 		std::size_t sma_slow_{};												//
 		std::size_t roc_len_{};													//
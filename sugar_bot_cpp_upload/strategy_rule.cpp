@@ -0,0 +1,60 @@
+#include "strategy_rule.h"
+#include "arena.h"
+#include "profile.h"
+#include <algorithm>
+
+namespace sugar {
+
+    BacktestResult RuleStrategy::run(const CandleSeries& data, RunContext& ctx) const {
+        SUGAR_PROF_SCOPE("strategy/rule");
+        BacktestResult r{};
+        const std::size_t n = data.size();
+        if (n == 0) return r;
+
+        ScratchScope scratch(ctx.scratch);
+        std::pmr::vector<double> enter(n, scratch.resource()), exit(n, scratch.resource()), closes(n, scratch.resource());
+        const std::size_t i0 = program_.evaluate(data, enter, exit, ctx.scratch);
+        if (i0 >= n) return r;
+        data.closes_into(closes);
+        r.best_start_date = data[i0].date;
+
+        bool long_on = false;
+        double entry = 0.0;
+        double equity = 0.0;
+        double peak = 0.0;
+        MetricsAccumulator acc;
+
+        for (std::size_t i = i0; i < n; ++i) {
+            if (!long_on && enter[i] != 0.0) {
+                long_on = true;
+                entry = closes[i];
+                acc.open(i, entry);
+            }
+            else if (long_on && exit[i] != 0.0) {
+                const double trade_ret = (closes[i] / entry - 1.0) * 100.0;
+                equity += trade_ret;
+                ++r.trades;
+                peak = std::max(peak, equity);
+                r.max_drawdown = std::max(r.max_drawdown, peak - equity);
+                long_on = false;
+                acc.close(i, trade_ret, ctx.trade_log);
+            }
+            acc.bar(equity, closes[i]);
+        }
+
+        // Close any open position at the last bar
+        if (long_on) {
+            const double trade_ret = (closes[n - 1] / entry - 1.0) * 100.0;
+            equity += trade_ret;
+            ++r.trades;
+            peak = std::max(peak, equity);
+            r.max_drawdown = std::max(r.max_drawdown, peak - equity);
+            acc.close(n - 1, trade_ret, ctx.trade_log);
+        }
+
+        r.pnl = equity;
+        r.risk = acc.finish();
+        return r;
+    }
+
+} // namespace sugar
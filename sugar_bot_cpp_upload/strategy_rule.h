@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include "strategy.h"
+#include "rule.h"
+
+namespace sugar {
+
+    // Long-only strategy driven by a compiled rule: go long on a bar whose
+    // enter condition holds, go flat on a bar whose exit condition holds,
+    // close any open position at the last bar. Same bookkeeping as the
+    // hand-written strategies, so `enter: d >= t; exit: d <= -t` with
+    // d = roc(sma(close,F),R) - roc(sma(close,S),R) reproduces
+    // RocSmaCrossoverStrategy(F, S, R, t) exactly.
+    class RuleStrategy final : public IStrategy {
+    public:
+        explicit RuleStrategy(RuleProgram program) : program_(std::move(program)) {}
+        explicit RuleStrategy(const std::string& text) : program_(RuleProgram::compile(text)) {}
+
+        using IStrategy::run;
+        BacktestResult run(const CandleSeries& data, RunContext& ctx) const override;
+
+        const RuleProgram& program() const { return program_; }
+
+    private:
+        RuleProgram program_;
+    };
+
+} // namespace sugar
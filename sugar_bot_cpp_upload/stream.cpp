@@ -0,0 +1,414 @@
+#include "stream.h"
+#include "csv.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define SUGAR_HAS_POSIX_IO 1
+#endif
+
+namespace sugar {
+
+    namespace {
+        inline double qnan() { return std::numeric_limits<double>::quiet_NaN(); }
+
+        // Same guards as roc_over_series.
+        inline double roc_of(double prev, double cur) {
+            if (prev == 0.0 || !std::isfinite(prev) || !std::isfinite(cur)) return qnan();
+            return (cur / prev - 1.0) * 100.0;
+        }
+
+        // parse_candle_line, with a malformed number dropping the line instead of ending the feed.
+        inline bool parse_feed_line(std::string& line, bool& first_line, Candle& out) {
+            try { return parse_candle_line(line, first_line, out); }
+            catch (const std::exception&) { return false; }
+        }
+    }
+
+    // ---- RocSmaStream ----------------------------------------------------------
+
+    double RocSmaStream::Sma::push(double x) {
+        const std::size_t n = win.size();
+        if (n == 0) return qnan();
+        if (seen < n) {                                                 // seed: plain left-to-right sum, like std::accumulate
+            sum += x; win[seen++] = x;
+            return seen == n ? sum / static_cast<double>(n) : qnan();
+        }
+        sum += x - win[pos];
+        win[pos] = x; pos = (pos + 1) % n;
+        return sum / static_cast<double>(n);
+    }
+
+    double RocSmaStream::Lag::push_and_get(double x) {
+        const std::size_t n = ring.size();                              // k + 1
+        ring[seen % n] = x;
+        const bool have = ++seen >= n;
+        return have ? ring[seen % n] : qnan();                          // slot after x holds the value from k pushes ago
+    }
+
+    RocSmaStream::RocSmaStream(std::size_t sma_fast, std::size_t sma_slow, std::size_t roc_len, double thresh_percent)
+        : thresh_(thresh_percent) {
+        fast_.win.resize(sma_fast);
+        slow_.win.resize(sma_slow);
+        if (roc_len > 0) {                                              // roc_len 0 never trades, as in the batch run
+            fast_lag_.ring.assign(roc_len + 1, qnan());
+            slow_lag_.ring.assign(roc_len + 1, qnan());
+        }
+    }
+
+    bool RocSmaStream::on_bar(const Candle& c, StreamSignal& sig) {
+        const std::uint64_t i = bars_++;
+        last_close_ = c.close;
+        if (fast_lag_.ring.empty() || fast_.win.empty() || slow_.win.empty()) return false;
+
+        const double fs = fast_.push(c.close), ss = slow_.push(c.close);
+        const double fv = roc_of(fast_lag_.push_and_get(fs), fs);
+        const double sv = roc_of(slow_lag_.push_and_get(ss), ss);
+
+        if (!started_) {                                                // first usable bar
+            if (std::isnan(fv) || std::isnan(sv)) return false;
+            started_ = true; r_.best_start_date = c.date;
+        }
+
+        const double diff = fv - sv;
+        bool fired = false;
+        if (!long_on_ && diff >= thresh_) {
+            long_on_ = true; entry_ = c.close; acc_.open(i, entry_);
+            sig = { StreamSignal::Kind::Entry, i, c.date, c.close, 0.0 };
+            fired = true;
+        }
+        else if (long_on_ && diff <= -thresh_) {
+            const double trade_ret = (c.close / entry_ - 1.0) * 100.0;
+            equity_ += trade_ret; ++r_.trades; peak_ = std::max(peak_, equity_);
+            r_.max_drawdown = std::max(r_.max_drawdown, peak_ - equity_);
+            long_on_ = false; acc_.close(i, trade_ret);
+            sig = { StreamSignal::Kind::Exit, i, c.date, c.close, trade_ret };
+            fired = true;
+        }
+        acc_.bar(equity_, c.close);
+        return fired;
+    }
+
+    BacktestResult RocSmaStream::result() const {
+        if (!started_) return {};
+        BacktestResult out = r_;
+        double equity = equity_, peak = peak_;
+        MetricsAccumulator acc = acc_;
+        if (long_on_) {
+            const double trade_ret = (last_close_ / entry_ - 1.0) * 100.0;
+            equity += trade_ret; ++out.trades;
+            peak = std::max(peak, equity);
+            out.max_drawdown = std::max(out.max_drawdown, peak - equity);
+            acc.close(bars_ - 1, trade_ret);
+        }
+        out.pnl = equity;
+        out.risk = acc.finish();
+        return out;
+    }
+
+    // ---- SwingBreakoutStream ---------------------------------------------------
+
+    SwingBreakoutStream::SwingBreakoutStream(std::size_t left_bars, std::size_t right_bars, bool use_ema10_stop,
+        int days_above_10_required, double pct_gain_threshold, int days_for_gain, double max_loss_pct)
+        : left_(left_bars), right_(right_bars), use_ema10_stop_(use_ema10_stop),
+        days_above_10_required_(days_above_10_required), pct_gain_threshold_(pct_gain_threshold),
+        days_for_gain_(days_for_gain), max_loss_pct_(max_loss_pct),
+        highs_(left_bars + right_bars + 1, 0.0), ema10_(qnan()),
+        last_swing_high_(qnan()), breakout_low_(qnan()), breakout_price_(qnan()), entry_price_(qnan()) {
+    }
+
+    void SwingBreakoutStream::reset_breakout() {
+        bo_flagged_ = false;
+        breakout_low_ = qnan();
+        breakout_price_ = qnan();
+        breakout_bar_ = -1;
+        days_above_10_ = 0;
+        validation_passed_ = false;
+        entry_price_ = qnan();
+    }
+
+    bool SwingBreakoutStream::on_bar(const Candle& c, StreamSignal& sig) {
+        const std::uint64_t i = bars_++;
+        const double close = c.close, high = c.high, low = c.low;
+        last_close_ = close;
+        const std::size_t W = highs_.size();
+        highs_[i % W] = high;
+
+        // EMA(10) with an SMA seed, as EMAIndicator on a series of >= 10 bars.
+        constexpr std::size_t n = 10;
+        if (i < n) {
+            ema_sum_ += close;
+            if (i + 1 == n) ema10_ = ema_sum_ / static_cast<double>(n);
+        }
+        else {
+            const double alpha = 2.0 / (static_cast<double>(n) + 1.0);
+            ema10_ = alpha * close + (1.0 - alpha) * ema10_;
+        }
+        const double e = ema10_;
+
+        bool is_breakout = false;
+        bool is_swing_failure = false;
+
+        // --- pivot high at p = i - right, confirmed now ---
+        if (right_ > 0 && i >= right_ && i - right_ >= left_) {
+            const std::uint64_t p = i - right_;
+            const double ph = highs_[p % W];
+            bool is_pivot_high = true;
+            for (std::uint64_t j = p - left_; j <= i; ++j) {
+                if (j == p) continue;
+                if (highs_[j % W] >= ph) { is_pivot_high = false; break; }
+            }
+            if (is_pivot_high) {
+                last_swing_high_ = ph;
+                if (!trend_up_) bo_flagged_ = false;
+            }
+        }
+
+        // --- stop loss from entry ---
+        if (trend_up_ && !std::isnan(entry_price_)) {
+            if ((entry_price_ - close) / entry_price_ * 100.0 >= max_loss_pct_) is_swing_failure = true;
+        }
+
+        // --- validation: breakout low, days above EMA10, gain target ---
+        if (trend_up_ && !validation_passed_ && !std::isnan(breakout_low_)) {
+            if (low < breakout_low_) is_swing_failure = true;
+        }
+        if (trend_up_ && !validation_passed_ && breakout_bar_ >= 0) {
+            if (!std::isnan(e) && close > e) ++days_above_10_;
+            else days_above_10_ = 0;
+        }
+        if (trend_up_ && !validation_passed_ && breakout_bar_ >= 0) {
+            const long long bars_since_breakout = static_cast<long long>(i) - breakout_bar_;
+            const double pct_gain = (close - breakout_price_) / breakout_price_ * 100.0;
+            if (days_above_10_ >= days_above_10_required_ && pct_gain >= pct_gain_threshold_
+                && bars_since_breakout <= days_for_gain_) {
+                validation_passed_ = true;
+            }
+        }
+
+        // --- EMA10 stop ---
+        if (trend_up_ && use_ema10_stop_) {
+            if (!std::isnan(e) && close < e) is_swing_failure = true;
+        }
+
+        // --- breakout detection ---
+        if (!std::isnan(last_swing_high_) && high > last_swing_high_ && !trend_up_ && !bo_flagged_) {
+            if (close < last_swing_high_) is_swing_failure = true;
+            else {
+                is_breakout = true;
+                trend_up_ = true;
+                bo_flagged_ = true;
+                entry_price_ = close;
+                breakout_price_ = close;
+                breakout_low_ = low;
+                breakout_bar_ = static_cast<long long>(i);
+                days_above_10_ = (!std::isnan(e) && close > e) ? 1 : 0;
+                validation_passed_ = false;
+                if (r_.best_start_date == 0) r_.best_start_date = c.date;
+            }
+        }
+
+        // --- execute ---
+        bool fired = false;
+        if (is_breakout && !long_on_) {
+            long_on_ = true; entry_ = close; acc_.open(i, entry_);
+            sig = { StreamSignal::Kind::Entry, i, c.date, close, 0.0 };
+            fired = true;
+        }
+        if (is_swing_failure && long_on_) {
+            const double trade_ret = (close / entry_ - 1.0) * 100.0;
+            equity_ += trade_ret; ++r_.trades;
+            peak_ = std::max(peak_, equity_);
+            r_.max_drawdown = std::max(r_.max_drawdown, peak_ - equity_);
+            long_on_ = false;
+            trend_up_ = false;
+            reset_breakout();
+            acc_.close(i, trade_ret);
+            sig = { StreamSignal::Kind::Exit, i, c.date, close, trade_ret };
+            fired = true;
+        }
+        acc_.bar(equity_, close);
+        return fired;
+    }
+
+    BacktestResult SwingBreakoutStream::result() const {
+        BacktestResult out = r_;
+        double equity = equity_, peak = peak_;
+        MetricsAccumulator acc = acc_;
+        if (long_on_) {
+            const double trade_ret = (last_close_ / entry_ - 1.0) * 100.0;
+            equity += trade_ret; ++out.trades;
+            peak = std::max(peak, equity);
+            out.max_drawdown = std::max(out.max_drawdown, peak - equity);
+            acc.close(bars_ - 1, trade_ret);
+        }
+        out.pnl = equity;
+        out.risk = acc.finish();
+        return out;
+    }
+
+    // ---- StreamRunner ----------------------------------------------------------
+
+    StreamRunner::StreamRunner(IStreamStrategy& strategy, SignalFn on_signal)
+        : strategy_(strategy), on_signal_(std::move(on_signal)) {
+    }
+
+    void StreamRunner::on_line(std::string& line, StreamClock::time_point arrived) {
+        ++stats_.lines;
+        Candle c;
+        if (parse_feed_line(line, first_line_, c)) on_bar(c, arrived);
+    }
+
+    void StreamRunner::on_bar(const Candle& c, StreamClock::time_point arrived) {
+        if (c.ts < last_ts_) { ++stats_.rejected; return; }            // out of order: the strategies assume time moves forward
+        last_ts_ = c.ts;
+        ++stats_.bars;
+
+        StreamSignal sig;
+        const bool fired = strategy_.on_bar(c, sig);
+        if (fired && on_signal_) on_signal_(sig);
+
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(StreamClock::now() - arrived).count();
+        const auto lat = static_cast<std::uint64_t>(ns < 0 ? 0 : ns);
+        stats_.decision.record(lat);
+        if (fired) { ++stats_.signals; stats_.signal.record(lat); }
+    }
+
+    // ---- LineFeed --------------------------------------------------------------
+
+#ifdef SUGAR_HAS_POSIX_IO
+
+    LineFeed::LineFeed(const std::string& source, int poll_ms) : poll_ms_(poll_ms < 1 ? 1 : poll_ms) {
+        if (source == "-") { fd_ = ::dup(STDIN_FILENO); }
+        else if (source.rfind("unix:", 0) == 0) {
+            const std::string path = source.substr(5);
+            sockaddr_un addr{};
+            if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path too long: " + path);
+            addr.sun_family = AF_UNIX;
+            std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+            fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd_ >= 0 && ::connect(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+                ::close(fd_); fd_ = -1;
+            }
+        }
+        else {
+            tail_ = source.rfind("tail:", 0) == 0;
+            const std::string path = tail_ ? source.substr(5) : source;
+            fd_ = ::open(path.c_str(), O_RDONLY);                       // blocks on a FIFO until a writer shows up
+        }
+        if (fd_ < 0) throw std::runtime_error("Failed to open feed '" + source + "': " + std::strerror(errno));
+    }
+
+    LineFeed::~LineFeed() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    bool LineFeed::fill(const std::atomic<bool>& stop) {
+        char chunk[1 << 14];
+        for (;;) {
+            if (stop.load(std::memory_order_relaxed)) return false;
+            pollfd pfd{ fd_, POLLIN, 0 };
+            const int ready = ::poll(&pfd, 1, poll_ms_);                // wake up now and then to honour `stop`
+            if (ready < 0 && errno != EINTR) throw std::runtime_error(std::string("Feed poll failed: ") + std::strerror(errno));
+            if (ready <= 0) continue;
+            const ssize_t got = ::read(fd_, chunk, sizeof(chunk));
+            if (got > 0) {
+                last_read_ = StreamClock::now();
+                if (pos_ > 0) { buf_.erase(0, pos_); pos_ = 0; }
+                buf_.append(chunk, static_cast<std::size_t>(got));
+                return true;
+            }
+            if (got < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+            if (got < 0) throw std::runtime_error(std::string("Feed read failed: ") + std::strerror(errno));
+            if (!tail_) return false;                                   // EOF
+            std::this_thread::sleep_for(std::chrono::milliseconds(poll_ms_));   // regular files are always "ready": wait for growth
+        }
+    }
+
+    bool LineFeed::next(std::string& line, StreamClock::time_point& arrived, const std::atomic<bool>& stop) {
+        for (;;) {
+            const auto nl = buf_.find('\n', pos_);
+            if (nl != std::string::npos) {
+                line.assign(buf_, pos_, nl - pos_);
+                pos_ = nl + 1;
+                arrived = last_read_;
+                return true;
+            }
+            if (!fill(stop)) {
+                if (pos_ < buf_.size() && !tail_) {                     // unterminated last line of a finished feed
+                    line.assign(buf_, pos_, std::string::npos);
+                    pos_ = buf_.size();
+                    arrived = last_read_;
+                    return true;
+                }
+                return false;
+            }
+        }
+    }
+
+#else
+
+    LineFeed::LineFeed(const std::string& source, int poll_ms) : poll_ms_(poll_ms) {
+        throw std::runtime_error("Live feeds need a POSIX system: " + source);
+    }
+    LineFeed::~LineFeed() {}
+    bool LineFeed::fill(const std::atomic<bool>&) { return false; }
+    bool LineFeed::next(std::string&, StreamClock::time_point&, const std::atomic<bool>&) { return false; }
+
+#endif
+
+    StreamStats run_stream(LineFeed& feed, IStreamStrategy& strategy, const StreamRunner::SignalFn& on_signal,
+        std::atomic<bool>& stop, const StreamOptions& opts) {
+        StreamRunner runner(strategy, on_signal);
+        if (opts.queue == 0) {
+            std::string line;
+            StreamClock::time_point arrived;
+            while (feed.next(line, arrived, stop)) runner.on_line(line, arrived);
+            return runner.stats();
+        }
+
+        SpscRing<TimedBar> ring(opts.queue, opts.wait);
+        std::uint64_t lines = 0;
+        std::exception_ptr feed_error;
+        std::thread feeder([&]() {
+            try {
+                std::string line;
+                bool first_line = true;
+                TimedBar tb;
+                while (feed.next(line, tb.arrived, stop)) {
+                    ++lines;
+                    if (parse_feed_line(line, first_line, tb.bar)) ring.push(tb);
+                }
+            }
+            catch (...) { feed_error = std::current_exception(); }
+            ring.close();
+        });
+
+        std::exception_ptr error;
+        TimedBar tb;
+        while (ring.pop(tb)) {
+            if (error) continue;                                        // draining so the feeder never blocks on a full ring
+            try { runner.on_bar(tb.bar, tb.arrived); }
+            catch (...) { error = std::current_exception(); stop.store(true); }
+        }
+        feeder.join();
+        if (error) std::rethrow_exception(error);
+        if (feed_error) std::rethrow_exception(feed_error);
+
+        StreamStats st = runner.stats();
+        st.lines = lines;
+        return st;
+    }
+
+} // namespace sugar
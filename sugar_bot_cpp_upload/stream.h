@@ -0,0 +1,193 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "candle.h"
+#include "latency.h"
+#include "metrics.h"
+#include "spsc.h"
+
+namespace sugar {
+
+    // ---- incremental strategies ----------------------------------------------
+    //
+    // Live counterparts of the batch strategies: one bar in, O(1) work, an
+    // entry/exit signal out. Fed the bars of a series one by one, result()
+    // equals the batch run() over the same bars (for series at least as long
+    // as the longest indicator warm-up).
+
+    struct StreamSignal {
+        enum class Kind { Entry, Exit };
+        Kind kind{};
+        std::uint64_t bar{};                                            // 0-based index of the bar that fired it
+        int date{};
+        double price{};
+        double trade_ret{};                                             // Exit only: % return of the closed trade
+    };
+
+    class IStreamStrategy {
+    public:
+        virtual ~IStreamStrategy() = default;
+        virtual const char* name() const = 0;
+
+        // Consumes one bar; returns true and fills `sig` when it enters or exits.
+        virtual bool on_bar(const Candle& c, StreamSignal& sig) = 0;
+
+        // Metrics so far, an open position marked closed at the last bar.
+        virtual BacktestResult result() const = 0;
+    };
+
+    using StreamStrategyPtr = std::unique_ptr<IStreamStrategy>;
+
+    // RocSmaCrossoverStrategy, bar by bar: ring buffers for the two SMA windows
+    // and for the roc_len-bar lag of each SMA.
+    class RocSmaStream final : public IStreamStrategy {
+    public:
+        RocSmaStream(std::size_t sma_fast, std::size_t sma_slow, std::size_t roc_len, double thresh_percent);
+        const char* name() const override { return "roc_sma"; }
+        bool on_bar(const Candle& c, StreamSignal& sig) override;
+        BacktestResult result() const override;
+
+    private:
+        struct Sma {                                                    // same arithmetic as sma_over_series
+            std::vector<double> win;
+            std::size_t seen{}, pos{};
+            double sum{};
+            double push(double x);
+        };
+        struct Lag {                                                    // value pushed k steps ago
+            std::vector<double> ring;
+            std::size_t seen{};
+            double push_and_get(double x);                              // NaN until k + 1 values were pushed
+        };
+
+        Sma fast_, slow_;
+        Lag fast_lag_, slow_lag_;
+        double thresh_;
+        std::uint64_t bars_{};
+        bool started_{}, long_on_{};
+        double entry_{}, equity_{}, peak_{}, last_close_{};
+        MetricsAccumulator acc_{};
+        BacktestResult r_{};
+    };
+
+    // SwingBreakoutStrategy, bar by bar: a (left + right + 1)-bar ring of highs
+    // for pivot confirmation and a running EMA(10).
+    class SwingBreakoutStream final : public IStreamStrategy {
+    public:
+        SwingBreakoutStream(std::size_t left_bars, std::size_t right_bars, bool use_ema10_stop,
+            int days_above_10_required, double pct_gain_threshold, int days_for_gain, double max_loss_pct);
+        const char* name() const override { return "swing_breakout"; }
+        bool on_bar(const Candle& c, StreamSignal& sig) override;
+        BacktestResult result() const override;
+
+    private:
+        void reset_breakout();
+
+        std::size_t left_, right_;
+        bool use_ema10_stop_;
+        int days_above_10_required_;
+        double pct_gain_threshold_;
+        int days_for_gain_;
+        double max_loss_pct_;
+
+        std::vector<double> highs_;                                     // ring, last left + right + 1 highs
+        double ema_sum_{}, ema10_{};
+        std::uint64_t bars_{};
+
+        bool long_on_{}, trend_up_{}, bo_flagged_{}, validation_passed_{};
+        double entry_{}, equity_{}, peak_{}, last_close_{};
+        double last_swing_high_, breakout_low_, breakout_price_, entry_price_;
+        long long breakout_bar_{ -1 };
+        int days_above_10_{};
+        MetricsAccumulator acc_{};
+        BacktestResult r_{};
+    };
+
+    // ---- runner --------------------------------------------------------------
+
+    using StreamClock = std::chrono::steady_clock;
+
+    struct StreamStats {
+        std::uint64_t lines{}, bars{}, signals{};
+        std::uint64_t rejected{};                                       // bars older than the previous one
+        LatencyHistogram decision;                                      // bar arrival -> strategy step done, every bar
+        LatencyHistogram signal;                                        // same, bars that fired a signal
+    };
+
+    // Parses feed lines, steps the strategy and times each bar from the moment
+    // its bytes arrived to the moment its signal (if any) was handed out.
+    class StreamRunner {
+    public:
+        using SignalFn = std::function<void(const StreamSignal&)>;
+
+        explicit StreamRunner(IStreamStrategy& strategy, SignalFn on_signal = {});
+
+        void on_line(std::string& line, StreamClock::time_point arrived);
+        void on_bar(const Candle& c, StreamClock::time_point arrived);
+
+        const StreamStats& stats() const { return stats_; }
+        IStreamStrategy& strategy() { return strategy_; }
+
+    private:
+        IStreamStrategy& strategy_;
+        SignalFn on_signal_;
+        StreamStats stats_;
+        bool first_line_ = true;
+        std::int64_t last_ts_ = INT64_MIN;                              // time of the last accepted bar
+    };
+
+    // ---- feeds ---------------------------------------------------------------
+
+    // Line source for live bars (POSIX):
+    //   "-"          stdin
+    //   "unix:PATH"  connect to a UNIX stream socket
+    //   "tail:PATH"  follow a file as it grows (like tail -f)
+    //   PATH         a file or named pipe, read to EOF
+    class LineFeed {
+    public:
+        explicit LineFeed(const std::string& source, int poll_ms = 50);
+        ~LineFeed();
+
+        LineFeed(const LineFeed&) = delete;
+        LineFeed& operator=(const LineFeed&) = delete;
+
+        // Next complete line (without '\n') and when its last byte arrived.
+        // Returns false at end of feed, or once `stop` is set.
+        bool next(std::string& line, StreamClock::time_point& arrived, const std::atomic<bool>& stop);
+
+    private:
+        bool fill(const std::atomic<bool>& stop);                       // one read(); false at EOF / stop
+
+        int fd_ = -1;
+        bool tail_ = false;
+        int poll_ms_;
+        std::string buf_;
+        std::size_t pos_ = 0;
+        StreamClock::time_point last_read_{};
+    };
+
+    // A parsed bar on its way from the feed thread to the strategy thread.
+    struct TimedBar {
+        Candle bar;
+        StreamClock::time_point arrived;
+    };
+
+    struct StreamOptions {
+        std::size_t queue = 1024;                                       // SPSC ring slots; 0 = read, parse and decide on one thread
+        WaitMode wait = WaitMode::SpinYield;                            // how the strategy thread waits for bars
+    };
+
+    // Runs `strategy` over `feed` until it ends or `stop` is set. With a queue,
+    // a feed thread reads and parses lines and hands bars over an SpscRing to
+    // the calling thread, which runs the strategy and the signal callback; the
+    // latency histograms then include the handoff. If the callback throws,
+    // `stop` is set, the feed thread is joined and the exception rethrown.
+    StreamStats run_stream(LineFeed& feed, IStreamStrategy& strategy, const StreamRunner::SignalFn& on_signal,
+        std::atomic<bool>& stop, const StreamOptions& opts = {});
+
+} // namespace sugar
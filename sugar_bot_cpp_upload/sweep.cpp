@@ -1 +1,303 @@
-// Intentionally empty: sweep is header-only for convenience.
\ No newline at end of file
+#include "sweep.h"
+#include "checkpoint.h"
+#include "profile.h"
+#include "results_store.h"
+#include "result_cache.h"
+#include "rng.h"
+#include "telemetry.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+
+namespace sugar {
+
+
+	SweepRank parse_sweep_rank(const std::string& name) {
+		if (name == "pnl_dd") return SweepRank::PnlDd;
+		if (name == "sharpe") return SweepRank::Sharpe;
+		if (name == "sortino") return SweepRank::Sortino;
+		if (name == "profit_factor") return SweepRank::ProfitFactor;
+		if (name == "martin") return SweepRank::Martin;
+		throw std::runtime_error("Unknown rank (want pnl_dd, sharpe, sortino, profit_factor or martin): " + name);
+	}
+
+
+	const char* sweep_rank_name(SweepRank rank) {
+		switch (rank) {
+		case SweepRank::PnlDd: return "pnl_dd";
+		case SweepRank::Sharpe: return "sharpe";
+		case SweepRank::Sortino: return "sortino";
+		case SweepRank::ProfitFactor: return "profit_factor";
+		case SweepRank::Martin: return "martin";
+		}
+		return "?";
+	}
+
+
+	SweepResult sweep_roc_sma(const CandleSeries& data,
+		const std::vector<std::size_t>& fasts,
+		const std::vector<std::size_t>& slows,
+		const std::vector<std::size_t>& rocs,
+		const std::vector<double>& threshes,
+		const SweepOptions& opts)
+	{
+		SUGAR_PROF_SCOPE("sweep/total");																			// everything below, inclusive
+		if (opts.prune && opts.rank != SweepRank::PnlDd)															//
+			throw std::invalid_argument("sweep: --prune bounds pnl - 0.25 * dd and cannot rank by "					//
+				+ std::string(sweep_rank_name(opts.rank)));															//
+		BacktestResult best{}; RocSmaParams bestp{ 0,0,0,0.0 };														//
+		double best_score = -std::numeric_limits<double>::infinity();												//
+
+		// ---- progress plumbing ----
+		std::uint64_t valid_pairs = 0;																				// fast < slow, inside this call's pair range
+		for (std::size_t fi = 0; fi < fasts.size(); ++fi)															//
+			for (std::size_t si = 0; si < slows.size(); ++si) {														//
+				const std::uint64_t pair = fi * slows.size() + si;													//
+				if (fasts[fi] < slows[si] && pair >= opts.pair_begin && pair < opts.pair_end) ++valid_pairs;		//
+			}
+		const std::uint64_t total = valid_pairs * rocs.size() * threshes.size();									//
+		SweepCounters counters;																						// published per combo, read by the reporter thread
+
+
+		// best results storage
+		TopK top(opts.top_k);																						//
+		const std::size_t K = top.capacity();																		//
+		// --------------------------
+
+		// ---- pruning plumbing ----
+		PruneBounds bounds;																							// built once, shared by every run
+		if (opts.prune) bounds = PruneBounds(data.closes());														//
+		PruneLimit limit{};																							// min_score tracks the live K-th best
+		limit.bounds = &bounds;																						//
+		SweepResult out{};																							// collects the work counters as we go
+		// --------------------------
+
+		// ---- checkpoint plumbing ----
+		const bool checkpointing = !opts.checkpoint_path.empty();													//
+		const std::uint64_t config_hash = checkpointing															//
+			? sweep_config_hash(data, fasts, slows, rocs, threshes, opts) : 0;										//
+		std::uint64_t resume_pair = 0;																				// pairs before this index are already done
+		if (checkpointing && opts.resume) {																			//
+			SweepCheckpoint ck;																						//
+			if (!load_checkpoint(opts.checkpoint_path, ck)) {														//
+				std::cerr << "[sweep] no checkpoint at '" << opts.checkpoint_path << "', starting fresh\n";		//
+			}
+			else {
+				if (ck.config_hash != config_hash)																	// different data, grid or options
+					throw std::runtime_error("Checkpoint does not match this data/grid: " + opts.checkpoint_path);	//
+				resume_pair = ck.next_pair;																			//
+				best_score = ck.best_score; best = ck.best; bestp = ck.best_params;									//
+				top = TopK::from_heap(K, std::move(ck.heap));														//
+				out.evaluated = ck.evaluated; out.pruned = ck.pruned; out.bars_skipped = ck.bars_skipped;			//
+				if (!opts.results_path.empty() && ck.results_bytes > 0													// drop rows written after the checkpoint
+					&& std::filesystem::exists(opts.results_path))													//
+					std::filesystem::resize_file(opts.results_path, ck.results_bytes);								//
+				std::cerr << "[sweep] resuming at pair " << resume_pair << " / " << fasts.size() * slows.size()	//
+					<< " (" << out.evaluated << " combos already done)\n";											//
+			}
+		}
+		std::unique_ptr<ResultStoreWriter> store;																	// every combo, pruned ones flagged
+		if (!opts.results_path.empty()) store = std::make_unique<ResultStoreWriter>(opts.results_path);			//
+		auto write_checkpoint = [&](std::uint64_t next_pair) {														// snapshot state at a pair boundary
+			SUGAR_PROF_SCOPE("sweep/checkpoint");																	//
+			SweepCheckpoint ck;																						//
+			ck.config_hash = config_hash; ck.next_pair = next_pair;												//
+			ck.best_score = best_score; ck.best = best; ck.best_params = bestp;									//
+			ck.top_k = K; ck.heap = top.heap();																		//
+			ck.evaluated = out.evaluated; ck.pruned = out.pruned; ck.bars_skipped = out.bars_skipped;				//
+			ck.results_bytes = store ? store->flush() : 0;															// rows up to here are durable
+			save_checkpoint(opts.checkpoint_path, ck);																//
+		};
+		auto last_write = std::chrono::steady_clock::now();															//
+		// --------------------------
+
+		// ---- result cache plumbing ----
+		std::unique_ptr<ResultCache> cache;																			//
+		std::vector<std::uint64_t> prefix;																			// prefix[i] = hash of the first i candles
+		if (!opts.cache_path.empty()) {																				//
+			cache = std::make_unique<ResultCache>(opts.cache_path);													//
+			prefix = prefix_hashes(data);																			// one pass, shared by every key
+		}
+		const std::uint64_t data_hash = cache ? prefix.back() : 0;													//
+		auto run_and_cache = [&](RocSmaCrossoverStrategy& strat, const RocSmaParams& p, std::uint64_t key) {		// cache miss: full run, then store
+			BacktestResult res;																						//
+			if (opts.cache_append) {																				//
+				const auto pkey = roc_sma_param_key(p);																//
+				const auto* snap = cache->find_snapshot(pkey);														//
+				ResultCache::Snapshot next;																			//
+				bool captured = false;																				//
+				if (snap && snap->state.bars < data.size() && snap->prefix_hash == prefix[snap->state.bars]) {		// same history, new bars
+					res = strat.resume(data, snap->state, next.state);												//
+					captured = true;																				//
+					++out.cache_resumed;																			//
+				}
+				else res = strat.run(data, next.state, captured);													//
+				if (captured) {																						//
+					next.prefix_hash = prefix[next.state.bars];														//
+					cache->store_snapshot(pkey, next);																//
+				}
+			}
+			else res = strat.run(data);																				//
+			cache->store(key, res);																					//
+			return res;																								//
+		};
+		// --------------------------
+
+		// ---- telemetry ----
+		const std::uint64_t evaluated0 = out.evaluated, skipped0 = out.bars_skipped;								// resumed work is not this process's throughput
+		counters.publish(out.evaluated, out.pruned, 0, best_score, top.threshold());								//
+		std::unique_ptr<TelemetryReporter> reporter;																// fixed-interval progress off the sweep thread
+		if (!opts.quiet || !opts.telemetry_path.empty())															//
+			reporter = std::make_unique<TelemetryReporter>(counters, total, opts.progress_every_sec,				//
+				opts.quiet ? nullptr : &std::cerr, opts.telemetry_path, out.evaluated);								//
+		// --------------------------
+
+		for (std::size_t fi = 0; fi < fasts.size(); ++fi) {															//
+			const auto f = fasts[fi];																				//
+			for (std::size_t si = 0; si < slows.size(); ++si) {														//
+				const auto s = slows[si];																			//
+				const std::uint64_t pair = fi * slows.size() + si;													//
+				if (pair < resume_pair) continue;																	// finished before the checkpoint
+				if (pair < opts.pair_begin || pair >= opts.pair_end) continue;										// another shard's work
+				SUGAR_PROF_COUNT("sweep/pairs", rocs.size() * threshes.size());										// scheduled pairs, items = combos in each
+				if (opts.on_pair) opts.on_pair(pair);																//
+				if (checkpointing && std::chrono::steady_clock::now() - last_write									// at most one clock read per pair
+					>= std::chrono::duration<double>(opts.checkpoint_every_sec)) {									//
+					write_checkpoint(pair);																			//
+					if (cache) cache->flush();																		// cached work survives the same crashes
+					last_write = std::chrono::steady_clock::now();													//
+				}
+				if (f >= s) continue;																				//
+				for (auto rlen : rocs) {																			//
+					for (auto th : threshes) {																		//
+						RocSmaCrossoverStrategy strat{ f, s, rlen, th };											//
+						BacktestResult res;																			//
+						std::size_t skipped = 0;																	//
+						const std::uint64_t key = cache ? roc_sma_result_key({ f, s, rlen, th }, data_hash) : 0;	//
+						const BacktestResult* hit = cache ? cache->find(key) : nullptr;								//
+						if (hit) { res = *hit; ++out.cache_hits; }													// full result: no need to prune it
+						else if (opts.prune) {																		//
+							limit.min_score = top.threshold();														// -inf until the heap is full
+							res = strat.run(data, limit, skipped);													//
+							if (cache) cache->store(key, res);														// ignored when pruned (partial metrics)
+						}																							//
+						else if (cache) res = run_and_cache(strat, { f, s, rlen, th }, key);						//
+						else res = strat.run(data);																	//
+
+						++out.evaluated;																			//
+						if (store) {																				//
+							SUGAR_PROF_SCOPE("sweep/results_store");												//
+							store->append({ f, s, rlen, th }, res);													//
+						}
+						out.bars_skipped += skipped;																//
+						if (res.pruned) ++out.pruned;																// cannot beat the K-th best: keep it out of the heap
+						else {
+							double score = rank_score(res, opts.rank);												//
+							if (score > best_score) { best_score = score; best = res; bestp = { f, s, rlen, th }; }	//
+							SUGAR_PROF_SCOPE("sweep/topk_push");													//
+							top.push({ score, res, {f, s, rlen, th} });												//
+						}
+						counters.publish(out.evaluated, out.pruned,													// relaxed stores on the sweep's own line
+							(out.evaluated - evaluated0) * data.size() - (out.bars_skipped - skipped0),				// cache hits count as full runs
+							best_score, top.threshold());															//
+					}
+				}
+			}
+
+		}
+
+		if (reporter) reporter->stop();																				// final sample: totals and average rates
+
+		// Display top results
+		std::vector<SweepRow> topk = top.sorted();																	// best first
+
+		if (!opts.quiet) std::cerr << "\nTop " << K << " combos:\n";													//
+		for (auto& row : topk) {																					//
+			if (opts.quiet) break;																					//
+			const auto& [f, s, rlen, th] = row.p;																	//
+			std::cerr << "  score=" << row.score																	//
+				<< " | fast=" << f << " slow=" << s																	//
+				<< " roc=" << rlen << " thresh=" << th																//
+				<< " | PnL=" << row.r.pnl																			//
+				<< "%, DD=" << row.r.max_drawdown																	//
+				<< "%, Trades=" << row.r.trades << "\n";															//
+		}
+
+		if (store) store->flush();																					//
+		if (cache) cache->flush();																					//
+		if (checkpointing) write_checkpoint(fasts.size() * slows.size());											// complete: a resume just reports the result
+
+		out.bars_total = out.evaluated * data.size();																// one pass over the series per run
+		if (opts.prune && !opts.quiet) {																			// report the work the bound saved
+			std::cerr << "[sweep] pruned " << out.pruned << " / " << out.evaluated << " combos, skipped "			//
+				<< out.bars_skipped << " / " << out.bars_total << " strategy bars\n";								//
+		}
+
+		if (cache && !opts.quiet) {																					//
+			std::cerr << "[sweep] cache: " << out.cache_hits << " hits, " << out.cache_resumed						//
+				<< " resumed from snapshots, " << cache->size() << " results stored\n";								//
+		}
+
+		out.best = best; out.params = bestp; out.top = std::move(topk);											//
+		return out;																									//
+	}
+
+
+	SweepEstimate estimate_sweep_roc_sma(const CandleSeries& data,
+		const std::vector<std::size_t>& fasts,
+		const std::vector<std::size_t>& slows,
+		const std::vector<std::size_t>& rocs,
+		const std::vector<double>& threshes,
+		const SweepOptions& opts,
+		std::size_t sample, double budget_sec, std::uint64_t seed)
+	{
+		SweepEstimate est{};																						//
+		std::vector<std::pair<std::size_t, std::size_t>> pairs;														// valid (fast, slow) in range, sweep order
+		for (std::size_t fi = 0; fi < fasts.size(); ++fi)															//
+			for (std::size_t si = 0; si < slows.size(); ++si) {														//
+				const std::uint64_t pair = fi * slows.size() + si;													//
+				if (fasts[fi] < slows[si] && pair >= opts.pair_begin && pair < opts.pair_end) pairs.push_back({ fasts[fi], slows[si] });
+			}
+		const std::uint64_t per_pair = rocs.size() * threshes.size();												//
+		est.combos = pairs.size() * per_pair;																		//
+
+		constexpr std::size_t kRunVectors = 5;																		// closes copies + SMA + ROC vectors a RocSma run holds at its peak
+		est.resident_bytes = data.size() * sizeof(Candle) + kRunVectors * data.size() * sizeof(double)				//
+			+ std::max<std::size_t>(opts.top_k, 1) * sizeof(SweepRow);												//
+		if (!opts.cache_path.empty())																				// in-memory map of every stored result + prefix hashes
+			est.resident_bytes += est.combos * (sizeof(std::uint64_t) + sizeof(BacktestResult) + 2 * sizeof(void*))	//
+				+ (data.size() + 1) * sizeof(std::uint64_t);														//
+		if (!opts.results_path.empty()) {																			// one buffered block in memory, every row on disk
+			est.resident_bytes += 65536 * kResultRowBytes;															//
+			est.results_bytes = est.combos * kResultRowBytes;														//
+		}
+		if (est.combos == 0 || data.size() == 0) return est;														//
+
+		SplitMix64 rng = rng_stream(seed, 0);																		//
+		auto run_one = [&]() {																						// one uniformly drawn combo of the grid
+			const std::uint64_t j = static_cast<std::uint64_t>(rng.uniform() * double(est.combos)) % est.combos;	//
+			const auto& [f, s] = pairs[j / per_pair];																//
+			const std::uint64_t rt = j % per_pair;																	//
+			RocSmaCrossoverStrategy strat{ f, s, rocs[rt / threshes.size()], threshes[rt % threshes.size()] };		//
+			return strat.run(data).trades;																			//
+		};
+
+		volatile std::size_t sink = run_one();																		// warm-up: page in the data, fault in the allocator
+		const auto t0 = std::chrono::steady_clock::now();															//
+		double elapsed = 0.0;																						//
+		while (est.sampled < std::max<std::size_t>(sample, 1) && (est.sampled == 0 || elapsed < budget_sec)) {		// at least one timed run
+			sink = sink + run_one();																				//
+			++est.sampled;																							//
+			elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();					//
+		}
+		est.sec_per_combo = elapsed / double(est.sampled);															//
+		est.seconds = est.sec_per_combo * double(est.combos);														//
+		return est;																									//
+	}
+
+
+} // namespace sugar
@@ -1,10 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
 #include <tuple>
 #include <vector>
-#include <limits>
-#include <queue>
-#include <iostream>
 #include "metrics.h"
+#include "prune.h"
 #include "strategy_roc_sma.h"
 #include "backtester.h"
 #include "swing_breakout_strategy.h"
@@ -17,83 +20,118 @@ namespace sugar {
 	using RocSmaParams = std::tuple<std::size_t, std::size_t, std::size_t, double>;									// fast, slow, roc, thresh
 
 
-	struct SweepResult {																							// 
-		BacktestResult best;																						// 
-		RocSmaParams params;																						// 
-	};
+	inline double sweep_score(const BacktestResult& r) { return r.pnl - 0.25 * r.max_drawdown; }					// ranking rule: reward profit, penalize drawdown
 
-	inline SweepResult sweep_roc_sma(const CandleSeries& data,														// 
-		const std::vector<std::size_t>& fasts,																		// 
-		const std::vector<std::size_t>& slows,																		// 
-		const std::vector<std::size_t>& rocs,																		// 
-		const std::vector<double>& threshes)																		// 
-	{
-		BacktestResult best{}; RocSmaParams bestp{ 0,0,0,0.0 };														// 
-		double best_score = -std::numeric_limits<double>::infinity();												// 
 
-		// ---- progress plumbing ----
-		//const std::size_t total_naive = fasts.size() * slows.size() * rocs.size() * threshes.size();				// 
-		std::size_t valid_pairs = 0;																				// 
-		for (auto s : slows) for (auto f : fasts) if (f < s) ++valid_pairs;											// 
-		const std::size_t total = valid_pairs * rocs.size() * threshes.size();										// 
+	enum class SweepRank { PnlDd, Sharpe, Sortino, ProfitFactor, Martin };											// what the top-K is ordered by
 
-		std::size_t count = 0;																						// 
-		constexpr std::size_t progress_every = 100;																	// print every 100 combos 
+	SweepRank parse_sweep_rank(const std::string& name);															// "pnl_dd", "sharpe", "sortino", "profit_factor", "martin"
+	const char* sweep_rank_name(SweepRank rank);																	// 
 
+	inline double rank_score(const BacktestResult& r, SweepRank rank) {												// higher is better for every rank
+		switch (rank) {
+		case SweepRank::Sharpe: return r.risk.sharpe;
+		case SweepRank::Sortino: return r.risk.sortino;
+		case SweepRank::ProfitFactor: return r.risk.profit_factor;
+		case SweepRank::Martin: return r.risk.ulcer > 0.0 ? r.pnl / r.risk.ulcer : r.pnl;							// ulcer performance index
+		case SweepRank::PnlDd: break;
+		}
+		return sweep_score(r);
+	}
 
-		// best results storage
-		struct Row { double score; BacktestResult r; RocSmaParams p; };												// 
-		auto cmp = [](const Row& a, const Row& b) { return a.score > b.score; };									// min-heap
-		std::priority_queue<Row, std::vector<Row>, decltype(cmp)> top(cmp);											// 
-		constexpr std::size_t K = 5;
-		// --------------------------
 
-		size_t displayCounter = fasts.size();																		// simple counter, set to the size outer loop
-		std::cerr << "Working now...\n";																			// feedback for user to confirm the program is running correctly
+	struct SweepRow { double score; BacktestResult r; RocSmaParams p; };											// one ranked combo
 
-		for (auto f : fasts) {																						// 
-			std::cerr << "Still working... current row: " << displayCounter << "\n";								// simple counter feedback to assure the user the program is running 
-			--displayCounter;																						// count down
-			for (auto s : slows) {																					// 
-				if (f >= s) continue;																				// 
-				for (auto rlen : rocs) {																			// 
-					for (auto th : threshes) {																		// 
-						RocSmaCrossoverStrategy strat{ f, s, rlen, th };											// 
-						auto res = strat.run(data);																	// 
-						double score = res.pnl - 0.25 * res.max_drawdown;											// 
-						if (score > best_score) { best_score = score; best = res; bestp = { f, s, rlen, th };		// 
-						top.push({ score, res, {f, s, rlen, th} });													// 
-						if (top.size() > K) top.pop();																// 
-						}
-					}
-				}
-			}
 
+	class TopK {																									// bounded min-heap of the K best rows seen so far
+	public:
+		explicit TopK(std::size_t k) : k_(k < 1 ? 1 : k) {}															// 
+
+		void push(const SweepRow& row) {																			// same push/pop order as std::priority_queue
+			heap_.push_back(row); std::push_heap(heap_.begin(), heap_.end(), Worse{});
+			if (heap_.size() > k_) { std::pop_heap(heap_.begin(), heap_.end(), Worse{}); heap_.pop_back(); }
+		}
+		bool full() const { return heap_.size() >= k_; }															// 
+		double threshold() const {																					// K-th best score; -inf until the heap is full
+			return full() ? heap_.front().score : -std::numeric_limits<double>::infinity();
+		}
+		std::size_t capacity() const { return k_; }																	// 
+		std::vector<SweepRow> sorted() const {																		// best first (copy; the heap stays intact)
+			auto out = heap_;
+			std::sort_heap(out.begin(), out.end(), Worse{});
+			return out;
 		}
 
-		// Display top results 
-		std::vector<Row> topk;																						// 
-		while (!top.empty()) { topk.push_back(top.top()); top.pop(); }												// 
-		std::reverse(topk.begin(), topk.end());																		// best first
-
-		std::cerr << "\nTop " << K << " combos:\n";																	// 
-		for (auto& row : topk) {																					// 
-			const auto& [f, s, rlen, th] = row.p;																	// 
-			std::cerr << "  score=" << row.score																	// 
-				<< " | fast=" << f << " slow=" << s																	// 
-				<< " roc=" << rlen << " thresh=" << th																// 
-				<< " | PnL=" << row.r.pnl																			// 
-				<< "%, DD=" << row.r.max_drawdown																	// 
-				<< "%, Trades=" << row.r.trades << "\n";															// 
+		const std::vector<SweepRow>& heap() const { return heap_; }													// raw heap order, for checkpoints
+		static TopK from_heap(std::size_t k, std::vector<SweepRow> heap) {											// restores exactly what heap() returned
+			TopK t(k); t.heap_ = std::move(heap);
+			return t;
 		}
 
-		// final flush if we didn't land exactly on a multiple
-			if (count % progress_every != 0) {																		// 
-				std::cerr << "[sweep] " << count << " / " << total << " combos (done)\n";							// 
-			}
+	private:
+		struct Worse { bool operator()(const SweepRow& a, const SweepRow& b) const { return a.score > b.score; } };
+		std::size_t k_;
+		std::vector<SweepRow> heap_;																				// min-heap under Worse
+	};
 
-		return { best, bestp };																						// 
-	}
+
+	struct SweepOptions {																							// 
+		bool prune = false;																							// abandon runs whose best case cannot reach the live top-K
+		SweepRank rank = SweepRank::PnlDd;																			// prune needs the default: its bound is on sweep_score
+		std::size_t top_k = 5;																						// 
+		std::string checkpoint_path;																				// empty = no checkpointing
+		double checkpoint_every_sec = 60.0;																			// wall-clock spacing between checkpoint writes
+		bool resume = false;																						// continue from checkpoint_path if it exists
+		std::uint64_t pair_begin = 0;																				// evaluate only (fast, slow) pairs with
+		std::uint64_t pair_end = std::numeric_limits<std::uint64_t>::max();										//   pair_begin <= fi * slows.size() + si < pair_end
+		std::function<void(std::uint64_t)> on_pair;																	// called before each pair in range (heartbeats, telemetry)
+		bool quiet = false;																							// no progress / top-K printing
+		double progress_every_sec = 5.0;																			// wall-clock spacing of telemetry lines
+		std::string telemetry_path;																					// also append each telemetry sample here as a JSON line
+		std::string results_path;																					// append every combo to a columnar result store
+		std::string cache_path;																						// content-addressed result cache; empty = off
+		bool cache_append = false;																					// also keep state snapshots and replay only appended bars
+	};
+
+
+	struct SweepResult {																							// 
+		BacktestResult best;																						// 
+		RocSmaParams params;																						// 
+		std::vector<SweepRow> top;																					// best first
+		std::size_t evaluated{};																					// combos run (pruned ones included)
+		std::size_t pruned{};																						// combos stopped early by the bound
+		std::size_t bars_total{};																					// series bars across all runs (evaluated * data.size())
+		std::size_t bars_skipped{};																					// of those, strategy-loop bars never visited thanks to pruning
+		std::size_t cache_hits{};																					// combos answered straight from the cache
+		std::size_t cache_resumed{};																				// combos continued from a snapshot over appended bars
+	};
+
+	SweepResult sweep_roc_sma(const CandleSeries& data,																// 
+		const std::vector<std::size_t>& fasts,																		// 
+		const std::vector<std::size_t>& slows,																		// 
+		const std::vector<std::size_t>& rocs,																		// 
+		const std::vector<double>& threshes,																		// 
+		const SweepOptions& opts = {});																				// 
+
+
+	struct SweepEstimate {																							// pre-flight cost of a sweep_roc_sma call
+		std::uint64_t combos{};																						// combos the sweep would run (fast < slow, in the pair range)
+		std::size_t sampled{};																						// combos actually timed
+		double sec_per_combo{};																						// mean over the sample
+		double seconds{};																							// combos * sec_per_combo; an upper bound with prune/cache
+		std::uint64_t resident_bytes{};																				// candles + one run's vectors + top-K (+ cache entries)
+		std::uint64_t results_bytes{};																				// --results file growth on disk
+	};
+
+	// Times a random sample of the grid's combos (one warm-up run, then up to
+	// `sample` runs or `budget_sec` of them) and scales up. No pruning, no cache.
+	SweepEstimate estimate_sweep_roc_sma(const CandleSeries& data,													// 
+		const std::vector<std::size_t>& fasts,																		// 
+		const std::vector<std::size_t>& slows,																		// 
+		const std::vector<std::size_t>& rocs,																		// 
+		const std::vector<double>& threshes,																		// 
+		const SweepOptions& opts = {},																				// 
+		std::size_t sample = 32, double budget_sec = 2.0, std::uint64_t seed = 1);									// 
 
 
 
@@ -0,0 +1,66 @@
+#include "sweep_diff_cross.h"
+#include "parallel.h"
+#include "profile.h"
+#include "strategy_diff_cross.h"
+#include "sweep.h"
+#include <algorithm>
+#include <chrono>
+
+namespace sugar {
+
+    std::vector<DiffCrossRow> sweep_diff_cross(const CandleSeries& data,
+        std::span<const std::span<const double>> a, std::span<const std::span<const double>> b,
+        std::span<const double> closes, const std::vector<double>& threshes, std::size_t top_k, std::size_t threads) {
+        SUGAR_PROF_SCOPE("sweep/diff_cross");
+        constexpr std::size_t kBlock = 4096;                            // combos per parallel_for; bounds the result buffer
+        const std::size_t B = b.size(), T = threshes.size(), count = a.size() * B * T;
+        const std::size_t k = std::max<std::size_t>(1, top_k);
+        struct Candidate { std::size_t index; DiffCrossRow row; };
+        auto better = [](const Candidate& x, const Candidate& y) {
+            return x.row.score != y.row.score ? x.row.score > y.row.score : x.index < y.index;
+        };
+
+        std::vector<Candidate> best;
+        std::vector<Candidate> block(std::min(kBlock, count));
+        for (std::size_t start = 0; start < count; start += kBlock) {
+            const std::size_t m = std::min(kBlock, count - start);
+            parallel_for(m, threads, [&](std::size_t j) {
+                const std::size_t i = start + j, ai = i / (B * T), bi = i / T % B;
+                const double th = threshes[i % T];
+                const auto r = DiffCrossStrategy::run_on(data, a[ai], b[bi], closes, th);
+                block[j] = { i, { sweep_score(r), r, ai, bi, th } };
+            });
+            best.insert(best.end(), block.begin(), block.begin() + static_cast<std::ptrdiff_t>(m));
+            const std::size_t keep = std::min(k, best.size());
+            std::partial_sort(best.begin(), best.begin() + static_cast<std::ptrdiff_t>(keep), best.end(), better);
+            best.resize(keep);
+        }
+
+        std::vector<DiffCrossRow> out;
+        for (const auto& c : best) out.push_back(c.row);
+        return out;
+    }
+
+    DiffCrossSweep sweep_diff_cross(const CandleSeries& data,
+        const std::vector<IndicatorKey>& a, const std::vector<IndicatorKey>& b,
+        const std::vector<double>& threshes, std::size_t top_k, std::size_t threads) {
+        DiffCrossSweep out;
+        out.combos = a.size() * b.size() * threshes.size();
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<IndicatorKey> keys(a);
+        keys.insert(keys.end(), b.begin(), b.end());
+        const IndicatorBank bank(data, std::move(keys), threads);
+        out.series = bank.computed();
+        out.bank_bytes = bank.bytes();
+        auto t1 = std::chrono::steady_clock::now();
+        out.bank_seconds = std::chrono::duration<double>(t1 - t0).count();
+
+        std::vector<std::span<const double>> av, bv;                    // resolved once, not per combo
+        for (const auto& key : a) av.push_back(bank.series(key));
+        for (const auto& key : b) bv.push_back(bank.series(key));
+        out.top = sweep_diff_cross(data, av, bv, bank.closes(), threshes, top_k, threads);
+        out.eval_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+        return out;
+    }
+
+} // namespace sugar
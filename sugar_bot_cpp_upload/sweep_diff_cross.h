@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <span>
+#include <vector>
+#include "indicator_bank.h"
+#include "metrics.h"
+#include "series.h"
+
+namespace sugar {
+
+    // Exhaustive DiffCrossStrategy sweep: every (A, B, thresh) in grid order
+    // (A outermost, thresh innermost) through DiffCrossStrategy::run_on,
+    // on the thread pool, keeping the K best by sweep_score.
+
+    struct DiffCrossRow {
+        double score{};                                                 // sweep_score
+        BacktestResult r;
+        std::size_t a{}, b{};                                           // indexes into the A and B lists
+        double thresh{};
+    };
+
+    // Over series the caller already holds, each aligned to `data`; ties
+    // keep grid order. Reads the series concurrently and never writes them.
+    std::vector<DiffCrossRow> sweep_diff_cross(const CandleSeries& data,
+        std::span<const std::span<const double>> a, std::span<const std::span<const double>> b,
+        std::span<const double> closes, const std::vector<double>& threshes,
+        std::size_t top_k = 5, std::size_t threads = 0);
+
+    struct DiffCrossSweep {
+        std::vector<DiffCrossRow> top;                                  // best first; a, b index the key lists
+        std::size_t combos{};
+        std::size_t series{};                                           // distinct series the bank built
+        std::size_t bank_bytes{};
+        double bank_seconds{}, eval_seconds{};
+    };
+
+    // Over (family x period) keys: builds one IndicatorBank holding every
+    // distinct series of both lists, then sweeps against it. A key on both
+    // sides is computed once; identical A and B pairs are run like any other.
+    DiffCrossSweep sweep_diff_cross(const CandleSeries& data,
+        const std::vector<IndicatorKey>& a, const std::vector<IndicatorKey>& b,
+        const std::vector<double>& threshes, std::size_t top_k = 5, std::size_t threads = 0);
+
+} // namespace sugar
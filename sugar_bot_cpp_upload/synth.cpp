@@ -0,0 +1,93 @@
+#include "synth.h"
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace sugar {
+
+    namespace {
+
+        long long days_of(int yyyymmdd) {
+            return days_from_civil(yyyymmdd / 10000, static_cast<unsigned>(yyyymmdd / 100 % 100), static_cast<unsigned>(yyyymmdd % 100));
+        }
+
+    } // namespace
+
+    SynthModel parse_synth_model(const std::string& name) {
+        if (name == "gbm") return SynthModel::Gbm;
+        if (name == "regime") return SynthModel::Regime;
+        if (name == "jump") return SynthModel::Jump;
+        throw std::runtime_error("Unknown synthetic model (want gbm, regime or jump): " + name);
+    }
+
+    const char* synth_model_name(SynthModel model) {
+        switch (model) {
+        case SynthModel::Gbm: return "gbm";
+        case SynthModel::Regime: return "regime";
+        case SynthModel::Jump: return "jump";
+        }
+        return "?";
+    }
+
+    SynthGenerator::SynthGenerator(const SynthOptions& opts, std::uint64_t total_bars, std::size_t symbol)
+        : o_(opts), rng_(rng_stream(opts.seed, symbol)), day_(days_of(opts.start_date)), date_(opts.start_date) {
+        if (!(opts.start_price > 0.0) || !(opts.days_per_year > 0.0) || opts.vol < 0.0 || opts.turbulent_vol < 0.0)
+            throw std::invalid_argument("SynthGenerator: prices, days per year and volatilities must be positive");
+        if (opts.start_date < 10000101 || opts.start_date > 99991231) throw std::invalid_argument("SynthGenerator: bad start date");
+
+        const long long days_left = days_of(99991231) - day_ + 1;       // dates stay 8-digit YYYYMMDD
+        const std::uint64_t fit = (total_bars + static_cast<std::uint64_t>(days_left) - 1) / static_cast<std::uint64_t>(days_left);
+        bars_per_day_ = std::max<std::size_t>({ std::size_t(1), opts.bars_per_day, static_cast<std::size_t>(fit) });
+        day_left_ = bars_per_day_;
+
+        log_close_ = log_start_ = std::log(opts.start_price);
+        close_ = opts.start_price;
+        const double dt = 1.0 / (opts.days_per_year * static_cast<double>(bars_per_day_));
+        const double drift[2] = { opts.drift, opts.turbulent_drift }, vol[2] = { opts.vol, opts.turbulent_vol };
+        const double stay[2] = { opts.calm_bars, opts.turbulent_bars };
+        for (int s = 0; s < 2; ++s) {
+            mu_[s] = (drift[s] - 0.5 * vol[s] * vol[s]) * dt;           // log drift: E[price] grows at `drift`
+            sigma_[s] = vol[s] * std::sqrt(dt);
+            leave_[s] = stay[s] > 1.0 ? 1.0 / stay[s] : 1.0;
+        }
+        jump_p_ = std::min(1.0, opts.jumps_per_year * dt);
+        if (opts.model == SynthModel::Jump)                             // jumps move the price, not its expected growth
+            for (double& m : mu_) m -= jump_p_ * (std::exp(opts.jump_mean + 0.5 * opts.jump_sd * opts.jump_sd) - 1.0);
+        kappa_ = opts.revert_years > 0.0 ? std::min(1.0, std::log(2.0) * dt / opts.revert_years) : 0.0;
+    }
+
+    void SynthGenerator::fill(std::span<Candle> out) {
+        const bool regime = o_.model == SynthModel::Regime, jumps = o_.model == SynthModel::Jump;
+        for (Candle& c : out) {
+            if (regime && rng_.uniform() < leave_[turbulent_]) turbulent_ = !turbulent_;
+            const int s = turbulent_ ? 1 : 0;
+            const double sig = sigma_[s];
+
+            double r = mu_[s] + sig * normal_(rng_) - kappa_ * (log_close_ - log_start_);
+            if (jumps && rng_.uniform() < jump_p_) r += o_.jump_mean + o_.jump_sd * normal_(rng_);
+            const double gap = 0.2 * sig * (rng_.uniform() - 0.5);     // small overnight gap, inside the close-to-close move
+
+            c.date = date_;
+            c.ts = day_ * 86400 + static_cast<std::int64_t>((bars_per_day_ - day_left_) * 86400 / bars_per_day_);   // bars spread evenly over the day
+            c.open = close_ * (1.0 + gap);
+            log_close_ += r;
+            c.close = std::exp(log_close_);
+            c.high = std::max(c.open, c.close) * (1.0 + sig * rng_.uniform());     // wicks: up to one sigma past the body
+            c.low = std::min(c.open, c.close) / (1.0 + sig * rng_.uniform());
+            c.volume = std::round(o_.volume * (0.5 + rng_.uniform()) * (1.0 + std::fabs(r) / (sig > 0.0 ? sig : 1.0)));   // busier on big moves
+
+            close_ = c.close;
+            ++produced_;
+            if (--day_left_ == 0) { date_ = civil_from_days(++day_); day_left_ = bars_per_day_; }
+        }
+    }
+
+    std::vector<Candle> generate_candles(const SynthOptions& opts, std::size_t bars, std::size_t symbol) {
+        std::vector<Candle> out(bars);
+        SynthGenerator gen(opts, bars, symbol);
+        gen.fill(out);
+        return out;
+    }
+
+} // namespace sugar
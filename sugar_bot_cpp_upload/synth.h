@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "candle.h"
+#include "rng.h"
+
+namespace sugar {
+
+    // Price process behind a synthetic history.
+    enum class SynthModel {
+        Gbm,                                                            // geometric Brownian motion
+        Regime,                                                         // GBM switching between a calm and a turbulent state (Markov)
+        Jump,                                                           // GBM plus Poisson jumps (Merton)
+    };
+
+    SynthModel parse_synth_model(const std::string& name);             // "gbm", "regime", "jump"
+    const char* synth_model_name(SynthModel model);
+
+    struct SynthOptions {
+        SynthModel model = SynthModel::Gbm;
+        std::uint64_t seed = 42;
+        double start_price = 100.0;
+        double drift = 0.05;                                            // annual, calm state
+        double vol = 0.20;                                              // annual, calm state
+        double days_per_year = 365.0;                                   // a bar every day, as in the crypto CSVs
+        int start_date = 20000101;
+        std::size_t bars_per_day = 0;                                   // 0 = 1, raised if the history would run past 9999-12-31
+        double revert_years = 50.0;                                     // half-life of the pull toward the start price; 0 = none
+        double turbulent_drift = 0.0, turbulent_vol = 0.60;             // Regime
+        double calm_bars = 500.0, turbulent_bars = 100.0;               // Regime: mean stay in each state
+        double jumps_per_year = 4.0, jump_mean = -0.03, jump_sd = 0.08; // Jump: log-size of each jump (drift-compensated)
+        double volume = 10000.0;                                        // typical bar volume
+    };
+
+    // Reproducible OHLCV bars, produced in chunks so histories far larger than
+    // memory can be streamed to disk. Same options, length and symbol index
+    // always give the same bars; symbols draw from independent streams.
+    // Every bar has low <= min(open, close) <= max(open, close) <= high.
+    class SynthGenerator {
+    public:
+        SynthGenerator(const SynthOptions& opts, std::uint64_t total_bars, std::size_t symbol = 0);
+
+        void fill(std::span<Candle> out);                               // next out.size() bars
+        std::uint64_t produced() const { return produced_; }
+        std::size_t bars_per_day() const { return bars_per_day_; }
+
+    private:
+        SynthOptions o_;
+        SplitMix64 rng_;
+        NormalGen normal_;
+        std::size_t bars_per_day_;
+        long long day_;                                                 // days since 1970-01-01
+        int date_;
+        std::uint64_t produced_ = 0;
+        std::size_t day_left_;                                          // bars until the date moves on
+        double log_close_, log_start_, close_;
+        bool turbulent_ = false;
+        double mu_[2], sigma_[2], leave_[2];                            // per bar, by state
+        double jump_p_, kappa_;
+    };
+
+    std::vector<Candle> generate_candles(const SynthOptions& opts, std::size_t bars, std::size_t symbol = 0);
+
+} // namespace sugar
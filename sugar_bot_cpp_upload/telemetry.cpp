@@ -0,0 +1,109 @@
+#include "telemetry.h"
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <stdexcept>
+
+namespace sugar {
+
+    TelemetryReporter::TelemetryReporter(const SweepCounters& counters, std::uint64_t total, double interval_sec,
+        std::ostream* log, const std::string& jsonl_path, std::uint64_t resumed)
+        : counters_(counters), total_(total), resumed_(resumed), interval_(interval_sec > 0.0 ? interval_sec : 1.0), log_(log),
+        t0_(std::chrono::steady_clock::now()) {
+        if (!jsonl_path.empty()) {
+            jsonl_.open(jsonl_path, std::ios::app);
+            if (!jsonl_) throw std::runtime_error("Failed to open telemetry file: " + jsonl_path);
+        }
+        thread_ = std::thread([this] { loop(); });
+    }
+
+    TelemetryReporter::~TelemetryReporter() { stop(); }
+
+    void TelemetryReporter::stop() {
+        if (!thread_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+        take_sample(true);                                              // the final numbers, whatever the interval
+    }
+
+    void TelemetryReporter::loop() {
+        std::unique_lock<std::mutex> lock(mu_);
+        auto next = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval_);
+        while (!cv_.wait_until(lock, next, [this] { return stopping_; })) {
+            lock.unlock();
+            take_sample(false);
+            lock.lock();
+            next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval_);
+        }
+    }
+
+    void TelemetryReporter::take_sample(bool final) {
+        TelemetrySample s;
+        s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0_).count();
+        s.done = counters_.done.load(std::memory_order_relaxed);
+        s.pruned = counters_.pruned.load(std::memory_order_relaxed);
+        s.bars = counters_.bars.load(std::memory_order_relaxed);
+        s.best = counters_.best.load(std::memory_order_relaxed);
+        s.kth = counters_.kth.load(std::memory_order_relaxed);
+        s.total = total_;
+
+        TelemetrySample prev = samples_.empty() || final ? TelemetrySample{} : samples_.back();
+        if (samples_.empty() || final) prev.done = resumed_;
+        const double dt = s.seconds - prev.seconds;
+        if (dt > 0.0) {
+            s.combos_per_sec = double(s.done - prev.done) / dt;
+            s.bars_per_sec = double(s.bars - prev.bars) / dt;
+        }
+        const std::uint64_t ran = s.done > resumed_ ? s.done - resumed_ : 0;
+        s.eta_sec = ran > 0 && s.seconds > 0.0
+            ? double(total_ > s.done ? total_ - s.done : 0) * s.seconds / double(ran) : -1.0;
+        samples_.push_back(s);
+
+        if (log_) {
+            const double pct = total_ ? 100.0 * double(s.done) / double(total_) : 100.0;
+            const auto flags = log_->flags();
+            const auto prec = log_->precision();
+            *log_ << "[sweep] " << s.done << " / " << total_ << " combos (" << std::fixed << std::setprecision(1) << pct
+                << "%) | " << std::setprecision(0) << s.combos_per_sec << " combos/s, " << std::setprecision(1)
+                << s.bars_per_sec / 1e6 << " M bars/s | ETA " << (s.eta_sec < 0 ? std::string("?") : format_duration(s.eta_sec));
+            if (std::isfinite(s.best)) *log_ << " | best " << std::setprecision(2) << s.best;
+            if (std::isfinite(s.kth)) *log_ << ", K-th " << std::setprecision(2) << s.kth;
+            *log_ << "\n";
+            log_->flags(flags);
+            log_->precision(prec);
+        }
+        if (jsonl_) {
+            auto num = [](double v) { return std::isfinite(v) ? std::to_string(v) : std::string("null"); };
+            jsonl_ << "{\"t\": " << num(s.seconds) << ", \"done\": " << s.done << ", \"total\": " << s.total
+                << ", \"pruned\": " << s.pruned << ", \"bars\": " << s.bars << ", \"combos_per_sec\": " << num(s.combos_per_sec)
+                << ", \"bars_per_sec\": " << num(s.bars_per_sec) << ", \"eta_sec\": " << (s.eta_sec < 0 ? "null" : num(s.eta_sec))
+                << ", \"best\": " << num(s.best) << ", \"kth\": " << num(s.kth) << "}\n";
+            jsonl_.flush();
+        }
+    }
+
+    std::string format_duration(double seconds) {
+        if (!(seconds >= 0.0)) return "?";
+        const auto s = static_cast<std::uint64_t>(std::llround(seconds));
+        char buf[32];
+        if (s < 60) std::snprintf(buf, sizeof(buf), "%llus", static_cast<unsigned long long>(s));
+        else if (s < 3600) std::snprintf(buf, sizeof(buf), "%llum%02llus", static_cast<unsigned long long>(s / 60), static_cast<unsigned long long>(s % 60));
+        else if (s < 86400) std::snprintf(buf, sizeof(buf), "%lluh%02llum", static_cast<unsigned long long>(s / 3600), static_cast<unsigned long long>(s % 3600 / 60));
+        else std::snprintf(buf, sizeof(buf), "%llud%02lluh", static_cast<unsigned long long>(s / 86400), static_cast<unsigned long long>(s % 86400 / 3600));
+        return buf;
+    }
+
+    std::string format_bytes(double bytes) {
+        static const char* units[] = { "B", "KB", "MB", "GB", "TB" };
+        std::size_t u = 0;
+        while (bytes >= 1024.0 && u + 1 < std::size(units)) { bytes /= 1024.0; ++u; }
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), u == 0 ? "%.0f %s" : "%.1f %s", bytes, units[u]);
+        return buf;
+    }
+
+} // namespace sugar
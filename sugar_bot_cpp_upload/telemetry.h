@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "spsc.h"
+
+namespace sugar {
+
+    // Live counters of a running sweep. The sweep thread is the only writer
+    // and stores with relaxed ordering once per combo; the reporter reads them
+    // once per interval. Nothing here locks, and the line is the sweep's own
+    // except for those rare reads.
+    struct alignas(kCacheLine) SweepCounters {
+        std::atomic<std::uint64_t> done{ 0 };                           // combos evaluated (pruned included)
+        std::atomic<std::uint64_t> pruned{ 0 };
+        std::atomic<std::uint64_t> bars{ 0 };                           // strategy bars visited by this process (not before a resume)
+        std::atomic<double> best{ -std::numeric_limits<double>::infinity() };
+        std::atomic<double> kth{ -std::numeric_limits<double>::infinity() };    // K-th best score: the bar a combo must clear
+
+        void publish(std::uint64_t d, std::uint64_t p, std::uint64_t b, double best_score, double kth_score) {
+            done.store(d, std::memory_order_relaxed);
+            pruned.store(p, std::memory_order_relaxed);
+            bars.store(b, std::memory_order_relaxed);
+            best.store(best_score, std::memory_order_relaxed);
+            kth.store(kth_score, std::memory_order_relaxed);
+        }
+    };
+
+    struct TelemetrySample {
+        double seconds{};                                               // since the reporter started
+        std::uint64_t done{}, total{}, pruned{}, bars{};
+        double combos_per_sec{};                                        // over the last interval
+        double bars_per_sec{};
+        double eta_sec{};                                               // remaining / average rate so far; -1 before the first combo
+        double best{}, kth{};
+    };
+
+    // Background thread that samples SweepCounters at a fixed wall-clock
+    // interval and prints one progress line per sample to `log` (may be null)
+    // and, if `jsonl_path` is set, appends the sample as a JSON line. Samples
+    // are kept for the caller; the last one is taken in stop() and carries
+    // the average rates over the whole run instead of the last interval. `resumed`
+    // is the count already done when the reporter starts (a resumed sweep),
+    // left out of the rates.
+    class TelemetryReporter {
+    public:
+        TelemetryReporter(const SweepCounters& counters, std::uint64_t total, double interval_sec,
+            std::ostream* log, const std::string& jsonl_path = {}, std::uint64_t resumed = 0);
+        ~TelemetryReporter();
+
+        TelemetryReporter(const TelemetryReporter&) = delete;
+        TelemetryReporter& operator=(const TelemetryReporter&) = delete;
+
+        void stop();                                                    // final sample, then join; idempotent
+        const std::vector<TelemetrySample>& samples() const { return samples_; }    // valid after stop()
+
+    private:
+        void loop();
+        void take_sample(bool final);
+
+        const SweepCounters& counters_;
+        const std::uint64_t total_;
+        const std::uint64_t resumed_;
+        const std::chrono::duration<double> interval_;
+        std::ostream* log_;
+        std::ofstream jsonl_;
+        const std::chrono::steady_clock::time_point t0_;
+        std::vector<TelemetrySample> samples_;
+        std::mutex mu_;
+        std::condition_variable cv_;
+        bool stopping_ = false;
+        std::thread thread_;
+    };
+
+    std::string format_duration(double seconds);                       // "42s", "3m07s", "2h05m", "3d04h"
+    std::string format_bytes(double bytes);                             // "512 B", "1.5 MB", ...
+
+} // namespace sugar
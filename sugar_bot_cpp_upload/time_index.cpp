@@ -0,0 +1,69 @@
+#include "time_index.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace sugar {
+
+    TimeIndex::TimeIndex(std::span<const Candle> rows) : n_(rows.size()) {
+        for (std::size_t i = 1; i < rows.size(); ++i)
+            if (rows[i].ts <= rows[i - 1].ts)
+                throw std::invalid_argument("TimeIndex: bar times must strictly increase (bar " + std::to_string(i) + ")");
+
+        for (std::size_t i = 0; i < rows.size();) {                     // greedy: extend each run while the spacing holds
+            Run r{ i, rows[i].ts, 0 };
+            std::size_t j = i + 1;
+            if (j < rows.size()) {
+                r.step = rows[j].ts - rows[i].ts;
+                while (j + 1 < rows.size() && rows[j + 1].ts - rows[j].ts == r.step) ++j;
+                ++j;
+            }
+            runs_.push_back(r);
+            if (runs_.size() * sizeof(Run) >= rows.size() * sizeof(std::int64_t)) {    // no structure worth keeping
+                runs_.clear(); runs_.shrink_to_fit();
+                times_.reserve(rows.size());
+                for (const Candle& c : rows) times_.push_back(c.ts);
+                return;
+            }
+            i = j;
+        }
+        runs_.shrink_to_fit();
+    }
+
+    std::size_t TimeIndex::run_of_time(std::int64_t ts) const {
+        if (runs_.size() == 1) return 0;
+        const auto it = std::upper_bound(runs_.begin(), runs_.end(), ts, [](std::int64_t t, const Run& r) { return t < r.t0; });
+        return it == runs_.begin() ? 0 : static_cast<std::size_t>(it - runs_.begin()) - 1;
+    }
+
+    std::int64_t TimeIndex::time_at(std::size_t bar) const {
+        if (bar >= n_) throw std::out_of_range("TimeIndex::time_at: bar out of range");
+        if (!times_.empty()) return times_[bar];
+        const auto it = std::upper_bound(runs_.begin(), runs_.end(), bar, [](std::size_t b, const Run& r) { return b < r.first; });
+        const Run& r = *(it - 1);
+        return r.t0 + static_cast<std::int64_t>(bar - r.first) * r.step;
+    }
+
+    std::size_t TimeIndex::lower_bound(std::int64_t ts) const {
+        if (!times_.empty()) return static_cast<std::size_t>(std::lower_bound(times_.begin(), times_.end(), ts) - times_.begin());
+        if (n_ == 0) return 0;
+        const std::size_t ri = run_of_time(ts);
+        const Run& r = runs_[ri];
+        const std::size_t end = ri + 1 < runs_.size() ? runs_[ri + 1].first : n_;
+        if (ts <= r.t0) return r.first;
+        if (r.step == 0) return r.first + 1;
+        const std::int64_t k = (ts - r.t0 + r.step - 1) / r.step;      // ceil: first bar at or after ts
+        return std::min(end, r.first + static_cast<std::size_t>(k));    // past the run: the next run starts later than ts
+    }
+
+    std::size_t TimeIndex::find(std::int64_t ts) const {
+        const std::size_t i = lower_bound(ts);
+        return i < n_ && time_at(i) == ts ? i : npos;
+    }
+
+    std::pair<std::size_t, std::size_t> TimeIndex::range(std::int64_t from, std::int64_t to) const {
+        const std::size_t b = lower_bound(from);
+        return { b, std::max(b, lower_bound(to)) };
+    }
+
+} // namespace sugar
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+#include "candle.h"
+
+namespace sugar {
+
+    // Bar times of a series (Candle::ts), stored as runs of equal spacing.
+    //
+    // A run is (first bar, first time, step): bars [first, next run's first)
+    // sit at t0 + k * step. A regular series is one run, so time <-> bar is
+    // plain arithmetic, and a minute-bar history with a gap per session or
+    // weekend needs one run per session. Lookups are O(log runs); when the
+    // times are so irregular that runs would take more room than the raw
+    // times, the raw times are kept instead (O(log n)).
+    class TimeIndex {
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        TimeIndex() = default;
+        explicit TimeIndex(std::span<const Candle> rows);               // throws std::invalid_argument unless ts strictly increases
+
+        std::size_t size() const { return n_; }
+        bool regular() const { return n_ > 0 && times_.empty() && runs_.size() == 1; }
+        std::int64_t step() const { return regular() ? runs_[0].step : 0; }   // bar spacing of a regular series, else 0
+        std::size_t runs() const { return times_.empty() ? runs_.size() : 0; }
+        std::size_t bytes() const { return runs_.capacity() * sizeof(Run) + times_.capacity() * sizeof(std::int64_t); }
+
+        std::int64_t time_at(std::size_t bar) const;
+        std::size_t lower_bound(std::int64_t ts) const;                 // first bar at or after ts (size() if none)
+        std::size_t find(std::int64_t ts) const;                        // bar exactly at ts, or npos
+        std::pair<std::size_t, std::size_t> range(std::int64_t from, std::int64_t to) const;    // bars with from <= ts < to
+
+    private:
+        struct Run { std::size_t first; std::int64_t t0, step; };      // step 0 for a one-bar run
+
+        std::size_t run_of_time(std::int64_t ts) const;                 // last run starting at or before ts (0 if none)
+
+        std::vector<Run> runs_;
+        std::vector<std::int64_t> times_;                               // fallback for irregular series
+        std::size_t n_ = 0;
+    };
+
+} // namespace sugar
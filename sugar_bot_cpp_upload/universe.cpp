@@ -0,0 +1,249 @@
+#include "universe.h"
+#include "candle_file.h"
+#include "parallel.h"
+#include "strategy_roc_sma.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+namespace sugar {
+
+    CandleArena::CandleArena(std::size_t block_candles) : block_candles_(block_candles < 1 ? 1 : block_candles) {}
+
+    CandleSeries CandleArena::add(const std::vector<Candle>& rows) {
+        std::shared_ptr<std::vector<Candle>> block;
+        std::size_t at = 0;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (rows.size() > block_candles_) {                         // oversized symbol: a block of its own
+                block = std::make_shared<std::vector<Candle>>(rows.size());
+                capacity_ += rows.size();
+            }
+            else {
+                if (!open_ || used_ + rows.size() > block_candles_) {
+                    open_ = std::make_shared<std::vector<Candle>>(block_candles_);
+                    capacity_ += block_candles_;
+                    used_ = 0;
+                }
+                block = open_;
+                at = used_;
+                used_ += rows.size();
+            }
+            candles_ += rows.size();
+        }
+        std::copy(rows.begin(), rows.end(), block->begin() + static_cast<std::ptrdiff_t>(at));   // disjoint range: no lock needed
+        return CandleSeries(block, at, rows.size());
+    }
+
+    std::size_t CandleArena::candles() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return candles_;
+    }
+
+    std::size_t CandleArena::capacity() const {
+        std::lock_guard<std::mutex> lock(mu_);
+        return capacity_;
+    }
+
+    std::vector<std::string> list_universe(const std::string& dir) {
+        namespace fs = std::filesystem;
+        if (!fs::is_directory(dir)) throw std::runtime_error("Universe directory not found: " + dir);
+        std::vector<std::string> out;
+        for (const auto& e : fs::directory_iterator(dir))
+            if (e.is_regular_file() && (e.path().extension() == ".csv" || e.path().extension() == ".scb")) out.push_back(e.path().string());
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    PortfolioResult run_universe(const std::string& dir, const UniverseOptions& opts) {
+        using clock = std::chrono::steady_clock;
+        auto secs = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+
+        PortfolioResult out;
+        const auto files = list_universe(dir);
+        const std::size_t F = files.size();
+        out.symbols.resize(F);
+        PipelineStats& st = out.stages;
+        st.loader_threads = std::max<std::size_t>(1, opts.loader_threads);
+        st.compute_threads = resolve_threads(opts.threads);
+
+        CandleArena arena(opts.block_candles);
+        struct Done { CandleSeries data; TradeTrace trace; };
+
+        std::mutex mu;                                                  // guards everything down to `error`
+        std::condition_variable cv_space, cv_items;
+        std::deque<std::pair<std::size_t, CandleSeries>> queue;         // loaded, waiting for a compute thread
+        std::map<std::size_t, Done> done;                               // finished, waiting for their turn to fold
+        std::size_t next_file = 0, loaders_left = st.loader_threads;
+        std::size_t resident_symbols = 0, resident_candles = 0;
+        std::exception_ptr error;
+
+        std::mutex fold_mu;                                             // one folder at a time, strictly in symbol order
+        std::size_t next_fold = 0;
+        std::map<int, double> by_date;                                  // summed bar P&L of every symbol, per date
+
+        auto full = [&]() {
+            if (resident_symbols == 0) return false;                    // always admit one, however large
+            return (opts.max_resident_symbols && resident_symbols >= opts.max_resident_symbols)
+                || (opts.max_resident_candles && resident_candles >= opts.max_resident_candles);
+        };
+
+        // Folds every finished symbol whose predecessors are folded, then frees it.
+        auto fold_ready = [&]() {
+            std::lock_guard<std::mutex> folding(fold_mu);
+            for (;;) {
+                Done d;
+                {
+                    std::lock_guard<std::mutex> lock(mu);
+                    auto it = done.find(next_fold);
+                    if (it == done.end()) return;
+                    d = std::move(it->second);
+                    done.erase(it);
+                }
+                if (out.symbols[next_fold].error.empty()) {
+                    const auto& pnl = d.trace.bar_pnl;
+                    for (std::size_t j = 0; j < pnl.size(); ++j) by_date[d.data[j].date] += pnl[j];
+                }
+                std::lock_guard<std::mutex> lock(mu);
+                --resident_symbols;
+                resident_candles -= d.data.size();
+                ++next_fold;
+                cv_space.notify_all();
+            }
+        };
+
+        auto fail = [&]() {
+            std::lock_guard<std::mutex> lock(mu);
+            if (!error) error = std::current_exception();
+            cv_space.notify_all(); cv_items.notify_all();
+        };
+
+        auto loader = [&]() {
+            double busy = 0.0, blocked = 0.0;
+            for (;;) {
+                std::size_t i;
+                {
+                    std::unique_lock<std::mutex> lock(mu);
+                    const auto w0 = clock::now();
+                    cv_space.wait(lock, [&] { return error || next_file == F || !full(); });
+                    blocked += secs(clock::now() - w0);
+                    if (error || next_file == F) break;
+                    i = next_file++;
+                    ++resident_symbols;
+                    out.peak_resident_symbols = std::max(out.peak_resident_symbols, resident_symbols);
+                }
+                const auto t0 = clock::now();
+                SymbolResult& sr = out.symbols[i];
+                sr.symbol = std::filesystem::path(files[i]).stem().string();
+                CandleSeries data;
+                try {
+                    data = arena.add(load_candles(files[i], opts.mmap));
+                }
+                catch (const std::exception& ex) { sr.error = ex.what(); }
+                if (sr.error.empty() && data.size() == 0) sr.error = "no candles";
+                busy += secs(clock::now() - t0);
+
+                const bool skip = !sr.error.empty();
+                {
+                    std::lock_guard<std::mutex> lock(mu);
+                    resident_candles += data.size();
+                    out.peak_resident_candles = std::max(out.peak_resident_candles, resident_candles);
+                    if (skip) done.emplace(i, Done{ std::move(data), {} });
+                    else { queue.emplace_back(i, std::move(data)); cv_items.notify_one(); }
+                }
+                if (skip) fold_ready();
+            }
+            std::lock_guard<std::mutex> lock(mu);
+            st.load_busy += busy; st.load_blocked += blocked;
+            if (--loaders_left == 0) cv_items.notify_all();
+        };
+
+        auto compute = [&]() {
+            double busy = 0.0, starved = 0.0;
+            for (;;) {
+                std::pair<std::size_t, CandleSeries> item;
+                {
+                    std::unique_lock<std::mutex> lock(mu);
+                    const auto w0 = clock::now();
+                    cv_items.wait(lock, [&] { return error || !queue.empty() || loaders_left == 0; });
+                    starved += secs(clock::now() - w0);
+                    if (error || queue.empty()) break;
+                    item = std::move(queue.front());
+                    queue.pop_front();
+                }
+                const auto t0 = clock::now();
+                try {
+                    SymbolResult& sr = out.symbols[item.first];
+                    const CandleSeries& data = item.second;
+                    sr.bars = data.size();
+                    sr.first_date = data[0].date;
+                    sr.last_date = data[data.size() - 1].date;
+                    sr.params = opts.params;
+                    if (opts.sweep) {
+                        SweepOptions so;
+                        so.quiet = true; so.top_k = 1;
+                        const auto& sp = opts.space;
+                        sr.params = sweep_roc_sma(data, sp.fasts, sp.slows, sp.rocs, sp.threshes, so).params;
+                    }
+                    Done d{ data, {} };
+                    const auto [f, s, rlen, th] = sr.params;
+                    const RocSmaCrossoverStrategy strat{ f, s, rlen, th };
+                    sr.result = strat.run_window(SmaBank(data, { f, s }), 0, data.size(), &d.trace);
+                    busy += secs(clock::now() - t0);
+                    {
+                        std::lock_guard<std::mutex> lock(mu);
+                        done.emplace(item.first, std::move(d));
+                    }
+                    fold_ready();
+                }
+                catch (...) { fail(); break; }
+            }
+            std::lock_guard<std::mutex> lock(mu);
+            st.compute_busy += busy; st.compute_starved += starved;
+        };
+
+        const auto w0 = clock::now();
+        std::vector<std::thread> pool;
+        for (std::size_t t = 0; t < st.loader_threads; ++t) pool.emplace_back(loader);
+        for (std::size_t t = 0; t < st.compute_threads; ++t) pool.emplace_back(compute);
+        for (auto& th : pool) th.join();
+        st.wall_seconds = secs(clock::now() - w0);
+        if (error) std::rethrow_exception(error);
+
+        // ---- aggregates ----
+        std::vector<double> pnls;
+        for (const auto& sr : out.symbols) {
+            if (!sr.error.empty()) { ++out.failed; continue; }
+            ++out.loaded;
+            pnls.push_back(sr.result.pnl);
+            out.mean_pnl += sr.result.pnl;
+            out.mean_drawdown += sr.result.max_drawdown;
+            out.win_rate += sr.result.pnl > 0.0;
+            out.trades += sr.result.trades;
+            const int d = sr.result.best_start_date;
+            if (d > 0 && (out.portfolio.best_start_date == 0 || d < out.portfolio.best_start_date)) out.portfolio.best_start_date = d;
+        }
+        if (out.loaded == 0) return out;
+        const double N = static_cast<double>(out.loaded);
+        out.mean_pnl /= N; out.mean_drawdown /= N; out.win_rate /= N;
+        std::sort(pnls.begin(), pnls.end());
+        out.median_pnl = pnls.size() % 2 ? pnls[pnls.size() / 2] : 0.5 * (pnls[pnls.size() / 2 - 1] + pnls[pnls.size() / 2]);
+
+        // Equal capital per symbol: the portfolio moves by the mean symbol P&L each date.
+        double equity = 0.0, peak = 0.0;
+        for (const auto& [date, sum] : by_date) {
+            equity += sum / N; peak = std::max(peak, equity);
+            out.portfolio.max_drawdown = std::max(out.portfolio.max_drawdown, peak - equity);
+        }
+        out.portfolio.pnl = equity;
+        out.portfolio.trades = out.trades;
+        return out;
+    }
+
+} // namespace sugar
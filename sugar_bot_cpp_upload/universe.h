@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "candle.h"
+#include "metrics.h"
+#include "optimizer.h"
+#include "series.h"
+#include "sweep.h"
+
+namespace sugar {
+
+    // Bump allocator for candles of many symbols. Candles live in a few large
+    // fixed-size blocks instead of one vector per symbol; each symbol's
+    // CandleSeries is a view into a block and keeps that block alive, so a
+    // block is freed once the arena and every series in it are gone.
+    // add() may be called from several threads at once.
+    class CandleArena {
+    public:
+        explicit CandleArena(std::size_t block_candles = std::size_t(1) << 20);
+
+        CandleArena(const CandleArena&) = delete;
+        CandleArena& operator=(const CandleArena&) = delete;
+
+        CandleSeries add(const std::vector<Candle>& rows);
+
+        std::size_t candles() const;                                    // stored
+        std::size_t capacity() const;                                   // allocated, in candles
+
+    private:
+        std::size_t block_candles_;
+        mutable std::mutex mu_;
+        std::shared_ptr<std::vector<Candle>> open_;                     // block currently being filled
+        std::size_t used_{};                                            // candles used in open_
+        std::size_t candles_{};
+        std::size_t capacity_{};
+    };
+
+    struct UniverseOptions {
+        std::size_t threads = 0;                                        // compute threads; 0 = hardware concurrency
+        std::size_t loader_threads = 2;                                 // parse/map threads feeding them
+        std::size_t max_resident_symbols = 0;                           // loaded but not yet folded; 0 = no limit
+        std::size_t max_resident_candles = std::size_t(1) << 24;        // same, in candles; 0 = no limit
+        bool mmap = true;                                               // load_candles_csv_mapped instead of the stream loader
+        std::size_t block_candles = std::size_t(1) << 16;               // arena block size
+        bool sweep = false;                                             // false: run `params` on every symbol
+        RocSmaParams params{};                                          // single-run mode
+        RocSmaSpace space;                                              // sweep mode: each symbol's own winner
+    };
+
+    struct SymbolResult {
+        std::string symbol;                                             // file name without extension
+        std::size_t bars{};
+        int first_date{}, last_date{};
+        RocSmaParams params{};                                          // the run's (or the symbol's winning) parameters
+        BacktestResult result;
+        std::string error;                                              // non-empty: load failed, symbol skipped
+    };
+
+    // Where the load/compute pipeline spent its time. busy = doing work,
+    // blocked = loaders waiting for memory to free up (compute is the
+    // bottleneck), starved = compute threads waiting for data (I/O is).
+    struct PipelineStats {
+        std::size_t loader_threads{}, compute_threads{};
+        double wall_seconds{};
+        double load_busy{}, load_blocked{};                             // thread-seconds
+        double compute_busy{}, compute_starved{};
+
+        double load_utilization() const { return share(load_busy, loader_threads); }
+        double compute_utilization() const { return share(compute_busy, compute_threads); }
+        double share(double s, std::size_t n) const { return wall_seconds > 0 && n ? s / (wall_seconds * double(n)) : 0.0; }
+    };
+
+    struct PortfolioResult {
+        std::vector<SymbolResult> symbols;                              // sorted by symbol
+        std::size_t loaded{}, failed{};
+        double mean_pnl{}, median_pnl{}, mean_drawdown{};
+        double win_rate{};                                              // share of symbols with pnl > 0
+        std::size_t trades{};
+        BacktestResult portfolio;                                       // equal capital per symbol, bar P&L summed by date
+        std::size_t peak_resident_candles{};                            // most candles held at once
+        std::size_t peak_resident_symbols{};
+        PipelineStats stages;
+    };
+
+    // *.csv and *.scb files in `dir`, sorted by name.
+    std::vector<std::string> list_universe(const std::string& dir);
+
+    // Bounded load/compute pipeline: loader threads parse (or map) the next
+    // symbols into an arena while compute threads run or sweep the ones
+    // already loaded. Results are folded into the portfolio in symbol order;
+    // a symbol's candles and bar P&L stay resident until it is folded, and
+    // loaders stop claiming new files while the resident limits are reached
+    // (each loader may overshoot by the one file it is parsing).
+    PortfolioResult run_universe(const std::string& dir, const UniverseOptions& opts);
+
+} // namespace sugar
@@ -1,159 +1,277 @@
-#include "utils.h"
-#include <charconv>
-#include <limits>
-
-namespace sugar {
-
-    // ---- helpers -------------------------------------------------------------
-
-    static inline bool parse_int(std::string_view sv, int& out) {
-        // from_chars: no allocs, no locale
-        const char* b = sv.data();
-        const char* e = sv.data() + sv.size();
-        auto res = std::from_chars(b, e, out);
-        return (res.ec == std::errc());
-    }
-
-    static inline bool parse_2(std::string_view sv, int& out) {
-        if (sv.size() != 2) return false;
-        return parse_int(sv, out);
-    }
-    static inline bool parse_4(std::string_view sv, int& out) {
-        if (sv.size() != 4) return false;
-        return parse_int(sv, out);
-    }
-
-    // Parse "YYYY-MM-DD" into YYYYMMDD (no validation beyond ranges).
-    static inline int pack_date(int y, int m, int d) {
-        if (y <= 0 || m < 1 || m > 12 || d < 1 || d > 31) return -1;
-        return y * 10000 + m * 100 + d;
-    }
-
-    // Try parse just the date portion at s[0..9] where s[4]=='-' and s[7]=='-'.
-    static inline int try_parse_yyyy_mm_dd(std::string_view s) {
-        if (s.size() < 10) return -1;
-        if (!(s[4] == '-' && s[7] == '-')) return -1;
-        int y = -1, m = -1, d = -1;
-        if (!parse_4(s.substr(0, 4), y)) return -1;
-        if (!parse_2(s.substr(5, 2), m)) return -1;
-        if (!parse_2(s.substr(8, 2), d)) return -1;
-        return pack_date(y, m, d);
-    }
-
-    // ---- public API ----------------------------------------------------------
-
-    int parse_yyyymmdd(std::string_view s) {
-        // 1) "YYYYMMDD"
-        if (s.size() == 8) {
-            int v = -1;
-            if (parse_int(s, v)) return v;
-        }
-
-        // 2) "YYYY-MM-DD"
-        if (s.size() == 10 && s[4] == '-' && s[7] == '-') {
-            return try_parse_yyyy_mm_dd(s);
-        }
-
-        // 3) "YYYY/MM/DD"
-        if (s.size() == 10 && s[4] == '/' && s[7] == '/') {
-            int y = -1, m = -1, d = -1;
-            if (!parse_4(s.substr(0, 4), y)) return -1;
-            if (!parse_2(s.substr(5, 2), m)) return -1;
-            if (!parse_2(s.substr(8, 2), d)) return -1;
-            return pack_date(y, m, d);
-        }
-
-        // 4) "MM/DD/YYYY"
-        if (s.size() == 10 && s[2] == '/' && s[5] == '/') {
-            int m = -1, d = -1, y = -1;
-            if (!parse_2(s.substr(0, 2), m)) return -1;
-            if (!parse_2(s.substr(3, 2), d)) return -1;
-            if (!parse_4(s.substr(6, 4), y)) return -1;
-            return pack_date(y, m, d);
-        }
-
-        // 5) ISO-8601 datetime variants: "YYYY-MM-DDTHH:MM[:SS][Z|HH:MM]"
-            //    legacy API still needs DATE  just slice s[0..9].
-            //    Accept strings with 'T' after position 10.
-        if (s.size() >= 19 && s[4] == '-' && s[7] == '-' && s[10] == 'T') {
-            return try_parse_yyyy_mm_dd(s.substr(0, 10));
-        }
-
-        return -1; // invalid
-    }
-
-    void format_yyyymmdd(int yyyymmdd, char out[9]) {
-        // Render as 8 ASCII digits, most significant first.
-        for (int i = 7; i >= 0; --i) {
-            out[i] = char('0' + (yyyymmdd % 10));
-            yyyymmdd /= 10;
-        }
-        // Note: no null terminator required if printed via string_view(out, 8).
-    }
-
-    // --- Full ISO-8601 date-time parser ---------------------------------
-
-    // Expected: YYYY-MM-DD 'T' HH:MM [':' SS]? ( 'Z' | ('+'|'-') HH ':' MM )?
-    // Returns true on success and fills outputs.
-    bool parse_iso8601_datetime(std::string_view s,
-        int& yyyymmdd,
-        int& seconds_since_mid,
-        int& tz_offset_minutes)
-    {
-        // Date
-        if (s.size() < 16) return false;           // minimal: YYYY-MM-DDTHH:MM
-        if (!(s[4] == '-' && s[7] == '-' && s[10] == 'T')) return false;
-
-        yyyymmdd = try_parse_yyyy_mm_dd(s.substr(0, 10));
-        if (yyyymmdd < 0) return false;
-
-        // Time HH:MM[(:SS)?]
-        int hh = -1, mm = -1, ss = 0;
-        if (!parse_2(s.substr(11, 2), hh)) return false;
-        if (s[13] != ':') return false;
-        if (!parse_2(s.substr(14, 2), mm)) return false;
-
-        std::size_t pos = 16;
-        if (pos < s.size() && s[pos] == ':') {
-            // seconds present
-            if (pos + 3 > s.size()) return false;
-            if (!parse_2(s.substr(pos + 1, 2), ss)) return false;
-            pos += 3; // move past ":SS"
-        }
-
-        seconds_since_mid = hh * 3600 + mm * 60 + ss;
-
-        // Timezone: optional
-        tz_offset_minutes = 0; // default to 0 if absent
-        if (pos >= s.size()) return true;
-
-        char tzch = s[pos];
-        if (tzch == 'Z') {
-            // Zulu/UTC
-            if (pos + 1 != s.size()) {
-                // allow trailing char only if Z is last
-                // if more stuff, reject
-                return false;
-            }
-            tz_offset_minutes = 0;
-            return true;
-        }
-
-        if (tzch == '+' || tzch == '-') {
-            // Expect HH:MM
-            if (pos + 6 != s.size()) return false;
-            int tzh = -1, tzm = -1;
-            if (!parse_2(s.substr(pos + 1, 2), tzh)) return false;
-            if (s[pos + 3] != ':') return false;
-            if (!parse_2(s.substr(pos + 4, 2), tzm)) return false;
-            int sign = (tzch == '-') ? -1 : 1;
-            tz_offset_minutes = sign * (tzh * 60 + tzm);
-            return true;
-        }
-
-        // Anything else after time don't accept.
-
-        return false;
-    }
-
-} // namespace sugar
+#include "utils.h"
+#include <charconv>
+#include <limits>
+
+namespace sugar {
+
+    // ---- helpers -------------------------------------------------------------
+
+    static inline bool parse_int(std::string_view sv, int& out) {
+        // from_chars: no allocs, no locale
+        const char* b = sv.data();
+        const char* e = sv.data() + sv.size();
+        auto res = std::from_chars(b, e, out);
+        return (res.ec == std::errc());
+    }
+
+    static inline bool parse_2(std::string_view sv, int& out) {
+        if (sv.size() != 2) return false;
+        return parse_int(sv, out);
+    }
+    static inline bool parse_4(std::string_view sv, int& out) {
+        if (sv.size() != 4) return false;
+        return parse_int(sv, out);
+    }
+
+    // Parse "YYYY-MM-DD" into YYYYMMDD (no validation beyond ranges).
+    static inline int pack_date(int y, int m, int d) {
+        if (y <= 0 || m < 1 || m > 12 || d < 1 || d > 31) return -1;
+        return y * 10000 + m * 100 + d;
+    }
+
+    // Try parse just the date portion at s[0..9] where s[4]=='-' and s[7]=='-'.
+    static inline int try_parse_yyyy_mm_dd(std::string_view s) {
+        if (s.size() < 10) return -1;
+        if (!(s[4] == '-' && s[7] == '-')) return -1;
+        int y = -1, m = -1, d = -1;
+        if (!parse_4(s.substr(0, 4), y)) return -1;
+        if (!parse_2(s.substr(5, 2), m)) return -1;
+        if (!parse_2(s.substr(8, 2), d)) return -1;
+        return pack_date(y, m, d);
+    }
+
+    // ---- public API ----------------------------------------------------------
+
+    int parse_yyyymmdd(std::string_view s) {
+        // 1) "YYYYMMDD"
+        if (s.size() == 8) {
+            int v = -1;
+            if (parse_int(s, v)) return v;
+        }
+
+        // 2) "YYYY-MM-DD"
+        if (s.size() == 10 && s[4] == '-' && s[7] == '-') {
+            return try_parse_yyyy_mm_dd(s);
+        }
+
+        // 3) "YYYY/MM/DD"
+        if (s.size() == 10 && s[4] == '/' && s[7] == '/') {
+            int y = -1, m = -1, d = -1;
+            if (!parse_4(s.substr(0, 4), y)) return -1;
+            if (!parse_2(s.substr(5, 2), m)) return -1;
+            if (!parse_2(s.substr(8, 2), d)) return -1;
+            return pack_date(y, m, d);
+        }
+
+        // 4) "MM/DD/YYYY"
+        if (s.size() == 10 && s[2] == '/' && s[5] == '/') {
+            int m = -1, d = -1, y = -1;
+            if (!parse_2(s.substr(0, 2), m)) return -1;
+            if (!parse_2(s.substr(3, 2), d)) return -1;
+            if (!parse_4(s.substr(6, 4), y)) return -1;
+            return pack_date(y, m, d);
+        }
+
+        // 5) ISO-8601 datetime variants: "YYYY-MM-DDTHH:MM[:SS][Z|HH:MM]"
+            //    legacy API still needs DATE  just slice s[0..9].
+            //    Accept strings with 'T' after position 10.
+        if (s.size() >= 19 && s[4] == '-' && s[7] == '-' && s[10] == 'T') {
+            return try_parse_yyyy_mm_dd(s.substr(0, 10));
+        }
+
+        return -1; // invalid
+    }
+
+    void format_yyyymmdd(int yyyymmdd, char out[9]) {
+        // Render as 8 ASCII digits, most significant first.
+        for (int i = 7; i >= 0; --i) {
+            out[i] = char('0' + (yyyymmdd % 10));
+            yyyymmdd /= 10;
+        }
+        // Note: no null terminator required if printed via string_view(out, 8).
+    }
+
+    // --- Full ISO-8601 date-time parser ---------------------------------
+
+    // Expected: YYYY-MM-DD 'T' HH:MM [':' SS]? ( 'Z' | ('+'|'-') HH ':' MM )?
+    // Returns true on success and fills outputs.
+    bool parse_iso8601_datetime(std::string_view s,
+        int& yyyymmdd,
+        int& seconds_since_mid,
+        int& tz_offset_minutes)
+    {
+        // Date
+        if (s.size() < 16) return false;           // minimal: YYYY-MM-DDTHH:MM
+        if (!(s[4] == '-' && s[7] == '-' && s[10] == 'T')) return false;
+
+        yyyymmdd = try_parse_yyyy_mm_dd(s.substr(0, 10));
+        if (yyyymmdd < 0) return false;
+
+        // Time HH:MM[(:SS)?]
+        int hh = -1, mm = -1, ss = 0;
+        if (!parse_2(s.substr(11, 2), hh)) return false;
+        if (s[13] != ':') return false;
+        if (!parse_2(s.substr(14, 2), mm)) return false;
+
+        std::size_t pos = 16;
+        if (pos < s.size() && s[pos] == ':') {
+            // seconds present
+            if (pos + 3 > s.size()) return false;
+            if (!parse_2(s.substr(pos + 1, 2), ss)) return false;
+            pos += 3; // move past ":SS"
+        }
+
+        seconds_since_mid = hh * 3600 + mm * 60 + ss;
+
+        // Timezone: optional
+        tz_offset_minutes = 0; // default to 0 if absent
+        if (pos >= s.size()) return true;
+
+        char tzch = s[pos];
+        if (tzch == 'Z') {
+            // Zulu/UTC
+            if (pos + 1 != s.size()) {
+                // allow trailing char only if Z is last
+                // if more stuff, reject
+                return false;
+            }
+            tz_offset_minutes = 0;
+            return true;
+        }
+
+        if (tzch == '+' || tzch == '-') {
+            // Expect HH:MM
+            if (pos + 6 != s.size()) return false;
+            int tzh = -1, tzm = -1;
+            if (!parse_2(s.substr(pos + 1, 2), tzh)) return false;
+            if (s[pos + 3] != ':') return false;
+            if (!parse_2(s.substr(pos + 4, 2), tzm)) return false;
+            int sign = (tzch == '-') ? -1 : 1;
+            tz_offset_minutes = sign * (tzh * 60 + tzm);
+            return true;
+        }
+
+        // Anything else after time don't accept.
+
+        return false;
+    }
+
+    // --- Timestamps -------------------------------------------------------
+
+    // H. Hinnant's days_from_civil / civil_from_days.
+    std::int64_t days_from_civil(int y, unsigned m, unsigned d) {
+        y -= m <= 2;
+        const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+        const unsigned yoe = static_cast<unsigned>(y - era * 400);
+        const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+    }
+
+    int civil_from_days(std::int64_t z) {
+        z += 719468;
+        const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const unsigned doe = static_cast<unsigned>(z - era * 146097);
+        const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const std::int64_t y = static_cast<std::int64_t>(yoe) + era * 400;
+        const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const unsigned mp = (5 * doy + 2) / 153;
+        const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+        const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+        return static_cast<int>((y + (m <= 2)) * 10000 + m * 100 + d);
+    }
+
+    std::int64_t ts_from_yyyymmdd(int d) {
+        return days_from_civil(d / 10000, static_cast<unsigned>(d / 100 % 100), static_cast<unsigned>(d % 100)) * 86400;
+    }
+
+    int yyyymmdd_from_ts(std::int64_t ts) {
+        const std::int64_t days = ts >= 0 ? ts / 86400 : -((-ts + 86399) / 86400);   // floor division
+        return civil_from_days(days);
+    }
+
+    // Unsigned decimal of exactly n digits at s[at], or -1.
+    static inline int digits(std::string_view s, std::size_t at, std::size_t n) {
+        if (at + n > s.size()) return -1;
+        int v = 0;
+        for (std::size_t i = at; i < at + n; ++i) {
+            const unsigned dg = static_cast<unsigned>(s[i] - '0');
+            if (dg > 9) return -1;
+            v = v * 10 + static_cast<int>(dg);
+        }
+        return v;
+    }
+
+    std::int64_t parse_timestamp(std::string_view s, int* yyyymmdd) {
+        // Bare epoch seconds / milliseconds (an 8-digit number is YYYYMMDD, below).
+        if ((s.size() == 10 || s.size() == 13) && s.find_first_not_of("0123456789") == std::string_view::npos) {
+            std::int64_t v = 0;
+            for (char ch : s) v = v * 10 + (ch - '0');
+            if (s.size() == 13) v /= 1000;
+            if (yyyymmdd) *yyyymmdd = yyyymmdd_from_ts(v);
+            return v;
+        }
+
+        // Date only: whatever parse_yyyymmdd takes, at midnight UTC.
+        if (s.size() <= 10) {
+            const int d = parse_yyyymmdd(s);
+            if (d < 0) return kNoTimestamp;
+            if (yyyymmdd) *yyyymmdd = d;
+            return ts_from_yyyymmdd(d);
+        }
+
+        // YYYY-MM-DD[T| ]HH:MM[:SS[.fff]][Z|+HH[:]MM|-HH[:]MM]
+        if (s[4] != '-' || s[7] != '-' || (s[10] != 'T' && s[10] != ' ') || s.size() < 16 || s[13] != ':') return kNoTimestamp;
+        const int y = digits(s, 0, 4), mo = digits(s, 5, 2), d = digits(s, 8, 2);
+        const int hh = digits(s, 11, 2), mi = digits(s, 14, 2);
+        const int date = (y < 0 || mo < 0 || d < 0) ? -1 : pack_date(y, mo, d);
+        if (date < 0 || hh < 0 || hh > 23 || mi < 0 || mi > 59) return kNoTimestamp;
+        int ss = 0;
+        std::size_t pos = 16;
+        if (pos < s.size() && s[pos] == ':') {
+            ss = digits(s, pos + 1, 2);
+            if (ss < 0 || ss > 60) return kNoTimestamp;                 // 60: leap second, folds into the next minute
+            pos += 3;
+            if (pos < s.size() && (s[pos] == '.' || s[pos] == ',')) {
+                ++pos;
+                while (pos < s.size() && s[pos] >= '0' && s[pos] <= '9') ++pos;
+            }
+        }
+        int offset_min = 0;
+        if (pos < s.size()) {
+            const char z = s[pos];
+            if (z == 'Z' && pos + 1 == s.size()) {}
+            else if (z == '+' || z == '-') {
+                const std::size_t rest = s.size() - pos - 1;            // HH:MM, HHMM or HH
+                const int th = digits(s, pos + 1, 2);
+                const int tm = rest == 5 && s[pos + 3] == ':' ? digits(s, pos + 4, 2) : rest == 4 ? digits(s, pos + 3, 2) : rest == 2 ? 0 : -1;
+                if (th < 0 || th > 23 || tm < 0 || tm > 59) return kNoTimestamp;
+                offset_min = (z == '-' ? -1 : 1) * (th * 60 + tm);
+            }
+            else return kNoTimestamp;
+        }
+        if (yyyymmdd) *yyyymmdd = date;
+        return ts_from_yyyymmdd(date) + hh * 3600 + mi * 60 + ss - offset_min * 60;
+    }
+
+    void format_iso8601(std::int64_t ts, char out[20]) {
+        const int d = yyyymmdd_from_ts(ts);
+        const int sec = static_cast<int>(ts - ts_from_yyyymmdd(d));
+        auto put = [&](int at, int v, int n, char sep) {
+            for (int i = at + n - 1; i >= at; --i) { out[i] = char('0' + v % 10); v /= 10; }
+            out[at + n] = sep;
+        };
+        put(0, d / 10000, 4, '-'); put(5, d / 100 % 100, 2, '-'); put(8, d % 100, 2, 'T');
+        put(11, sec / 3600, 2, ':'); put(14, sec / 60 % 60, 2, ':'); put(17, sec % 60, 2, 'Z');
+    }
+
+    std::uint64_t fnv1a64(const void* data, std::size_t n, std::uint64_t h) {
+        const auto* p = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < n; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+} // namespace sugar
@@ -1,6 +1,7 @@
 #pragma once
 #include <string_view>
 #include <cstdint>
+#include <cstddef>
 
 namespace sugar {
 
@@ -31,4 +32,32 @@ namespace sugar {
         int& seconds_since_mid,
         int& tz_offset_minutes);
 
+                                                        // --- timestamps ----------------------------------------------------
+                                                            // Candle::ts is UTC seconds since 1970-01-01. kNoTimestamp marks a
+                                                            // field that did not parse.
+    inline constexpr std::int64_t kNoTimestamp = INT64_MIN;
+
+                                                        // Proleptic Gregorian calendar <-> days since 1970-01-01.
+    std::int64_t days_from_civil(int y, unsigned m, unsigned d);
+    int civil_from_days(std::int64_t days);                 // -> YYYYMMDD
+    std::int64_t ts_from_yyyymmdd(int yyyymmdd);            // midnight UTC of that date
+    int yyyymmdd_from_ts(std::int64_t ts);                  // UTC date of a timestamp
+
+                                                        // Parse a CSV time column into UTC seconds: every parse_yyyymmdd
+                                                            // format (midnight UTC), "YYYY-MM-DD[T| ]HH:MM[:SS[.fff]][Z|HH[:]MM]"
+                                                            // (no zone = UTC; fractions are dropped) and bare epoch seconds
+                                                            // (10 digits) or milliseconds (13 digits). Fixed-position digits,
+                                                            // no allocation. If `yyyymmdd` is given it receives the calendar date
+                                                            // as written (local date for zoned strings, like parse_yyyymmdd).
+                                                            // Returns kNoTimestamp on failure.
+    std::int64_t parse_timestamp(std::string_view s, int* yyyymmdd = nullptr);
+
+                                                        // Format UTC seconds as "YYYY-MM-DDTHH:MM:SSZ" (20 chars, no null).
+    void format_iso8601(std::int64_t ts, char out[20]);
+
+                                                        // 64-bit FNV-1a over raw bytes. Chain calls by passing the previous
+                                                            // result as `h` to hash several buffers as one stream.
+    constexpr std::uint64_t kFnvOffset = 14695981039346656037ull;
+    std::uint64_t fnv1a64(const void* data, std::size_t n, std::uint64_t h = kFnvOffset);
+
 } // namespace sugar
@@ -0,0 +1,651 @@
+// sugar_verify: differential checks of every optimized path against the frozen
+// reference kernels in reference.h.
+//
+//   sugar_verify [--seeds N] [--bars N] [--draws N] [--filter SUBSTR] [--tol REL] [--show N]
+//                [--threads N] [--rounds N]
+//   sugar_verify --bench [--sizes 100k] [--filter SUBSTR] [--min-time SECONDS]
+//
+// Runs seeded synthetic histories (--seeds of them, GBM / regime / jump, up to
+// --bars long) and a fixed set of edge-case series (empty, one bar, shorter than
+// any warm-up, flat, zero and NaN closes, sawtooth, tiny prices) through each
+// indicator kernel, strategy variant and the sweep, with --draws random
+// parameter sets per series. Indicator arrays and BacktestResult pnl, trades,
+// max drawdown and start date must match bit for bit (NaN matches NaN); the
+// risk metrics, which the fast paths accumulate online and the reference
+// computes in two passes, must agree within --tol (relative, absolute below 1).
+// The shared/ checks run one instance of each strategy from --threads threads at
+// once (--rounds runs of each per thread), every run on a context leased from one
+// RunContextPool, and hold each result and trade log to the same reference.
+// Exits with status 1 on any mismatch, listing the first --show of each check.
+//
+// --bench times each reference kernel against its optimized counterparts on
+// one seeded series per size instead.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <latch>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "arena.h"
+#include "indicator_bank.h"
+#include "indicators_composite.h"
+#include "indicators_ema.h"
+#include "indicators_roc.h"
+#include "indicators_sma.h"
+#include "reference.h"
+#include "rng.h"
+#include "strategy_diff_cross.h"
+#include "strategy_roc_sma.h"
+#include "strategy_rule.h"
+#include "stream.h"
+#include "sweep.h"
+#include "sweep_diff_cross.h"
+#include "swing_breakout_strategy.h"
+#include "synth.h"
+
+
+namespace ref = sugar::ref;
+
+
+// "1k" -> 1000, "2.5m" -> 2500000
+static std::size_t parse_size(const std::string& s) {
+	std::size_t used = 0;
+	const double v = std::stod(s, &used);
+	const std::string suffix = s.substr(used);
+	double mult = 1.0;
+	if (suffix == "k" || suffix == "K") mult = 1e3;
+	else if (suffix == "m" || suffix == "M") mult = 1e6;
+	else if (!suffix.empty()) throw std::runtime_error("Bad size: " + s);
+	return static_cast<std::size_t>(v * mult + 0.5);
+}
+
+
+// ---- series under test ----
+
+struct Case {
+	std::string name;
+	sugar::CandleSeries series;
+};
+
+
+static std::vector<sugar::Candle> synth(std::size_t bars, std::uint64_t seed, sugar::SynthModel model = sugar::SynthModel::Gbm) {
+	sugar::SynthOptions o;
+	o.seed = seed; o.model = model;
+	return sugar::generate_candles(o, bars);
+}
+
+
+static void set_close(sugar::Candle& c, double close) {												// keeps low <= open, close <= high
+	c.open = c.close = close;
+	c.high = std::max(c.high, close); c.low = std::min(c.low, close);
+}
+
+
+static std::vector<Case> make_cases(std::size_t seeds, std::size_t max_bars) {
+	std::vector<Case> cases;
+	auto add = [&](std::string name, std::vector<sugar::Candle> rows) { cases.push_back({ std::move(name), sugar::CandleSeries{ std::move(rows) } }); };
+
+	add("empty", {});
+	add("one_bar", synth(1, 1));
+	add("short_7", synth(7, 2));
+	{
+		auto rows = synth(300, 3);
+		for (auto& c : rows) { c.open = c.high = c.low = c.close = 100.0; }
+		add("flat", std::move(rows));
+	}
+	{
+		auto rows = synth(400, 4);																	// ROC's zero-divisor rule, zero entry prices
+		for (std::size_t i = 0; i < rows.size(); i += 37) set_close(rows[i], 0.0);
+		add("zero_closes", std::move(rows));
+	}
+	{
+		auto rows = synth(400, 5);
+		set_close(rows[200], std::numeric_limits<double>::quiet_NaN());
+		add("nan_close", std::move(rows));
+	}
+	{
+		auto rows = synth(500, 6);																	// a crossing on nearly every bar
+		for (std::size_t i = 0; i < rows.size(); ++i) set_close(rows[i], i % 2 ? 101.0 : 100.0);
+		add("sawtooth", std::move(rows));
+	}
+	{
+		auto rows = synth(300, 7);
+		for (auto& c : rows) { c.open *= 1e-6; c.high *= 1e-6; c.low *= 1e-6; c.close *= 1e-6; }
+		add("tiny_prices", std::move(rows));
+	}
+
+	const sugar::SynthModel models[] = { sugar::SynthModel::Gbm, sugar::SynthModel::Regime, sugar::SynthModel::Jump };
+	for (std::size_t s = 0; s < seeds; ++s) {
+		auto rng = sugar::rng_stream(0x5eed, s);
+		const auto model = models[s % 3];
+		const std::size_t bars = s == 0 ? max_bars : 1 + static_cast<std::size_t>(rng() % max_bars);
+		add(std::string(sugar::synth_model_name(model)) + "_" + std::to_string(s) + "_" + std::to_string(bars), synth(bars, 100 + s, model));
+	}
+	return cases;
+}
+
+
+// ---- comparison ----
+
+struct CheckStats {
+	std::size_t cases{}, failed{};
+	double max_err{};																				// largest tolerance-checked difference seen
+};
+
+
+class Verifier {
+public:
+	Verifier(std::string filter, double tol, std::size_t show) : filter_(std::move(filter)), tol_(tol), show_(show) {}
+
+	bool wanted(const std::string& check) const { return filter_.empty() || check.find(filter_) != std::string::npos; }
+
+	void series(const std::string& check, const std::string& ctx, const std::vector<double>& want, std::span<const double> got) {
+		std::string why;
+		if (want.size() != got.size()) why = "size " + std::to_string(got.size()) + " != " + std::to_string(want.size());
+		for (std::size_t i = 0; why.empty() && i < want.size(); ++i)
+			if (!same(want[i], got[i])) why = "[" + std::to_string(i) + "] " + num(got[i]) + " != " + num(want[i]);
+		record(check, ctx, why, 0.0);
+	}
+
+	void result(const std::string& check, const std::string& ctx, const ref::Run& want, const sugar::BacktestResult& got) {
+		const auto& w = want.result;
+		std::string why;
+		if (got.pruned) why = "pruned";
+		else if (!same(w.pnl, got.pnl)) why = "pnl " + num(got.pnl) + " != " + num(w.pnl);
+		else if (w.trades != got.trades) why = "trades " + std::to_string(got.trades) + " != " + std::to_string(w.trades);
+		else if (!same(w.max_drawdown, got.max_drawdown)) why = "max_drawdown " + num(got.max_drawdown) + " != " + num(w.max_drawdown);
+		else if (w.best_start_date != got.best_start_date) why = "best_start_date " + std::to_string(got.best_start_date) + " != " + std::to_string(w.best_start_date);
+		else if (w.risk.bars != got.risk.bars) why = "risk.bars " + std::to_string(got.risk.bars) + " != " + std::to_string(w.risk.bars);
+		double worst = 0.0;
+		const std::pair<const char*, double sugar::RiskMetrics::*> fields[] = {
+			{ "win_rate", &sugar::RiskMetrics::win_rate }, { "profit_factor", &sugar::RiskMetrics::profit_factor },
+			{ "avg_trade", &sugar::RiskMetrics::avg_trade }, { "avg_hold", &sugar::RiskMetrics::avg_hold },
+			{ "exposure", &sugar::RiskMetrics::exposure }, { "sharpe", &sugar::RiskMetrics::sharpe },
+			{ "sortino", &sugar::RiskMetrics::sortino }, { "ulcer", &sugar::RiskMetrics::ulcer },
+		};
+		for (const auto& [name, field] : fields) {
+			const double a = w.risk.*field, b = got.risk.*field;
+			const double err = same(a, b) ? 0.0 : std::fabs(a - b) / std::max({ 1.0, std::fabs(a), std::fabs(b) });
+			worst = std::max(worst, std::isnan(err) ? std::numeric_limits<double>::infinity() : err);
+			if (why.empty() && !(err <= tol_)) why = std::string("risk.") + name + " " + num(b) + " != " + num(a);
+		}
+		record(check, ctx, why, worst);
+	}
+
+	void equal(const std::string& check, const std::string& ctx, bool ok, const std::string& why) { record(check, ctx, ok ? "" : why, 0.0); }
+
+	// Prints the summary table; true when every check passed.
+	bool report(std::ostream& out) const {
+		std::size_t total = 0, failed = 0;
+		out << std::left << std::setw(34) << "check" << std::right << std::setw(9) << "cases" << std::setw(9) << "failed"
+			<< std::setw(13) << "max err" << "\n";
+		for (const auto& [name, st] : stats_) {
+			out << std::left << std::setw(34) << name << std::right << std::setw(9) << st.cases << std::setw(9) << st.failed
+				<< std::setw(13) << std::scientific << std::setprecision(1) << st.max_err << std::defaultfloat << "\n";
+			total += st.cases; failed += st.failed;
+		}
+		if (failed) out << failed << " of " << total << " comparisons FAILED\n";
+		else out << "all " << total << " comparisons passed\n";
+		return failed == 0;
+	}
+
+private:
+	static bool same(double a, double b) { return a == b || (std::isnan(a) && std::isnan(b)); }
+	static std::string num(double x) { std::ostringstream s; s << std::setprecision(17) << x; return s.str(); }
+
+	void record(const std::string& check, const std::string& ctx, const std::string& why, double err) {
+		auto& st = stats_[check];
+		++st.cases;
+		st.max_err = std::max(st.max_err, err);
+		if (why.empty()) return;
+		if (st.failed++ < show_) std::cerr << "[FAIL] " << check << " on " << ctx << ": " << why << "\n";
+	}
+
+	std::string filter_;
+	double tol_;
+	std::size_t show_;
+	std::map<std::string, CheckStats> stats_;
+};
+
+
+// ---- checks ----
+
+static void check_indicators(Verifier& v, const Case& c, sugar::SplitMix64& rng, std::size_t draws) {
+	const auto closes = c.series.closes();
+	const std::size_t n = closes.size();
+	std::vector<std::size_t> periods{ 1, 2, 10, 50, n, n + 1 };
+	for (std::size_t d = 0; d < draws; ++d) periods.push_back(1 + rng() % 200);
+	std::vector<double> out(n);
+
+	for (const std::size_t p : periods) {
+		const std::string ctx = c.name + " n=" + std::to_string(p);
+		const auto sma = ref::sma(closes, p), ema = ref::ema(closes, p), roc = ref::roc(closes, p);
+		const auto ema_ind = ref::ema_indicator(closes, p);
+		if (v.wanted("indicator/sma")) {
+			v.series("indicator/sma_over_series", ctx, sma, sugar::sma_over_series(closes, p));
+			sugar::sma_into(closes, p, out); v.series("indicator/sma_into", ctx, sma, out);
+			v.series("indicator/SMAIndicator", ctx, sma, sugar::SMAIndicator(p).compute(c.series));
+			if (p > 0) v.series("indicator/SmaBank", ctx, sma, sugar::SmaBank(c.series, { p, p + 1 }).sma(p));
+		}
+		if (v.wanted("indicator/ema")) {
+			v.series("indicator/ema_over_series", ctx, ema, sugar::ema_over_series(closes, p));
+			sugar::ema_into(closes, p, out); v.series("indicator/ema_into", ctx, ema, out);
+			v.series("indicator/EMAIndicator", ctx, ema_ind, sugar::EMAIndicator(p).compute(c.series));
+		}
+		if (v.wanted("indicator/roc")) {
+			v.series("indicator/roc_over_series", ctx, roc, sugar::roc_over_series(closes, p));
+			sugar::roc_into(closes, p, out); v.series("indicator/roc_into", ctx, roc, out);
+			v.series("indicator/ROCIndicator", ctx, roc, sugar::ROCIndicator(p).compute(c.series));
+			const std::size_t base = 1 + rng() % 60;
+			const std::string bctx = ctx + " of " + std::to_string(base);
+			v.series("indicator/ROCOf(SMA)", bctx, ref::roc(ref::sma(closes, base), p),
+				sugar::ROCOfIndicator(std::make_shared<sugar::SMAIndicator>(base), p).compute(c.series));
+			v.series("indicator/ROCOf(EMA)", bctx, ref::roc(ref::ema_indicator(closes, base), p),
+				sugar::ROCOfIndicator(std::make_shared<sugar::EMAIndicator>(base), p).compute(c.series));
+		}
+		if (v.wanted("indicator/IndicatorBank") && p > 0) {											// one bank per period; base SMA held, base EMA not
+			using F = sugar::IndicatorFamily;
+			const auto b32 = static_cast<std::uint32_t>(1 + rng() % 60), p32 = static_cast<std::uint32_t>(p);
+			const sugar::IndicatorBank bank(c.series, { { F::RocEma, b32, p32 }, { F::Sma, p32, 0 }, { F::Ema, p32, 0 },
+				{ F::Roc, p32, 0 }, { F::RocSma, b32, p32 }, { F::Sma, b32, 0 }, { F::Sma, p32, 0 } });
+			const std::string bctx = ctx + " of " + std::to_string(b32);
+			v.series("indicator/IndicatorBank", ctx + " sma", sma, bank.series({ F::Sma, p32, 0 }));
+			v.series("indicator/IndicatorBank", ctx + " ema", ema_ind, bank.series({ F::Ema, p32, 0 }));
+			v.series("indicator/IndicatorBank", ctx + " roc", roc, bank.series({ F::Roc, p32, 0 }));
+			v.series("indicator/IndicatorBank", bctx + " roc_sma", ref::roc(ref::sma(closes, b32), p), bank.series({ F::RocSma, b32, p32 }));
+			v.series("indicator/IndicatorBank", bctx + " roc_ema", ref::roc(ref::ema_indicator(closes, b32), p), bank.series({ F::RocEma, b32, p32 }));
+			v.series("indicator/IndicatorBank", ctx + " closes", closes, bank.closes());
+		}
+	}
+}
+
+
+static void check_roc_sma(Verifier& v, const Case& c, sugar::SplitMix64& rng, std::size_t draws) {
+	const auto& s = c.series;
+	const std::size_t n = s.size();
+	const double threshes[] = { 0.0, 0.05, 0.15, 1.0 };
+	for (std::size_t d = 0; d < draws; ++d) {
+		const std::size_t f = 1 + rng() % 60, sl = 1 + rng() % 80, r = 1 + rng() % 120;
+		const double t = threshes[rng() % 4];
+		std::ostringstream ctxs;
+		ctxs << c.name << " roc_sma(" << f << "," << sl << "," << r << "," << t << ")";
+		const std::string ctx = ctxs.str();
+		const auto want = ref::roc_sma(s, f, sl, r, t);
+
+		if (v.wanted("roc_sma/run")) v.result("roc_sma/run", ctx, want, sugar::RocSmaCrossoverStrategy(f, sl, r, t).run(s));
+		if (v.wanted("roc_sma/run+prune")) {														// a limit the run reaches must never cut it
+			const sugar::PruneBounds bounds(s.closes());
+			sugar::PruneLimit limit;
+			limit.bounds = &bounds; limit.min_score = sugar::sweep_score(want.result); limit.check_every = 1 + rng() % 64;
+			std::size_t skipped = 0;
+			v.result("roc_sma/run+prune", ctx, want, sugar::RocSmaCrossoverStrategy(f, sl, r, t).run(s, limit, skipped));
+		}
+		const bool resumable = n >= r + std::max(f, sl);											// RocSmaState / stream warm-up precondition
+		if (v.wanted("roc_sma/capture")) {
+			sugar::RocSmaState st; bool captured = false;
+			v.result("roc_sma/capture", ctx, want, sugar::RocSmaCrossoverStrategy(f, sl, r, t).run(s, st, captured));
+		}
+		if (v.wanted("roc_sma/resume") && resumable) {
+			const std::size_t m = std::max(r + std::max(f, sl), n * 2 / 3);
+			sugar::RocSmaCrossoverStrategy strat(f, sl, r, t);
+			sugar::RocSmaState st, out; bool captured = false;
+			strat.run(s.prefix(m), st, captured);
+			if (captured) v.result("roc_sma/resume", ctx + " from " + std::to_string(m), want, strat.resume(s, st, out));
+		}
+		if (v.wanted("roc_sma/run_window")) {
+			const sugar::SmaBank bank(s, { f, sl });
+			v.result("roc_sma/run_window", ctx, want, sugar::RocSmaCrossoverStrategy(f, sl, r, t).run_window(bank, 0, n));
+		}
+		if (v.wanted("roc_sma/stream") && resumable) {
+			sugar::RocSmaStream strat(f, sl, r, t);
+			sugar::StreamSignal sig;
+			for (const auto& bar : s.rows()) strat.on_bar(bar, sig);
+			v.result("roc_sma/stream", ctx, want, strat.result());
+		}
+		if (v.wanted("roc_sma/rule")) {
+			std::ostringstream text;
+			text << std::setprecision(17);
+			const std::string diff = "roc(sma(close," + std::to_string(f) + ")," + std::to_string(r) + ") - roc(sma(close,"
+				+ std::to_string(sl) + ")," + std::to_string(r) + ")";
+			text << "enter: " << diff << " >= " << t << "\nexit: " << diff << " <= -" << t;
+			v.result("roc_sma/rule", ctx, want, sugar::RuleStrategy(text.str()).run(s));
+		}
+		if (v.wanted("roc_sma/diff_cross")) {
+			sugar::DiffCrossStrategy strat(std::make_shared<sugar::ROCOfIndicator>(std::make_shared<sugar::SMAIndicator>(f), r),
+				std::make_shared<sugar::ROCOfIndicator>(std::make_shared<sugar::SMAIndicator>(sl), r), t);
+			v.result("roc_sma/diff_cross", ctx, want, strat.run(s));
+		}
+	}
+}
+
+
+static void check_diff_cross(Verifier& v, const Case& c, sugar::SplitMix64& rng, std::size_t draws) {
+	if (!v.wanted("diff_cross/")) return;
+	const auto closes = c.series.closes();
+	for (std::size_t d = 0; d < draws; ++d) {
+		const std::size_t a = 1 + rng() % 60, b = 1 + rng() % 80;
+		const double t = 0.1 * static_cast<double>(rng() % 20);
+		std::ostringstream ctx;
+		ctx << c.name << " sma(" << a << ") - ema(" << b << ") thresh " << t;
+		const auto av = ref::sma(closes, a), bv = ref::ema_indicator(closes, b);
+		const auto want = ref::diff_cross(c.series, av, bv, t);
+		sugar::DiffCrossStrategy strat(std::make_shared<sugar::SMAIndicator>(a), std::make_shared<sugar::EMAIndicator>(b), t);
+		v.result("diff_cross/run", ctx.str(), want, strat.run(c.series));
+		v.result("diff_cross/run_on", ctx.str(), want, sugar::DiffCrossStrategy::run_on(c.series, av, bv, closes, t));
+	}
+}
+
+
+static void check_swing(Verifier& v, const Case& c, sugar::SplitMix64& rng, std::size_t draws) {
+	if (!v.wanted("swing/")) return;
+	for (std::size_t d = 0; d < draws; ++d) {
+		const std::size_t left = 1 + rng() % 5, right = 1 + rng() % 5;
+		const bool ema_stop = rng() % 2;
+		const int days = 1 + static_cast<int>(rng() % 3), for_gain = 1 + static_cast<int>(rng() % 5);
+		const double gain = 1.0 + static_cast<double>(rng() % 50) / 10.0, loss = 3.0 + static_cast<double>(rng() % 70) / 10.0;
+		std::ostringstream ctx;
+		ctx << c.name << " swing(" << left << "," << right << "," << ema_stop << "," << days << "," << gain << "," << for_gain << "," << loss << ")";
+		const auto want = ref::swing_breakout(c.series, left, right, ema_stop, days, gain, for_gain, loss);
+		v.result("swing/run", ctx.str(), want, sugar::SwingBreakoutStrategy(left, right, ema_stop, days, gain, for_gain, loss).run(c.series));
+		if (c.series.size() >= 10) {																// EMA(10) warm-up
+			sugar::SwingBreakoutStream strat(left, right, ema_stop, days, gain, for_gain, loss);
+			sugar::StreamSignal sig;
+			for (const auto& bar : c.series.rows()) strat.on_bar(bar, sig);
+			v.result("swing/stream", ctx.str(), want, strat.result());
+		}
+	}
+}
+
+
+// One instance of each strategy run by many threads at once, each run on a pooled context with its own
+// trade log: the const, reentrant IStrategy::run contract. Every run must match the reference.
+static void check_shared(Verifier& v, const Case& c, sugar::SplitMix64& rng, std::size_t threads, std::size_t rounds) {
+	if (!v.wanted("shared/") || threads == 0 || rounds == 0) return;
+	const auto closes = c.series.closes();
+	const std::size_t f = 1 + rng() % 40, sl = 1 + rng() % 60, r = 1 + rng() % 80, left = 1 + rng() % 4, right = 1 + rng() % 4;
+	const double t = 0.05 * static_cast<double>(rng() % 10);
+	std::ostringstream text;
+	text << std::setprecision(17);
+	const std::string diff = "roc(sma(close," + std::to_string(f) + ")," + std::to_string(r) + ") - roc(sma(close,"
+		+ std::to_string(sl) + ")," + std::to_string(r) + ")";
+	text << "enter: " << diff << " >= " << t << "\nexit: " << diff << " <= -" << t;
+
+	struct Shared { std::string check; std::unique_ptr<const sugar::IStrategy> strat; ref::Run want; };
+	std::vector<Shared> shared;
+	shared.push_back({ "shared/roc_sma", std::make_unique<sugar::RocSmaCrossoverStrategy>(f, sl, r, t), ref::roc_sma(c.series, f, sl, r, t) });
+	shared.push_back({ "shared/rule", std::make_unique<sugar::RuleStrategy>(text.str()), shared.back().want });
+	shared.push_back({ "shared/diff_cross", std::make_unique<sugar::DiffCrossStrategy>(std::make_shared<sugar::SMAIndicator>(f),
+		std::make_shared<sugar::EMAIndicator>(sl), t), ref::diff_cross(c.series, ref::sma(closes, f), ref::ema_indicator(closes, sl), t) });
+	shared.push_back({ "shared/swing", std::make_unique<sugar::SwingBreakoutStrategy>(left, right, true, 2, 4.0, 3, 8.0),
+		ref::swing_breakout(c.series, left, right, true, 2, 4.0, 3, 8.0) });
+
+	struct Got { std::size_t strat; sugar::BacktestResult r; std::vector<sugar::TradeRecord> trades; std::size_t dropped; };
+	std::vector<std::vector<Got>> got(threads);
+	sugar::RunContextPool pool;
+	std::latch start(static_cast<std::ptrdiff_t>(threads));
+	std::vector<std::thread> workers;
+	for (std::size_t k = 0; k < threads; ++k)
+		workers.emplace_back([&, k] {
+			start.arrive_and_wait();																// all threads on the same instances at once
+			for (std::size_t i = 0; i < rounds * shared.size(); ++i) {
+				const std::size_t s = (k + i) % shared.size();
+				auto lease = pool.acquire();
+				sugar::TradeLog log(16);
+				lease->trade_log = &log;
+				const auto res = shared[s].strat->run(c.series, *lease);
+				got[k].push_back({ s, res, { log.records().begin(), log.records().end() }, log.dropped() });
+			}
+		});
+	for (auto& w : workers) w.join();
+
+	for (std::size_t k = 0; k < threads; ++k)
+		for (const Got& g : got[k]) {
+			const Shared& sh = shared[g.strat];
+			const std::string ctx = c.name + " thread " + std::to_string(k);
+			v.result(sh.check, ctx, sh.want, g.r);
+			std::string why;
+			if (g.trades.size() + g.dropped != sh.want.trades.size())
+				why = std::to_string(g.trades.size() + g.dropped) + " trades logged, want " + std::to_string(sh.want.trades.size());
+			for (std::size_t i = 0; why.empty() && i < g.trades.size(); ++i) {
+				const auto& w = sh.want.trades[i];
+				const auto& t = g.trades[i];
+				const float ret = static_cast<float>(w.ret);
+				if (t.entry_bar != w.entry_bar || t.exit_bar != w.exit_bar || !(t.ret == ret || (std::isnan(t.ret) && std::isnan(ret))))
+					why = "trade " + std::to_string(i) + " differs";
+			}
+			v.equal(sh.check + "/trades", ctx, why.empty(), why);
+		}
+	v.equal("shared/pool", c.name, pool.created() <= threads,
+		std::to_string(pool.created()) + " contexts made for " + std::to_string(threads) + " threads");
+}
+
+
+// Top-K of a small grid: exhaustive reference runs vs the sweep, with and without pruning.
+static void check_sweep(Verifier& v, const Case& c) {
+	if (!v.wanted("sweep/") || c.series.size() < 300) return;
+	const std::vector<std::size_t> fasts{ 5, 10, 20 }, slows{ 20, 30, 50 }, rocs{ 5, 10 };
+	const std::vector<double> threshes{ 0.1, 0.3 };
+	std::vector<double> want;
+	for (auto f : fasts) for (auto s : slows) for (auto r : rocs) for (auto t : threshes)
+		if (f < s) want.push_back(sugar::sweep_score(ref::roc_sma(c.series, f, s, r, t).result));
+	std::sort(want.rbegin(), want.rend());
+	want.resize(std::min<std::size_t>(want.size(), 5));
+
+	for (const bool prune : { false, true }) {
+		sugar::SweepOptions so;
+		so.quiet = true; so.prune = prune; so.top_k = 5;
+		const auto res = sugar::sweep_roc_sma(c.series, fasts, slows, rocs, threshes, so);
+		std::vector<double> got;
+		for (const auto& row : res.top) got.push_back(row.score);
+		std::string why;
+		if (got != want) {
+			std::ostringstream s; s << std::setprecision(17) << "top score " << (got.empty() ? 0.0 : got[0]) << " vs " << (want.empty() ? 0.0 : want[0])
+				<< " (" << got.size() << " vs " << want.size() << " rows)";
+			why = s.str();
+		}
+		v.equal(prune ? "sweep/top_k+prune" : "sweep/top_k", c.name, why.empty(), why);
+	}
+}
+
+
+// Top-K of the indicator-bank sweep over every family, against exhaustive reference runs.
+static void check_sweep_diff_cross(Verifier& v, const Case& c) {
+	if (!v.wanted("sweep/diff_cross") || c.series.size() < 300) return;
+	const std::vector<double> threshes{ 0.1, 0.3 };
+	std::vector<sugar::IndicatorKey> keys;
+	for (const char* k : { "sma:10", "sma:30", "ema:10", "ema:40", "roc:10", "roc_sma:10/5", "roc_sma:30/10", "roc_ema:20/5" })
+		keys.push_back(sugar::parse_indicator_key(k));
+	const auto closes = c.series.closes();
+	auto series_of = [&](const sugar::IndicatorKey& k) {
+		using F = sugar::IndicatorFamily;
+		switch (k.family) {
+		case F::Sma: return ref::sma(closes, k.n);
+		case F::Ema: return ref::ema_indicator(closes, k.n);
+		case F::Roc: return ref::roc(closes, k.n);
+		case F::RocSma: return ref::roc(ref::sma(closes, k.n), k.roc);
+		case F::RocEma: break;
+		}
+		return ref::roc(ref::ema_indicator(closes, k.n), k.roc);
+	};
+	std::vector<std::vector<double>> ref_series;
+	for (const auto& k : keys) ref_series.push_back(series_of(k));
+	std::vector<double> want;
+	for (const auto& av : ref_series) for (const auto& bv : ref_series) for (const double t : threshes)
+		want.push_back(sugar::sweep_score(ref::diff_cross(c.series, av, bv, t).result));
+	std::sort(want.rbegin(), want.rend());
+	want.resize(std::min<std::size_t>(want.size(), 5));
+	const auto res = sugar::sweep_diff_cross(c.series, keys, keys, threshes, 5);
+	std::vector<double> got;
+	for (const auto& row : res.top) got.push_back(row.score);
+	std::string why;
+	if (got != want) {
+		std::ostringstream s; s << std::setprecision(17) << "top score " << (got.empty() ? 0.0 : got[0]) << " vs " << (want.empty() ? 0.0 : want[0])
+			<< " (" << got.size() << " vs " << want.size() << " rows)";
+		why = s.str();
+	}
+	v.equal("sweep/diff_cross", c.name, why.empty(), why);
+}
+
+
+// ---- throughput ----
+
+static double time_ns(double min_time, const std::function<double()>& fn) {							// median of repetitions filling min_time
+	using clock = std::chrono::steady_clock;
+	[[maybe_unused]] static volatile double sink;
+	std::vector<double> ns;
+	double total = 0.0;
+	sink = fn();
+	while (ns.size() < 3 || total < min_time) {
+		const auto t0 = clock::now();
+		sink = fn();
+		const double dt = std::chrono::duration<double>(clock::now() - t0).count();
+		ns.push_back(dt * 1e9); total += dt;
+	}
+	std::sort(ns.begin(), ns.end());
+	return ns[ns.size() / 2];
+}
+
+
+static void bench(const std::vector<std::size_t>& sizes, const std::string& filter, double min_time) {
+	std::cout << std::left << std::setw(26) << "kernel" << std::setw(22) << "variant" << std::right << std::setw(11) << "bars"
+		<< std::setw(14) << "ref ns/bar" << std::setw(14) << "opt ns/bar" << std::setw(10) << "speedup" << "\n";
+	for (const std::size_t n : sizes) {
+		const sugar::CandleSeries s{ synth(n, 42) };
+		const auto closes = s.closes();
+		std::vector<double> out(n);
+		auto row = [&](const std::string& kernel, const std::function<double()>& reference,
+			const std::vector<std::pair<std::string, std::function<double()>>>& variants) {
+			if (!filter.empty() && kernel.find(filter) == std::string::npos) return;
+			const double base = time_ns(min_time, reference) / double(n);
+			for (const auto& [name, fn] : variants) {
+				const double t = time_ns(min_time, fn) / double(n);
+				std::cout << std::left << std::setw(26) << kernel << std::setw(22) << name << std::right << std::setw(11) << n
+					<< std::fixed << std::setprecision(2) << std::setw(14) << base << std::setw(14) << t
+					<< std::setw(9) << base / t << "x" << std::defaultfloat << "\n";
+			}
+		};
+
+		row("sma(50)", [&] { return ref::sma(closes, 50).back(); }, {
+			{ "sma_into", [&] { sugar::sma_into(closes, 50, out); return out.back(); } },
+			{ "SMAIndicator", [&] { return sugar::SMAIndicator(50).compute(s).back(); } } });
+		row("ema(50)", [&] { return ref::ema(closes, 50).back(); }, {
+			{ "ema_into", [&] { sugar::ema_into(closes, 50, out); return out.back(); } } });
+		row("roc(10)", [&] { return ref::roc(closes, 10).back(); }, {
+			{ "roc_into", [&] { sugar::roc_into(closes, 10, out); return out.back(); } } });
+
+		const sugar::SmaBank bank(s, { 20, 50 });
+		const std::string diff = "roc(sma(close,20),10) - roc(sma(close,50),10)";
+		const auto program = sugar::RuleProgram::compile("enter: " + diff + " >= 0.15; exit: " + diff + " <= -0.15");
+		row("roc_sma(20,50,10,0.15)", [&] { return ref::roc_sma(s, 20, 50, 10, 0.15).result.pnl; }, {
+			{ "run", [&] { return sugar::RocSmaCrossoverStrategy(20, 50, 10, 0.15).run(s).pnl; } },
+			{ "run_window(bank)", [&] { return sugar::RocSmaCrossoverStrategy(20, 50, 10, 0.15).run_window(bank, 0, n).pnl; } },
+			{ "stream", [&] {
+				sugar::RocSmaStream strat(20, 50, 10, 0.15);
+				sugar::StreamSignal sig;
+				for (const auto& bar : s.rows()) strat.on_bar(bar, sig);
+				return strat.result().pnl;
+			} },
+			{ "rule", [&] { return sugar::RuleStrategy(program).run(s).pnl; } } });
+		row("diff_cross(sma20,ema50)", [&] { return ref::diff_cross(s, ref::sma(closes, 20), ref::ema(closes, 50), 0.15).result.pnl; }, {
+			{ "run", [&] { return sugar::DiffCrossStrategy(std::make_shared<sugar::SMAIndicator>(20), std::make_shared<sugar::EMAIndicator>(50), 0.15).run(s).pnl; } } });
+		row("swing_breakout", [&] { return ref::swing_breakout(s, 2, 2, true, 2, 4.0, 3, 8.0).result.pnl; }, {
+			{ "run", [&] { return sugar::SwingBreakoutStrategy(2, 2, true, 2, 4.0, 3, 8.0).run(s).pnl; } } });
+
+		const std::vector<std::size_t> fasts{ 10, 20, 30 }, slows{ 40, 50, 60 }, rocs{ 5, 10 };
+		const std::vector<double> threshes{ 0.1, 0.2 };
+		row("sweep(36 combos)", [&] {
+			double best = -1e300;
+			for (auto f : fasts) for (auto sl : slows) for (auto r : rocs) for (auto t : threshes)
+				best = std::max(best, sugar::sweep_score(ref::roc_sma(s, f, sl, r, t).result));
+			return best;
+		}, {
+			{ "sweep_roc_sma", [&] { sugar::SweepOptions so; so.quiet = true; return sugar::sweep_roc_sma(s, fasts, slows, rocs, threshes, so).top[0].score; } },
+			{ "sweep_roc_sma+prune", [&] { sugar::SweepOptions so; so.quiet = true; so.prune = true; return sugar::sweep_roc_sma(s, fasts, slows, rocs, threshes, so).top[0].score; } } });
+
+		std::vector<sugar::IndicatorKey> keys;														// 4 families x 3 periods a side, 288 combos
+		for (const std::string f : { "sma", "ema", "roc_sma", "roc_ema" })
+			for (const char* p : { "10", "30", "50" }) keys.push_back(sugar::parse_indicator_key(f + ":" + p + (f.size() > 3 ? "/10" : "")));
+		row("diff_cross sweep(288)", [&] {															// indicators recomputed per pair
+			double best = -1e300;
+			for (const auto& a : keys) for (const auto& b : keys) for (auto t : threshes) {
+				auto of = [&](const sugar::IndicatorKey& k) {
+					const auto base = k.family == sugar::IndicatorFamily::Sma || k.family == sugar::IndicatorFamily::RocSma
+						? ref::sma(closes, k.n) : ref::ema_indicator(closes, k.n);
+					return k.roc ? ref::roc(base, k.roc) : base;
+				};
+				best = std::max(best, sugar::sweep_score(ref::diff_cross(s, of(a), of(b), t).result));
+			}
+			return best;
+		}, {
+			{ "sweep_diff_cross", [&] { return sugar::sweep_diff_cross(s, keys, keys, threshes, 5).top[0].score; } } });
+	}
+}
+
+
+int main(int argc, char** argv) {
+	try {
+		std::size_t seeds = 24, max_bars = 3000, draws = 4, show = 5, threads = 8, rounds = 2;
+		std::vector<std::size_t> sizes{ 100000 };
+		std::string filter;
+		double tol = 1e-9, min_time = 0.2;
+		bool bench_only = false;
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			auto value = [&]() -> std::string {
+				if (i + 1 >= argc) throw std::runtime_error("Missing value for " + std::string(arg));
+				return argv[++i];
+			};
+			if (arg == "--seeds") seeds = std::stoull(value());
+			else if (arg == "--bars") max_bars = std::max<std::size_t>(1, parse_size(value()));
+			else if (arg == "--draws") draws = std::stoull(value());
+			else if (arg == "--filter") filter = value();
+			else if (arg == "--tol") tol = std::stod(value());
+			else if (arg == "--show") show = std::stoull(value());
+			else if (arg == "--threads") threads = std::stoull(value());
+			else if (arg == "--rounds") rounds = std::stoull(value());
+			else if (arg == "--bench") bench_only = true;
+			else if (arg == "--sizes") {
+				sizes.clear();
+				std::stringstream ss(value());
+				std::string s;
+				while (std::getline(ss, s, ',')) sizes.push_back(parse_size(s));
+			}
+			else if (arg == "--min-time") min_time = std::stod(value());
+			else throw std::runtime_error("Unknown option: " + std::string(arg));
+		}
+		if (bench_only) { bench(sizes, filter, min_time); return 0; }
+
+		const auto t0 = std::chrono::steady_clock::now();
+		const auto cases = make_cases(seeds, max_bars);
+		Verifier v(filter, tol, show);
+		for (std::size_t k = 0; k < cases.size(); ++k) {
+			auto rng = sugar::rng_stream(0xC0FFEE, k);												// per case: draws do not depend on the cases before it
+			check_indicators(v, cases[k], rng, draws);
+			check_roc_sma(v, cases[k], rng, draws);
+			check_diff_cross(v, cases[k], rng, draws);
+			check_swing(v, cases[k], rng, draws);
+			check_shared(v, cases[k], rng, threads, rounds);
+			check_sweep(v, cases[k]);
+			check_sweep_diff_cross(v, cases[k]);
+		}
+		const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		std::cout << "sugar_verify: " << cases.size() << " series (" << seeds << " seeded, up to " << max_bars << " bars), "
+			<< draws << " parameter draws each, tolerance " << tol << " on risk metrics, " << std::fixed << std::setprecision(2)
+			<< secs << "s\n\n" << std::defaultfloat;
+		return v.report(std::cout) ? 0 : 1;
+	}
+	catch (const std::exception& ex) {
+		std::cerr << "Error: " << ex.what() << "\n"; return 1;
+	}
+}
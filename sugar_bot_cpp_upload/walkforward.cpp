@@ -0,0 +1,123 @@
+#include "walkforward.h"
+#include "parallel.h"
+#include "profile.h"
+#include "strategy_roc_sma.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace sugar {
+
+    std::vector<WalkForwardWindow> make_walk_forward_windows(std::size_t bars, const WalkForwardOptions& opts) {
+        const std::size_t step = opts.step_bars ? opts.step_bars : opts.test_bars;
+        if (opts.train_bars == 0 || opts.test_bars == 0)
+            throw std::invalid_argument("walk-forward: train and test lengths must be > 0");
+        if (step < opts.test_bars)
+            throw std::invalid_argument("walk-forward: step must be >= test length (test windows would overlap)");
+
+        std::vector<WalkForwardWindow> out;
+        for (std::size_t cut = opts.train_bars; cut + opts.test_bars <= bars; cut += step) {
+            WalkForwardWindow w;
+            w.train_begin = opts.anchored ? 0 : cut - opts.train_bars;
+            w.train_end = cut;
+            w.test_begin = cut;
+            w.test_end = cut + opts.test_bars;
+            out.push_back(w);
+        }
+        return out;
+    }
+
+    static void mean_stdev(const std::vector<double>& v, double& mean, double& stdev) {
+        mean = stdev = 0.0;
+        if (v.empty()) return;
+        for (double x : v) mean += x;
+        mean /= static_cast<double>(v.size());
+        for (double x : v) stdev += (x - mean) * (x - mean);
+        stdev = std::sqrt(stdev / static_cast<double>(v.size()));
+    }
+
+    static ParamStability stability_of(const std::vector<WalkForwardWindow>& windows) {
+        ParamStability st;
+        std::vector<double> f, s, r, t;
+        double train_rate = 0.0, test_rate = 0.0;
+        for (std::size_t i = 0; i < windows.size(); ++i) {
+            const auto& w = windows[i];
+            const auto& [pf, ps, pr, pt] = w.params;
+            f.push_back(double(pf)); s.push_back(double(ps)); r.push_back(double(pr)); t.push_back(pt);
+            if (i > 0 && w.params != windows[i - 1].params) ++st.changes;
+            train_rate += w.train.pnl / double(w.train_end - w.train_begin);
+            test_rate += w.test.pnl / double(w.test_end - w.test_begin);
+        }
+        mean_stdev(f, st.fast_mean, st.fast_stdev);
+        mean_stdev(s, st.slow_mean, st.slow_stdev);
+        mean_stdev(r, st.roc_mean, st.roc_stdev);
+        mean_stdev(t, st.thresh_mean, st.thresh_stdev);
+        st.efficiency = train_rate != 0.0 ? test_rate / train_rate : 0.0;
+        return st;
+    }
+
+    WalkForwardResult walk_forward_roc_sma(const CandleSeries& data, const RocSmaSpace& space,
+        const WalkForwardOptions& opts) {
+        SUGAR_PROF_SCOPE("walkforward/total");
+        WalkForwardResult out;
+        out.windows = make_walk_forward_windows(data.size(), opts);
+        if (out.windows.empty()) return out;
+
+        std::vector<std::size_t> periods = space.fasts;
+        periods.insert(periods.end(), space.slows.begin(), space.slows.end());
+        const SmaBank bank(data, periods);                              // one SMA per period for every window
+
+        std::vector<std::pair<std::size_t, std::size_t>> pairs;         // valid (fast, slow), in sweep order
+        for (auto f : space.fasts)
+            for (auto s : space.slows)
+                if (f < s) pairs.push_back({ f, s });
+
+        // One work item per (window, pair); each keeps its own winner so the
+        // reduction below needs no locks and is independent of scheduling.
+        struct Best { double score = -std::numeric_limits<double>::infinity(); BacktestResult r; RocSmaParams p{}; };
+        const std::size_t W = out.windows.size(), P = pairs.size();
+        std::vector<Best> best(W * P);
+        parallel_for(W * P, opts.threads, [&](std::size_t item) {
+            const auto& w = out.windows[item / P];
+            const auto [f, s] = pairs[item % P];
+            Best& b = best[item];
+            for (auto rlen : space.rocs)
+                for (auto th : space.threshes) {
+                    const RocSmaCrossoverStrategy strat{ f, s, rlen, th };
+                    const auto r = strat.run_window(bank, w.train_begin, w.train_end);
+                    const double score = sweep_score(r);
+                    if (score > b.score) b = { score, r, { f, s, rlen, th } };
+                }
+        });
+        out.evaluations = W * P * space.rocs.size() * space.threshes.size();
+
+        // Per window: first strictly better row in sweep order wins, as in sweep_roc_sma.
+        std::vector<TradeTrace> traces(W);
+        parallel_for(W, opts.threads, [&](std::size_t wi) {
+            auto& w = out.windows[wi];
+            const Best* win = nullptr;
+            for (std::size_t p = 0; p < P; ++p)
+                if (!win || best[wi * P + p].score > win->score) win = &best[wi * P + p];
+            if (!win || !std::isfinite(win->score)) return;             // empty grid
+            w.params = win->p;
+            w.train = win->r;
+            const auto [f, s, rlen, th] = w.params;
+            const RocSmaCrossoverStrategy strat{ f, s, rlen, th };
+            w.test = strat.run_window(bank, w.test_begin, w.test_end, &traces[wi]);
+        });
+
+        // Stitch: same equity / drawdown accounting as a single run, trade by trade.
+        double peak = 0.0;
+        for (std::size_t wi = 0; wi < W; ++wi) {
+            if (out.oos.best_start_date == 0) out.oos.best_start_date = out.windows[wi].test.best_start_date;
+            for (double ret : traces[wi].trade_returns) {
+                out.oos.pnl += ret; ++out.oos.trades; peak = std::max(peak, out.oos.pnl);
+                out.oos.max_drawdown = std::max(out.oos.max_drawdown, peak - out.oos.pnl);
+            }
+        }
+        out.stability = stability_of(out.windows);
+        return out;
+    }
+
+} // namespace sugar
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "metrics.h"
+#include "optimizer.h"
+#include "series.h"
+#include "sweep.h"
+
+namespace sugar {
+
+    // Walk-forward optimization of RocSmaCrossoverStrategy.
+    //
+    // The series is cut into train/test windows. Each train window is swept
+    // over the whole RocSmaSpace, its winner (best sweep_score) is then run on
+    // the test window that follows it, and the test trades of all windows are
+    // stitched into one out-of-sample result.
+    //
+    // Rolling:  train [s, s + train), test [s + train, s + train + test), s += step
+    // Anchored: train [0, t),         test [t, t + test),                 t += step
+    //
+    // Only windows whose test range fits entirely in the series are used.
+    // Indicators are computed once over the full series and shared by every
+    // window and thread; a window's first bars therefore see indicator values
+    // warmed up on earlier history (causal, never future data).
+
+    struct WalkForwardOptions {
+        std::size_t train_bars = 0;
+        std::size_t test_bars = 0;
+        std::size_t step_bars = 0;                                      // 0 = test_bars; must be >= test_bars so test windows don't overlap
+        bool anchored = false;
+        std::size_t threads = 0;                                        // 0 = hardware concurrency
+    };
+
+    struct WalkForwardWindow {
+        std::size_t train_begin{}, train_end{};                         // half-open bar ranges
+        std::size_t test_begin{}, test_end{};
+        RocSmaParams params{};                                          // train winner
+        BacktestResult train;                                           // winner on its train window
+        BacktestResult test;                                            // same params, out of sample
+    };
+
+    // How much the chosen parameters move from window to window.
+    struct ParamStability {
+        std::size_t changes{};                                          // windows whose winner differs from the previous one
+        double fast_mean{}, fast_stdev{};
+        double slow_mean{}, slow_stdev{};
+        double roc_mean{}, roc_stdev{};
+        double thresh_mean{}, thresh_stdev{};
+        double efficiency{};                                            // sum(test pnl per bar) / sum(train pnl per bar)
+    };
+
+    struct WalkForwardResult {
+        std::vector<WalkForwardWindow> windows;
+        BacktestResult oos;                                             // stitched test trades, in window order
+        ParamStability stability;
+        std::size_t evaluations{};                                      // train-window strategy runs
+    };
+
+    // Window layout only (train/test ranges, nothing evaluated); throws
+    // std::invalid_argument on zero lengths or step < test.
+    std::vector<WalkForwardWindow> make_walk_forward_windows(std::size_t bars, const WalkForwardOptions& opts);
+
+    WalkForwardResult walk_forward_roc_sma(const CandleSeries& data, const RocSmaSpace& space,
+        const WalkForwardOptions& opts);
+
+} // namespace sugar